@@ -28,6 +28,16 @@
 
 grammar Asl;
 
+// All the nodes of the tree derive from DecoratedContext, which has the
+// index of their attributes in TreeDecoration
+options {
+  contextSuperClass = DecoratedContext;
+}
+
+@parser::postinclude {
+#include "DecoratedContext.h"
+}
+
 //////////////////////////////////////////////////
 /// Parser Rules
 //////////////////////////////////////////////////
@@ -34,7 +34,7 @@ dfa::Vocabulary& AslParser::getVocabulary() const {
 //----------------- ProgramContext ------------------------------------------------------------------
 
 AslParser::ProgramContext::ProgramContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::ProgramContext::EOF() {
@@ -97,7 +97,7 @@ AslParser::ProgramContext* AslParser::program() {
 //----------------- FunctionContext ------------------------------------------------------------------
 
 AslParser::FunctionContext::FunctionContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::FunctionContext::FUNC() {
@@ -196,7 +196,7 @@ AslParser::FunctionContext* AslParser::function() {
 //----------------- DeclarationsContext ------------------------------------------------------------------
 
 AslParser::DeclarationsContext::DeclarationsContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 std::vector<AslParser::Variable_declContext *> AslParser::DeclarationsContext::variable_decl() {
@@ -253,7 +253,7 @@ AslParser::DeclarationsContext* AslParser::declarations() {
 //----------------- Variable_declContext ------------------------------------------------------------------
 
 AslParser::Variable_declContext::Variable_declContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::Variable_declContext::VAR() {
@@ -328,7 +328,7 @@ AslParser::Variable_declContext* AslParser::variable_decl() {
 //----------------- ParametersContext ------------------------------------------------------------------
 
 AslParser::ParametersContext::ParametersContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 std::vector<tree::TerminalNode *> AslParser::ParametersContext::ID() {
@@ -405,7 +405,7 @@ AslParser::ParametersContext* AslParser::parameters() {
 //----------------- TypeContext ------------------------------------------------------------------
 
 AslParser::TypeContext::TypeContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 AslParser::Basic_typeContext* AslParser::TypeContext::basic_type() {
@@ -473,7 +473,7 @@ AslParser::TypeContext* AslParser::type() {
 //----------------- Basic_typeContext ------------------------------------------------------------------
 
 AslParser::Basic_typeContext::Basic_typeContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::Basic_typeContext::INT() {
@@ -541,7 +541,7 @@ AslParser::Basic_typeContext* AslParser::basic_type() {
 //----------------- Array_typeContext ------------------------------------------------------------------
 
 AslParser::Array_typeContext::Array_typeContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::Array_typeContext::ARRAY() {
@@ -607,7 +607,7 @@ AslParser::Array_typeContext* AslParser::array_type() {
 //----------------- StatementsContext ------------------------------------------------------------------
 
 AslParser::StatementsContext::StatementsContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 std::vector<AslParser::StatementContext *> AslParser::StatementsContext::statement() {
@@ -670,7 +670,7 @@ AslParser::StatementsContext* AslParser::statements() {
 //----------------- StatementContext ------------------------------------------------------------------
 
 AslParser::StatementContext::StatementContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 
@@ -1041,7 +1041,7 @@ AslParser::StatementContext* AslParser::statement() {
 //----------------- Left_exprContext ------------------------------------------------------------------
 
 AslParser::Left_exprContext::Left_exprContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 AslParser::IdentContext* AslParser::Left_exprContext::ident() {
@@ -1102,7 +1102,7 @@ AslParser::Left_exprContext* AslParser::left_expr() {
 //----------------- ExprContext ------------------------------------------------------------------
 
 AslParser::ExprContext::ExprContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 
@@ -1613,7 +1613,7 @@ AslParser::ExprContext* AslParser::expr(int precedence) {
 //----------------- IdentContext ------------------------------------------------------------------
 
 AslParser::IdentContext::IdentContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 tree::TerminalNode* AslParser::IdentContext::ID() {
@@ -1657,7 +1657,7 @@ AslParser::IdentContext* AslParser::ident() {
 //----------------- List_exprContext ------------------------------------------------------------------
 
 AslParser::List_exprContext::List_exprContext(ParserRuleContext *parent, size_t invokingState)
-  : ParserRuleContext(parent, invokingState) {
+  : DecoratedContext(parent, invokingState) {
 }
 
 std::vector<AslParser::ExprContext *> AslParser::List_exprContext::expr() {
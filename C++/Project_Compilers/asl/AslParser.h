@@ -6,7 +6,7 @@
 
 #include "antlr4-runtime.h"
 
-
+#include "DecoratedContext.h"
 
 
 class  AslParser : public antlr4::Parser {
@@ -54,7 +54,7 @@ public:
   class IdentContext;
   class List_exprContext; 
 
-  class  ProgramContext : public antlr4::ParserRuleContext {
+  class  ProgramContext : public DecoratedContext {
   public:
     ProgramContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -68,7 +68,7 @@ public:
 
   ProgramContext* program();
 
-  class  FunctionContext : public antlr4::ParserRuleContext {
+  class  FunctionContext : public DecoratedContext {
   public:
     FunctionContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -86,7 +86,7 @@ public:
 
   FunctionContext* function();
 
-  class  DeclarationsContext : public antlr4::ParserRuleContext {
+  class  DeclarationsContext : public DecoratedContext {
   public:
     DeclarationsContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -99,7 +99,7 @@ public:
 
   DeclarationsContext* declarations();
 
-  class  Variable_declContext : public antlr4::ParserRuleContext {
+  class  Variable_declContext : public DecoratedContext {
   public:
     Variable_declContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -114,7 +114,7 @@ public:
 
   Variable_declContext* variable_decl();
 
-  class  ParametersContext : public antlr4::ParserRuleContext {
+  class  ParametersContext : public DecoratedContext {
   public:
     ParametersContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -129,7 +129,7 @@ public:
 
   ParametersContext* parameters();
 
-  class  TypeContext : public antlr4::ParserRuleContext {
+  class  TypeContext : public DecoratedContext {
   public:
     TypeContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -142,7 +142,7 @@ public:
 
   TypeContext* type();
 
-  class  Basic_typeContext : public antlr4::ParserRuleContext {
+  class  Basic_typeContext : public DecoratedContext {
   public:
     Basic_typeContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -157,7 +157,7 @@ public:
 
   Basic_typeContext* basic_type();
 
-  class  Array_typeContext : public antlr4::ParserRuleContext {
+  class  Array_typeContext : public DecoratedContext {
   public:
     Array_typeContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -172,7 +172,7 @@ public:
 
   Array_typeContext* array_type();
 
-  class  StatementsContext : public antlr4::ParserRuleContext {
+  class  StatementsContext : public DecoratedContext {
   public:
     StatementsContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -185,7 +185,7 @@ public:
 
   StatementsContext* statements();
 
-  class  StatementContext : public antlr4::ParserRuleContext {
+  class  StatementContext : public DecoratedContext {
   public:
     StatementContext(antlr4::ParserRuleContext *parent, size_t invokingState);
    
@@ -281,7 +281,7 @@ public:
 
   StatementContext* statement();
 
-  class  Left_exprContext : public antlr4::ParserRuleContext {
+  class  Left_exprContext : public DecoratedContext {
   public:
     Left_exprContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -294,7 +294,7 @@ public:
 
   Left_exprContext* left_expr();
 
-  class  ExprContext : public antlr4::ParserRuleContext {
+  class  ExprContext : public DecoratedContext {
   public:
     ExprContext(antlr4::ParserRuleContext *parent, size_t invokingState);
    
@@ -410,7 +410,7 @@ public:
 
   ExprContext* expr();
   ExprContext* expr(int precedence);
-  class  IdentContext : public antlr4::ParserRuleContext {
+  class  IdentContext : public DecoratedContext {
   public:
     IdentContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
@@ -422,7 +422,7 @@ public:
 
   IdentContext* ident();
 
-  class  List_exprContext : public antlr4::ParserRuleContext {
+  class  List_exprContext : public DecoratedContext {
   public:
     List_exprContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
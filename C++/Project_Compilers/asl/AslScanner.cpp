@@ -0,0 +1,337 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslScanner - Hand-written lexer for the Asl language, with
+//                 the same tokens as the one generated by antlr4
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "AslScanner.h"
+#include "AslLexer.h"
+
+#include "antlr4-runtime.h"
+
+#include <cstring>    // memcmp
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+namespace {
+
+  // Classes of the characters (bytes) of the text
+  enum {
+    SPACE  = 1,     // white space: ' ', '\t', '\r', '\n'
+    LETTER = 2,     // first character of an identifier
+    IDCHAR = 4,     // other characters of an identifier
+    DIGIT  = 8,
+    PRINT  = 16     // printable ASCII: a CHARVAL can have them
+  };
+
+  struct Keyword {
+    const char * text;
+    std::size_t  length;
+    std::size_t  type;
+  };
+
+  // The table that drives the scanner: the class of each character, the
+  // token of those that are a token by themselves, and the keywords by
+  // their first letter
+  struct ScanTable {
+    unsigned char            classOf[256];
+    std::size_t              single[256];
+    std::vector<Keyword>     keywords[26];
+
+    ScanTable() {
+      for (int c = 0; c < 256; ++c) {
+        classOf[c] = 0;
+        single[c] = antlr4::Token::INVALID_TYPE;
+        if (c >= ' ' and c <= '~') classOf[c] |= PRINT;
+        if ((c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z')) classOf[c] |= LETTER | IDCHAR;
+        if (c >= '0' and c <= '9') classOf[c] |= DIGIT | IDCHAR;
+      }
+      classOf[(unsigned char)'_'] |= IDCHAR;
+      for (char c : {' ', '\t', '\r', '\n'}) classOf[(unsigned char)c] |= SPACE;
+
+      const std::pair<char, std::size_t> singles[] = {
+        {'(', AslLexer::T__0}, {')', AslLexer::T__1}, {':', AslLexer::T__2},
+        {',', AslLexer::T__3}, {'[', AslLexer::T__4}, {']', AslLexer::T__5},
+        {';', AslLexer::T__6}, {'+', AslLexer::PLUS}, {'-', AslLexer::NEG},
+        {'*', AslLexer::MUL},  {'%', AslLexer::MOD}
+      };
+      for (auto & s : singles) single[(unsigned char)s.first] = s.second;
+
+      const std::pair<const char *, std::size_t> words[] = {
+        {"and", AslLexer::AND},         {"or", AslLexer::OR},
+        {"not", AslLexer::NOT},         {"var", AslLexer::VAR},
+        {"array", AslLexer::ARRAY},     {"of", AslLexer::OF},
+        {"int", AslLexer::INT},         {"float", AslLexer::FLOAT},
+        {"bool", AslLexer::BOOL},       {"char", AslLexer::CHAR},
+        {"true", AslLexer::TRUE},       {"false", AslLexer::FALSE},
+        {"if", AslLexer::IF},           {"then", AslLexer::THEN},
+        {"else", AslLexer::ELSE},       {"endif", AslLexer::ENDIF},
+        {"while", AslLexer::WHILE},     {"do", AslLexer::DO},
+        {"endwhile", AslLexer::ENDWHILE}, {"return", AslLexer::RETURN},
+        {"func", AslLexer::FUNC},       {"endfunc", AslLexer::ENDFUNC},
+        {"read", AslLexer::READ},       {"write", AslLexer::WRITE}
+      };
+      for (auto & w : words)
+        keywords[w.first[0] - 'a'].push_back(Keyword{w.first, std::strlen(w.first), w.second});
+    }
+
+    // type of the identifier or keyword s[0..n)
+    std::size_t word(const char * s, std::size_t n) const {
+      if (s[0] >= 'a' and s[0] <= 'z')
+        for (const Keyword & k : keywords[s[0] - 'a'])
+          if (k.length == n and std::memcmp(k.text, s, n) == 0) return k.type;
+      return AslLexer::ID;
+    }
+  };
+
+  const ScanTable Table;
+
+  bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+  }
+
+  // text of a lexical error, as antlr4 shows it
+  std::string errorDisplay(const std::string & text) {
+    std::string display;
+    for (char c : text) {
+      if (c == '\n') display += "\\n";
+      else if (c == '\t') display += "\\t";
+      else if (c == '\r') display += "\\r";
+      else display += c;
+    }
+    return display;
+  }
+
+}
+
+
+// Constructor
+AslScanner::AslScanner() :
+  Text{nullptr},
+  Size{0},
+  Input{nullptr},
+  Pos{0},
+  Index{0},
+  Line{1},
+  Column{0},
+  SyntaxErrors{0} {
+}
+
+void AslScanner::setInput(const char * text, std::size_t size, antlr4::CharStream * input) {
+  Text = text;
+  Size = size;
+  Input = input;
+  Pos = Index = Column = 0;
+  Line = 1;
+  SyntaxErrors = 0;
+}
+
+void AslScanner::addErrorListener(antlr4::ANTLRErrorListener * listener) {
+  Listeners.push_back(listener);
+}
+
+void AslScanner::removeErrorListeners() {
+  Listeners.clear();
+}
+
+std::size_t AslScanner::getNumberOfSyntaxErrors() const {
+  return SyntaxErrors;
+}
+
+std::unique_ptr<antlr4::Token> AslScanner::nextToken() {
+  auto & factory = antlr4::CommonTokenFactory::DEFAULT;
+  while (Pos < Size) {
+    std::size_t start = Index, line = Line, column = Column;
+    std::size_t end;
+    std::size_t type = match(end);
+    if (type == antlr4::Token::INVALID_TYPE) {
+      error(end);
+      continue;
+    }
+    if (type == AslLexer::WS or type == AslLexer::COMMENT) {
+      advance(end);
+      continue;
+    }
+    std::string text(Text + Pos, end - Pos);
+    advance(end);
+    return factory->create(std::make_pair(this, Input), type, text,
+                           antlr4::Token::DEFAULT_CHANNEL, start, Index - 1, line, column);
+  }
+  return factory->create(std::make_pair(this, Input), antlr4::Token::EOF, "",
+                         antlr4::Token::DEFAULT_CHANNEL, Index, Index - 1, Line, Column);
+}
+
+std::size_t AslScanner::match(std::size_t & end) const {
+  const unsigned char * s = reinterpret_cast<const unsigned char *>(Text);
+  std::size_t n = Size;
+  std::size_t p = Pos;
+  unsigned char c = s[p];
+  // the character after p+k, or 0 past the end (no rule can take a 0)
+  auto next = [&](std::size_t k) -> unsigned char { return p + k < n ? s[p + k] : 0; };
+
+  if (Table.classOf[c] & SPACE) {
+    while (p < n and (Table.classOf[s[p]] & SPACE)) ++p;
+    end = p;
+    return AslLexer::WS;
+  }
+  if (Table.classOf[c] & LETTER) {
+    while (p < n and (Table.classOf[s[p]] & IDCHAR)) ++p;
+    end = p;
+    return Table.word(Text + Pos, p - Pos);
+  }
+  if (Table.classOf[c] & DIGIT) {
+    while (p < n and (Table.classOf[s[p]] & DIGIT)) ++p;
+    if (next(0) != '.' or not (Table.classOf[next(1)] & DIGIT)) {
+      end = p;
+      return AslLexer::INTVAL;
+    }
+    p += 2;
+    while (p < n and (Table.classOf[s[p]] & DIGIT)) ++p;
+    end = p;
+    return AslLexer::FLOATVAL;
+  }
+  if (Table.single[c] != antlr4::Token::INVALID_TYPE) {
+    end = p + 1;
+    return Table.single[c];
+  }
+
+  switch (c) {
+  case '=':
+  case '<':
+  case '>':
+    end = p + (next(1) == '=' ? 2 : 1);
+    if (c == '=') return end == p + 2 ? AslLexer::EQUAL : AslLexer::ASSIGN;
+    if (c == '<') return end == p + 2 ? AslLexer::LEQ : AslLexer::LT;
+    return end == p + 2 ? AslLexer::GEQ : AslLexer::GT;
+  case '!':
+    end = p + 1;
+    if (next(1) != '=') return antlr4::Token::INVALID_TYPE;
+    end = p + 2;
+    return AslLexer::NEQUAL;
+  case '/': {
+    // a comment must end with a newline; otherwise it is just a '/'
+    end = p + 1;
+    if (next(1) != '/') return AslLexer::DIV;
+    std::size_t q = p + 2;
+    while (q < n and s[q] != '\n' and s[q] != '\r') ++q;
+    if (q < n and s[q] == '\r') ++q;
+    if (q == n or s[q] != '\n') return AslLexer::DIV;
+    end = q + 1;
+    return AslLexer::COMMENT;
+  }
+  case '"':
+    for (++p; p < n and s[p] != '"'; ++p)
+      if (s[p] == '\\') {
+        if (not std::strchr("btnfr\"'\\", next(1)) or next(1) == 0) {
+          end = p + 1;
+          return antlr4::Token::INVALID_TYPE;
+        }
+        ++p;
+      }
+    end = p + 1;
+    if (p == n) return antlr4::Token::INVALID_TYPE;
+    return AslLexer::STRING;
+  case '\'':
+    // '' or '<printable>' or '\n', '\t', '\'' (and the longest of them:
+    // ''' is a quote, and '\' a backslash unless '\'' follows)
+    if (next(1) == '\'') {
+      end = p + (next(2) == '\'' ? 3 : 2);
+      return AslLexer::CHARVAL;
+    }
+    if (next(1) == '\\' and next(2) == '\'') {
+      end = p + (next(3) == '\'' ? 4 : 3);
+      return AslLexer::CHARVAL;
+    }
+    if (next(1) == '\\' and (next(2) == 'n' or next(2) == 't')) {
+      end = p + 3;
+      if (next(3) != '\'') return antlr4::Token::INVALID_TYPE;
+      end = p + 4;
+      return AslLexer::CHARVAL;
+    }
+    if (Table.classOf[next(1)] & PRINT) {
+      end = p + 2;
+      if (next(2) != '\'') return antlr4::Token::INVALID_TYPE;
+      end = p + 3;
+      return AslLexer::CHARVAL;
+    }
+    end = p + 1;
+    return antlr4::Token::INVALID_TYPE;
+  default:
+    end = p;
+    return antlr4::Token::INVALID_TYPE;
+  }
+}
+
+void AslScanner::error(std::size_t fail) {
+  // the wrong character is taken whole (it may have several bytes)
+  std::size_t stop = fail;
+  if (stop < Size)
+    for (++stop; stop < Size and isContinuation(Text[stop]); ++stop);
+  else
+    stop = Size;
+  std::string msg = "token recognition error at: '" +
+                    errorDisplay(std::string(Text + Pos, stop - Pos)) + "'";
+  for (auto listener : Listeners)
+    listener->syntaxError(nullptr, nullptr, Line, Column, msg, nullptr);
+  ++SyntaxErrors;
+  advance(stop);
+}
+
+void AslScanner::advance(std::size_t end) {
+  for (; Pos < end; ++Pos) {
+    unsigned char c = Text[Pos];
+    if (isContinuation(c)) continue;
+    ++Index;
+    if (c == '\n') {
+      ++Line;
+      Column = 0;
+    }
+    else ++Column;
+  }
+}
+
+std::size_t AslScanner::getLine() const {
+  return Line;
+}
+
+std::size_t AslScanner::getCharPositionInLine() {
+  return Column;
+}
+
+antlr4::CharStream * AslScanner::getInputStream() {
+  return Input;
+}
+
+std::string AslScanner::getSourceName() {
+  return Input ? Input->getSourceName() : std::string();
+}
+
+Ref<antlr4::TokenFactory<antlr4::CommonToken>> AslScanner::getTokenFactory() {
+  return antlr4::CommonTokenFactory::DEFAULT;
+}
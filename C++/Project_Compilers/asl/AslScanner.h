@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslScanner - Hand-written lexer for the Asl language, with
+//                 the same tokens as the one generated by antlr4
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class AslScanner: a lexer for Asl written by hand, which produces
+// exactly the tokens of AslLexer (the same types, texts, positions and
+// lexical errors) a good deal faster: it scans the bytes of the program
+// with a table of character classes and a few hand-made automata,
+// instead of simulating the ATN of the grammar. It is a TokenSource, so
+// AslParser reads from it as from AslLexer.
+// Like AslLexer, it takes the longest match (a keyword wins over an
+// identifier of the same length), skips comments and white space, and
+// after a lexical error it reports the text from the start of the
+// token to the wrong character, and goes on after that character.
+// Lines and columns count code points of the UTF-8 text.
+
+class AslScanner : public antlr4::TokenSource {
+
+public:
+
+  // Constructor
+  AslScanner();
+
+  // Start scanning the 'size' bytes of 'text' (UTF-8), which are also
+  // those of 'input': the tokens refer to it, with their start and stop
+  // indexes (as those of AslLexer do). The text is read in place, so it
+  // must not change while it is scanned. The number of errors is reset
+  void setInput(const char * text, std::size_t size, antlr4::CharStream * input);
+
+  // Listeners of the lexical errors (there are none by default)
+  void addErrorListener(antlr4::ANTLRErrorListener * listener);
+  void removeErrorListeners();
+
+  // Number of lexical errors found since the last setInput
+  std::size_t getNumberOfSyntaxErrors() const;
+
+  // Methods of antlr4::TokenSource
+  std::unique_ptr<antlr4::Token> nextToken() override;
+  std::size_t getLine() const override;
+  std::size_t getCharPositionInLine() override;
+  antlr4::CharStream * getInputStream() override;
+  std::string getSourceName() override;
+  Ref<antlr4::TokenFactory<antlr4::CommonToken>> getTokenFactory() override;
+
+private:
+
+  // Type of the longest token at the current position, whose end is
+  // left in 'end'; on a lexical error, Token::INVALID_TYPE, with the
+  // position of the wrong character in 'end'
+  std::size_t match(std::size_t & end) const;
+
+  // Report the lexical error of a token whose wrong character is at
+  // 'fail' (or past the end of the text), and skip them
+  void error(std::size_t fail);
+
+  // Move the current position to 'end', updating index, line and column
+  void advance(std::size_t end);
+
+  // Text being scanned (and its size) and the character stream it
+  // comes from
+  const char * Text;
+  std::size_t Size;
+  antlr4::CharStream * Input;
+
+  // Current position: byte of Text, code point index, line and column
+  std::size_t Pos;
+  std::size_t Index;
+  std::size_t Line;
+  std::size_t Column;
+
+  // Lexical errors
+  std::vector<antlr4::ANTLRErrorListener *> Listeners;
+  std::size_t SyntaxErrors;
+
+};  // class AslScanner
@@ -36,7 +36,9 @@
 #include "../common/code.h"
 
 #include <string>
+#include <vector>
 #include <cstddef>    // std::size_t
+#include <utility>    // std::move
 
 // uncomment the following line to enable debugging messages with DEBUG*
 // #define DEBUG_BUILD
@@ -48,10 +50,17 @@
 // Constructor
 CodeGenVisitor::CodeGenVisitor(TypesMgr       & Types,
                                SymTable       & Symbols,
-                               TreeDecoration & Decorations) :
+                               TreeDecoration & Decorations,
+                               counters       & Counters) :
   Types{Types},
   Symbols{Symbols},
-  Decorations{Decorations} {
+  Decorations{Decorations},
+  codeCounters{Counters},
+  currNames{nullptr} {
+}
+
+void CodeGenVisitor::selectFunctions(const std::vector<bool> & selected) {
+  selectedFunctions = selected;
 }
 
 // Accessor/Mutator to the attribute currFunctionType
@@ -69,8 +78,10 @@ antlrcpp::Any CodeGenVisitor::visitProgram(AslParser::ProgramContext *ctx) {
   code my_code;
   SymTable::ScopeId sc = getScopeDecor(ctx);
   Symbols.pushThisScope(sc);
-  for (auto ctxFunc : ctx->function()) { 
-    subroutine subr = visit(ctxFunc);
+  std::vector<AslParser::FunctionContext *> functions = ctx->function();
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    if (not selectedFunctions.empty() and not selectedFunctions[i]) continue;
+    subroutine subr = visit(functions[i]);
     my_code.add_subroutine(subr);
   }
   Symbols.popScope();
@@ -83,6 +94,9 @@ antlrcpp::Any CodeGenVisitor::visitFunction(AslParser::FunctionContext *ctx) {
   SymTable::ScopeId sc = getScopeDecor(ctx);
   Symbols.pushThisScope(sc);
   subroutine subr(ctx->ID()->getText());
+  currNames = &subr.get_names();
+  // operands built from plain strings also go to this subroutine
+  nameTable::Scope names(subr.get_names());
   codeCounters.reset();
   std::vector<var> && lvars = visit(ctx->declarations());
   for (auto & onevar : lvars) subr.add_var(onevar);
@@ -99,8 +113,8 @@ antlrcpp::Any CodeGenVisitor::visitFunction(AslParser::FunctionContext *ctx) {
   }
     
   code = visit(ctx->statements());
-  code = code || instruction(instruction::RETURN());
-  subr.set_instructions(code);
+  code = std::move(code) || instruction(instruction::RETURN());
+  subr.set_instructions(std::move(code));
   Symbols.popScope();
   DEBUG_EXIT();
   return subr;
@@ -147,7 +161,7 @@ antlrcpp::Any CodeGenVisitor::visitStatements(AslParser::StatementsContext *ctx)
   instructionList code;
   for (auto stCtx : ctx->statement()) {
     instructionList && codeS = visit(stCtx);
-    code = code || codeS;
+    code = std::move(code) || codeS;
   }
   DEBUG_EXIT();
   return code;
@@ -157,43 +171,29 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
   DEBUG_ENTER();
   instructionList code;
   CodeAttribs     && codAtsE1 = visit(ctx->left_expr());
-  std::string           addr1 = codAtsE1.addr;
-  std::string           offs1 = codAtsE1.offs;
+  operand               addr1 = codAtsE1.addr;
   instructionList &     code1 = codAtsE1.code;
   TypesMgr::TypeId tid1 = getTypeDecor(ctx->left_expr());
   CodeAttribs     && codAtsE2 = visit(ctx->expr());
-  std::string           addr2 = codAtsE2.addr;
-  std::string           offs2 = codAtsE2.offs;
+  operand               addr2 = codAtsE2.addr;
   instructionList &     code2 = codAtsE2.code;
   TypesMgr::TypeId tid2 = getTypeDecor(ctx->expr());
   if (ctx->left_expr()->expr()) {
     CodeAttribs     && codAtsE3 = visit(ctx->left_expr()->expr());
-    std::string           addr3 = codAtsE3.addr;
+    operand               addr3 = codAtsE3.addr;
     instructionList &     code3 = codAtsE3.code;
-    code = code1 || code3 || code2;
+    code = std::move(code1) || code3 || code2;
     if(Types.isFloatTy(tid1) and Types.isIntegerTy(tid2)) {
-        std::string temp = "%"+codeCounters.newTEMP();
-        code = code || instruction::FLOAT(temp, addr2) || instruction::XLOAD(addr1, addr3 , temp);
-    } else code = code || instruction::XLOAD(addr1, addr3 , addr2);
+        operand temp = codeCounters.newTEMPoperand();
+        code = std::move(code) || instruction::FLOAT(temp, addr2) || instruction::XLOAD(addr1, addr3 , temp);
+    } else code = std::move(code) || instruction::XLOAD(addr1, addr3 , addr2);
   } else if (Types.isFloatTy(tid1) and Types.isIntegerTy(tid2) ) {
-    std::string temp = "%"+codeCounters.newTEMP();
-    code = code1 || code2 || instruction::FLOAT(temp, addr2) || instruction::LOAD(addr1, temp);
+    operand temp = codeCounters.newTEMPoperand();
+    code = std::move(code1) || code2 || instruction::FLOAT(temp, addr2) || instruction::LOAD(addr1, temp);
   } else if (Types.isArrayTy(tid1) and Types.isArrayTy(tid2)) {
-    std::string temp = "%"+codeCounters.newTEMP();
-    std::string i = "%"+codeCounters.newTEMP();
-    std::string k = "%"+codeCounters.newTEMP();
-    std::string cond = "%"+codeCounters.newTEMP();
-    std::string size = "%"+codeCounters.newTEMP();
-    std::string label = "while"+codeCounters.newLabelWHILE();
-    std::string labelEndWhile = "end"+label;
     unsigned int length = Types.getArraySize(tid2);
-        
-    code = code1 || code2;
-    code = code || instruction::ILOAD(size, std::to_string(length)) || instruction::ILOAD(i, "0") || instruction::ILOAD(k, "1");
-    code = code || instruction::LABEL(label) || instruction::LT(cond, i, size) || instruction::FJUMP(cond, labelEndWhile);
-    code = code || instruction::LOADX(temp, addr2, i) || instruction::XLOAD(addr1, i, temp);
-    code = code || instruction::ADD(i, i, k) || instruction::UJUMP(label) || instruction::LABEL(labelEndWhile);
-  } else code = code1 || code2 || instruction::LOAD(addr1, addr2);
+    code = std::move(code1) || code2 || instruction::ACOPY(addr1, addr2, operand::integer(length));
+  } else code = std::move(code1) || code2 || instruction::LOAD(addr1, addr2);
   DEBUG_EXIT();
   return code;
 }
@@ -201,20 +201,18 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
 antlrcpp::Any CodeGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
   DEBUG_ENTER();
   instructionList code;
-  CodeAttribs     && codAtsE = visit(ctx->expr());
-  std::string          addr1 = codAtsE.addr;
-  instructionList &    code1 = codAtsE.code;
-  instructionList &&   code2 = visit(ctx->statements(0));
   std::string label = codeCounters.newLabelIF();
-  std::string labelElse = "else"+label;
-  std::string labelEndIf = "endif"+label;
+  operand labelElse = nameOperand("else"+label);
+  operand labelEndIf = nameOperand("endif"+label);
+  instructionList &&   code1 = codeCondJump(ctx->expr(), ctx->statements(1) ? labelElse : labelEndIf, false);
+  instructionList &&   code2 = visit(ctx->statements(0));
   if(ctx->statements(1)) {
     instructionList &&   code3 = visit(ctx->statements(1));
-    code = code1 || instruction::FJUMP(addr1, labelElse) || code2 || instruction::UJUMP(labelEndIf) || instruction::LABEL(labelElse) || code3;
+    code = std::move(code1) || code2 || instruction::UJUMP(labelEndIf) || instruction::LABEL(labelElse) || code3;
   } else {
-      code = code1 || instruction::FJUMP(addr1, labelEndIf) || code2 ;
+      code = std::move(code1) || code2 ;
   }
-  code = code || instruction::LABEL(labelEndIf) ; 
+  code = std::move(code) || instruction::LABEL(labelEndIf) ; 
   DEBUG_EXIT();
   return code;
 }
@@ -222,14 +220,12 @@ antlrcpp::Any CodeGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
 antlrcpp::Any CodeGenVisitor::visitWhileStmt(AslParser::WhileStmtContext *ctx) {
   DEBUG_ENTER();
   instructionList code;
-  CodeAttribs     && codAtsE = visit(ctx->expr());
-  std::string          addr1 = codAtsE.addr;
-  instructionList &    code1 = codAtsE.code;
+  std::string labelWhile = "while"+codeCounters.newLabelWHILE();
+  operand label = nameOperand(labelWhile);
+  operand labelEndWhile = nameOperand("end"+labelWhile);
+  instructionList &&   code1 = codeCondJump(ctx->expr(), labelEndWhile, false);
   instructionList &&   code2 = visit(ctx->statements());
-  std::string label = "while"+codeCounters.newLabelWHILE();
-  std::string labelEndWhile = "end"+label;
-//   std::string temp = "%"+codeCounters.newTEMP();
-  code = instruction::LABEL(label) || code1 || instruction::FJUMP(addr1, labelEndWhile) ||
+  code = instruction::LABEL(label) || code1 ||
          code2 || instruction::UJUMP(label) || instruction::LABEL(labelEndWhile);
   DEBUG_EXIT();
   return code;
@@ -245,29 +241,29 @@ antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
         TypesMgr::TypeId tidp = getTypeDecor(ctx->list_expr()->expr(i));
         CodeAttribs     && codAt = visit(ctx->list_expr()->expr(i));
         instructionList &   exprCode = codAt.code;
-        std::string         addr = codAt.addr;
-        code = code || exprCode;
+        operand             addr = codAt.addr;
+        code = std::move(code) || exprCode;
 //         if (Types.isFloatTy(params[i]) && Types.isIntegerTy(tidp) && not Types.isArrayTy(params[i])) {
         if (Types.isFloatTy(params[i]) && Types.isIntegerTy(tidp)) {
-            std::string temp = "%"+codeCounters.newTEMP();
-            code = code || instruction::FLOAT(temp,addr) || instruction::PUSH(temp);
+            operand temp = codeCounters.newTEMPoperand();
+            code = std::move(code) || instruction::FLOAT(temp,addr) || instruction::PUSH(temp);
         } 
         else if (Types.isArrayTy(params[i])) {
             std::string name = ctx->list_expr()->expr(i)->getText();
             bool isParam = Symbols.isParameterClass(name);
-            std::string temp = "%"+codeCounters.newTEMP();
-            if (isParam) code = code || instruction::LOAD(temp, addr);
-            else code = code || instruction::ALOAD(temp, addr);
-            code = code || instruction::PUSH(temp);
-        } else code = code || instruction::PUSH(addr);
+            operand temp = codeCounters.newTEMPoperand();
+            if (isParam) code = std::move(code) || instruction::LOAD(temp, addr);
+            else code = std::move(code) || instruction::ALOAD(temp, addr);
+            code = std::move(code) || instruction::PUSH(temp);
+        } else code = std::move(code) || instruction::PUSH(addr);
     }
-    code = code || instruction::CALL(ctx->ident()->getText());
-    for (uint i = 0;i < ctx->list_expr()->expr().size(); i++) code = code || instruction::POP("");
+    code = std::move(code) || instruction::CALL(nameOperand(ctx->ident()->getText()));
+    for (uint i = 0;i < ctx->list_expr()->expr().size(); i++) code = std::move(code) || instruction::POP("");
   } else {
-    std::string name = ctx->ident()->getText();
-    code = code || instruction::CALL(name);
+    operand name = nameOperand(ctx->ident()->getText());
+    code = std::move(code) || instruction::CALL(name);
   }
-  code = code || instruction::POP("");
+  code = std::move(code) || instruction::POP("");
   DEBUG_EXIT();
   return code;
 }
@@ -275,23 +271,23 @@ antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
 antlrcpp::Any CodeGenVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAtsE = visit(ctx->left_expr());
-  std::string          addr1 = codAtsE.addr;
+  operand              addr1 = codAtsE.addr;
   instructionList &    code1 = codAtsE.code;
   instructionList &     code = code1;
   TypesMgr::TypeId tid1 = getTypeDecor(ctx->left_expr());
   if (ctx->left_expr()->expr()) {
-    std::string temp = "%"+codeCounters.newTEMP();
-    if (Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = code1 || instruction::READI(temp);
-    else if (Types.isFloatTy(tid1)) code = code1 || instruction::READF(temp);
-    else code = code1 || instruction::READC(temp);
+    operand temp = codeCounters.newTEMPoperand();
+    if (Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = std::move(code1) || instruction::READI(temp);
+    else if (Types.isFloatTy(tid1)) code = std::move(code1) || instruction::READF(temp);
+    else code = std::move(code1) || instruction::READC(temp);
     CodeAttribs     && codAtsE3 = visit(ctx->left_expr()->expr());
-    std::string           addr3 = codAtsE3.addr;
+    operand               addr3 = codAtsE3.addr;
     instructionList &     code3 = codAtsE3.code;
-    code = code || code3 || instruction::XLOAD(addr1, addr3, temp);
+    code = std::move(code) || code3 || instruction::XLOAD(addr1, addr3, temp);
   } else {
-    if (Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = code || instruction::READI(addr1);
-    else if (Types.isFloatTy(tid1)) code = code || instruction::READF(addr1);
-    else code = code || instruction::READC(addr1);
+    if (Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = std::move(code) || instruction::READI(addr1);
+    else if (Types.isFloatTy(tid1)) code = std::move(code) || instruction::READF(addr1);
+    else code = std::move(code) || instruction::READC(addr1);
   }
   DEBUG_EXIT();
   return code;
@@ -300,13 +296,13 @@ antlrcpp::Any CodeGenVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
 antlrcpp::Any CodeGenVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt1 = visit(ctx->expr());
-  std::string         addr1 = codAt1.addr;
+  operand             addr1 = codAt1.addr;
   instructionList &   code1 = codAt1.code;
   instructionList &    code = code1;
   TypesMgr::TypeId tid1 = getTypeDecor(ctx->expr());
-  if(Types.isCharacterTy(tid1)) code = code || instruction::WRITEC(addr1);
-  else if(Types.isFloatTy(tid1)) code = code || instruction::WRITEF(addr1);
-  else if(Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = code || instruction::WRITEI(addr1);
+  if(Types.isCharacterTy(tid1)) code = std::move(code) || instruction::WRITEC(addr1);
+  else if(Types.isFloatTy(tid1)) code = std::move(code) || instruction::WRITEF(addr1);
+  else if(Types.isIntegerTy(tid1) || Types.isBooleanTy(tid1)) code = std::move(code) || instruction::WRITEI(addr1);
   DEBUG_EXIT();
   return code;
 }
@@ -314,8 +310,8 @@ antlrcpp::Any CodeGenVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
 antlrcpp::Any CodeGenVisitor::visitWriteString(AslParser::WriteStringContext *ctx) {
   DEBUG_ENTER();
   instructionList code;
-  std::string s = ctx->STRING()->getText();
-  code = code || instruction::WRITES(s);
+  operand s = nameOperand(ctx->STRING()->getText());
+  code = std::move(code) || instruction::WRITES(s);
   DEBUG_EXIT();
   return code;
 }
@@ -325,18 +321,18 @@ antlrcpp::Any CodeGenVisitor::visitReturnStmt(AslParser::ReturnStmtContext *ctx)
   instructionList code;
   if(ctx->expr()) {
     CodeAttribs     && codAt1 = visit(ctx->expr());
-    std::string         addr1 = codAt1.addr;
+    operand             addr1 = codAt1.addr;
     TypesMgr::TypeId t2 = getCurrentFunctionTy();
     TypesMgr::TypeId t = getTypeDecor(ctx->expr());
-    if (Types.isBooleanTy(t2) or Types.isIntegerTy(t2)) code = codAt1.code || instruction::ILOAD("_result", addr1);
-    else if (Types.isCharacterTy(t2) and not Types.isCharacterTy(t)) code = codAt1.code || instruction::CHLOAD("_result", addr1);
+    if (Types.isBooleanTy(t2) or Types.isIntegerTy(t2)) code = std::move(codAt1.code) || instruction::ILOAD(nameOperand("_result"), addr1);
+    else if (Types.isCharacterTy(t2) and not Types.isCharacterTy(t)) code = std::move(codAt1.code) || instruction::CHLOAD(nameOperand("_result"), addr1);
     else {
-        std::string temp = "%"+codeCounters.newTEMP();
-        if (Types.isIntegerTy(t)) code = codAt1.code  || instruction::FLOAT(temp, addr1) || instruction::FLOAD("_result", temp);
-        else code = codAt1.code  || instruction::FLOAD("_result", addr1);
+        operand temp = codeCounters.newTEMPoperand();
+        if (Types.isIntegerTy(t)) code = std::move(codAt1.code)  || instruction::FLOAT(temp, addr1) || instruction::FLOAD(nameOperand("_result"), temp);
+        else code = std::move(codAt1.code)  || instruction::FLOAD(nameOperand("_result"), addr1);
     }
   } 
-  code = code || instruction::RETURN();
+  code = std::move(code) || instruction::RETURN();
   DEBUG_EXIT();
   return code;
 }
@@ -353,15 +349,15 @@ antlrcpp::Any CodeGenVisitor::visitArrayAccess(AslParser::ArrayAccessContext *ct
   CodeAttribs && codAts1 = visit(ctx->ident());
   CodeAttribs     && codAts2 = visit(ctx->expr());
 
-  std::string temp = "%"+codeCounters.newTEMP();
-  std::string         addr1 = codAts1.addr;
+  operand temp = codeCounters.newTEMPoperand();
+  operand             addr1 = codAts1.addr;
   //std::string           offs1 = codAts1.offs;
   instructionList &   code1 = codAts1.code;
   instructionList &   code2 = codAts2.code;
-  std::string         addr2 = codAts2.addr;
+  operand             addr2 = codAts2.addr;
 
-  instructionList code = code1 || code2 || instruction::LOADX(temp, addr1, addr2);
-  CodeAttribs codAts(temp, "", code);
+  instructionList code = std::move(code1) || code2 || instruction::LOADX(temp, addr1, addr2);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -370,20 +366,20 @@ antlrcpp::Any CodeGenVisitor::visitUnaryOps(AslParser::UnaryOpsContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt = visit(ctx->expr());
   instructionList &   code = codAt.code;
-  std::string         addr = codAt.addr;
-  std::string temp = "%"+codeCounters.newTEMP();
-  if(ctx->NOT()) code = code || instruction::NOT(temp, addr);
+  operand             addr = codAt.addr;
+  operand temp = codeCounters.newTEMPoperand();
+  if(ctx->NOT()) code = std::move(code) || instruction::NOT(temp, addr);
   else if(ctx->NEG()) {
     TypesMgr::TypeId texpr = getTypeDecor(ctx->expr());
-    if (Types.isFloatTy(texpr)) code = code || instruction::FNEG(temp, addr);
-    else code = code || instruction::NEG(temp, addr);
+    if (Types.isFloatTy(texpr)) code = std::move(code) || instruction::FNEG(temp, addr);
+    else code = std::move(code) || instruction::NEG(temp, addr);
   } else {
     TypesMgr::TypeId texpr = getTypeDecor(ctx->expr());
-    std::string temp1 = "%"+codeCounters.newTEMP();
-    if (Types.isFloatTy(texpr)) code = code || instruction::FLOAD(temp1, "0.0") || instruction::FADD(temp, temp1, addr);
-    else code = code || instruction::ILOAD(temp1, "0") || instruction::ADD(temp, temp1, addr);
+    operand temp1 = codeCounters.newTEMPoperand();
+    if (Types.isFloatTy(texpr)) code = std::move(code) || instruction::FLOAD(temp1, nameOperand("0.0")) || instruction::FADD(temp, temp1, addr);
+    else code = std::move(code) || instruction::ILOAD(temp1, "0") || instruction::ADD(temp, temp1, addr);
   }
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -391,69 +387,68 @@ antlrcpp::Any CodeGenVisitor::visitUnaryOps(AslParser::UnaryOpsContext *ctx) {
 antlrcpp::Any CodeGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt1 = visit(ctx->expr(0));
-  std::string         addr1 = codAt1.addr;
+  operand             addr1 = codAt1.addr;
   instructionList &   code1 = codAt1.code;
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
-  std::string         addr2 = codAt2.addr;
+  operand             addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
+  instructionList &&   code = std::move(code1) || code2;
   TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
   TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
   TypesMgr::TypeId  t = getTypeDecor(ctx);
-  std::string temp = "%"+codeCounters.newTEMP();
-  std::string temp1 = "%"+codeCounters.newTEMP(), temp2 = "%"+codeCounters.newTEMP();
+  operand temp = codeCounters.newTEMPoperand();
+  operand temp1 = codeCounters.newTEMPoperand(), temp2 = codeCounters.newTEMPoperand();
   if (ctx->MUL()) {
     if(Types.isFloatTy(t)) {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FMUL(temp, temp1, temp2);
+        code = std::move(code) || instruction::FMUL(temp, temp1, temp2);
     }
-    else code = code || instruction::MUL(temp, addr1, addr2);
+    else code = std::move(code) || instruction::MUL(temp, addr1, addr2);
   }
   else if (ctx->PLUS()) {
     if(Types.isFloatTy(t)) {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FADD(temp, temp1, temp2);
+        code = std::move(code) || instruction::FADD(temp, temp1, temp2);
     }
-    else code = code || instruction::ADD(temp, addr1, addr2);
+    else code = std::move(code) || instruction::ADD(temp, addr1, addr2);
   }
   else if (ctx->NEG()) {
     if(Types.isFloatTy(t)) {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FSUB(temp, temp1, temp2);
+        code = std::move(code) || instruction::FSUB(temp, temp1, temp2);
     }
-    else code = code || instruction::SUB(temp, addr1, addr2);
+    else code = std::move(code) || instruction::SUB(temp, addr1, addr2);
   }
   else if (ctx->MOD()) {
-    std::string tempM1 = "%"+codeCounters.newTEMP(), tempM2 = "%"+codeCounters.newTEMP();
     if(Types.isFloatTy(t)) {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FDIV(tempM1, temp1, temp2) || instruction::FMUL(tempM2, tempM1, temp2) || instruction::FSUB(temp, temp1, tempM2);
+        code = std::move(code) || instruction::FMOD(temp, temp1, temp2);
     }
-    else code = code || instruction::DIV(tempM1, addr1, addr2) || instruction::MUL(tempM2, tempM1, addr2) || instruction::SUB(temp, addr1, tempM2);
+    else code = std::move(code) || instruction::MOD(temp, addr1, addr2);
   }
   else {
     if(Types.isFloatTy(t)) {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FDIV(temp, temp1, temp2);
+        code = std::move(code) || instruction::FDIV(temp, temp1, temp2);
     }
-    else code = code || instruction::DIV(temp, addr1, addr2);
+    else code = std::move(code) || instruction::DIV(temp, addr1, addr2);
   }
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -461,75 +456,75 @@ antlrcpp::Any CodeGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx)
 antlrcpp::Any CodeGenVisitor::visitRelational(AslParser::RelationalContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt1 = visit(ctx->expr(0));
-  std::string         addr1 = codAt1.addr;
+  operand             addr1 = codAt1.addr;
   instructionList &   code1 = codAt1.code;
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
-  std::string         addr2 = codAt2.addr;
+  operand             addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
+  instructionList &&   code = std::move(code1) || code2;
   TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
   TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
   //TypesMgr::TypeId  t = getTypeDecor(ctx);
-  std::string temp = "%"+codeCounters.newTEMP();
-  std::string temp1 = "%"+codeCounters.newTEMP(), temp2 = "%"+codeCounters.newTEMP();
+  operand temp = codeCounters.newTEMPoperand();
+  operand temp1 = codeCounters.newTEMPoperand(), temp2 = codeCounters.newTEMPoperand();
   
   if(ctx->EQUAL()) {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::EQ(temp, addr1, addr2);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::EQ(temp, addr1, addr2);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FEQ(temp, temp1, temp2);
+        code = std::move(code) || instruction::FEQ(temp, temp1, temp2);
     }
   } else if(ctx->GEQ()) {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::LE(temp, addr2, addr1);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::LE(temp, addr2, addr1);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FLE(temp, temp2, temp1);
+        code = std::move(code) || instruction::FLE(temp, temp2, temp1);
     }
   } else if(ctx->GT()) {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::LT(temp, addr2, addr1);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::LT(temp, addr2, addr1);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FLT(temp, temp2, temp1);
+        code = std::move(code) || instruction::FLT(temp, temp2, temp1);
     }
   } else if(ctx->LEQ()) {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::LE(temp, addr1, addr2);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::LE(temp, addr1, addr2);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FLE(temp, temp1, temp2);
+        code = std::move(code) || instruction::FLE(temp, temp1, temp2);
     }
   } else if(ctx->LT()) {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::LT(temp, addr1, addr2);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::LT(temp, addr1, addr2);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FLT(temp, temp1, temp2);
+        code = std::move(code) || instruction::FLT(temp, temp1, temp2);
     }
   } else {
-    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = code || instruction::EQ(temp, addr1, addr2);
+    if(not Types.isFloatTy(t1) and not Types.isFloatTy(t2)) code = std::move(code) || instruction::EQ(temp, addr1, addr2);
     else {
-        if(not Types.isFloatTy(t1)) code = code || instruction::FLOAT(temp1, addr1);
+        if(not Types.isFloatTy(t1)) code = std::move(code) || instruction::FLOAT(temp1, addr1);
         else temp1 = addr1;
-        if(not Types.isFloatTy(t2)) code = code || instruction::FLOAT(temp2, addr2);
+        if(not Types.isFloatTy(t2)) code = std::move(code) || instruction::FLOAT(temp2, addr2);
         else temp2 = addr2;
-        code = code || instruction::FEQ(temp, temp1, temp2);
+        code = std::move(code) || instruction::FEQ(temp, temp1, temp2);
     }
-    code = code || instruction::NOT(temp, temp);
+    code = std::move(code) || instruction::NOT(temp, temp);
   }
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -537,34 +532,98 @@ antlrcpp::Any CodeGenVisitor::visitRelational(AslParser::RelationalContext *ctx)
 antlrcpp::Any CodeGenVisitor::visitLogical(AslParser::LogicalContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt1 = visit(ctx->expr(0));
-  std::string         addr1 = codAt1.addr;
+  operand             addr1 = codAt1.addr;
   instructionList &   code1 = codAt1.code;
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
-  std::string         addr2 = codAt2.addr;
+  operand             addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
-  // TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  // TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
-  //TypesMgr::TypeId  t = getTypeDecor(ctx);
-  std::string temp = "%"+codeCounters.newTEMP();
-  if(ctx->AND()) code = code || instruction::AND(temp, addr1, addr2);
-  else code = code || instruction::OR(temp, addr1, addr2);
-  CodeAttribs codAts(temp, "", code);
+  // short-circuit: the second operand is only evaluated when the
+  // first one does not decide the value ("false and ...", "true or ...")
+  operand temp = codeCounters.newTEMPoperand();
+  operand labelEnd = nameOperand("shortcut"+codeCounters.newLabelLOGIC());
+  instructionList &&   code = std::move(code1) || instruction::LOAD(temp, addr1);
+  if(ctx->AND()) code = std::move(code) || instruction::FJUMP(temp, labelEnd);
+  else {
+    operand notTemp = codeCounters.newTEMPoperand();
+    code = std::move(code) || instruction::NOT(notTemp, temp) || instruction::FJUMP(notTemp, labelEnd);
+  }
+  code = std::move(code) || code2 || instruction::LOAD(temp, addr2) || instruction::LABEL(labelEnd);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
   
+// Code that jumps to label when the boolean expression evaluates to
+// jumpIf, and falls through otherwise. Logical operators are evaluated
+// with short-circuit: each operand is a jump, no value is computed.
+instructionList CodeGenVisitor::codeCondJump(AslParser::ExprContext *ctx,
+                                             const operand & label, bool jumpIf) {
+  if (auto parens = dynamic_cast<AslParser::ParensContext *>(ctx))
+    return codeCondJump(parens->expr(), label, jumpIf);
+  auto unary = dynamic_cast<AslParser::UnaryOpsContext *>(ctx);
+  if (unary and unary->NOT())
+    return codeCondJump(unary->expr(), label, not jumpIf);
+  if (auto logical = dynamic_cast<AslParser::LogicalContext *>(ctx)) {
+    // the value that decides the operation with the first operand alone
+    bool decides = logical->OR() != nullptr;
+    if (decides == jumpIf)
+      return codeCondJump(logical->expr(0), label, jumpIf) || codeCondJump(logical->expr(1), label, jumpIf);
+    operand labelSkip = nameOperand("shortcut"+codeCounters.newLabelLOGIC());
+    return codeCondJump(logical->expr(0), labelSkip, decides) ||
+           codeCondJump(logical->expr(1), label, jumpIf) || instruction::LABEL(labelSkip);
+  }
+  if (auto relational = dynamic_cast<AslParser::RelationalContext *>(ctx)) {
+    // a single compare-and-branch, without the boolean in a temporary
+    CodeAttribs     && codAt1 = visit(relational->expr(0));
+    operand             addr1 = codAt1.addr;
+    instructionList &   code1 = codAt1.code;
+    CodeAttribs     && codAt2 = visit(relational->expr(1));
+    operand             addr2 = codAt2.addr;
+    instructionList &   code2 = codAt2.code;
+    instructionList &&   code = std::move(code1) || code2;
+    TypesMgr::TypeId t1 = getTypeDecor(relational->expr(0));
+    TypesMgr::TypeId t2 = getTypeDecor(relational->expr(1));
+    bool isFloat = Types.isFloatTy(t1) or Types.isFloatTy(t2);
+    if (isFloat and not Types.isFloatTy(t1)) {
+      operand temp = codeCounters.newTEMPoperand();
+      code = std::move(code) || instruction::FLOAT(temp, addr1);
+      addr1 = temp;
+    }
+    if (isFloat and not Types.isFloatTy(t2)) {
+      operand temp = codeCounters.newTEMPoperand();
+      code = std::move(code) || instruction::FLOAT(temp, addr2);
+      addr2 = temp;
+    }
+    // a > b is b < a, a >= b is b <= a, and a != b is not (a == b)
+    if (relational->GT() or relational->GEQ()) std::swap(addr1, addr2);
+    int cmp = (relational->EQUAL() or relational->NEQUAL()) ? 0 :
+              (relational->LT() or relational->GT()) ? 1 : 2;
+    bool onTrue = jumpIf != (relational->NEQUAL() != nullptr);
+    instruction::Operation op =
+      instruction::Operation(instruction::_JEQ + (isFloat ? 6 : 0) + (onTrue ? 0 : 3) + cmp);
+    return std::move(code) || instruction(op, addr1, addr2, label);
+  }
+  CodeAttribs     && codAt = visit(ctx);
+  instructionList &   code = codAt.code;
+  operand             addr = codAt.addr;
+  if (jumpIf) {
+    operand temp = codeCounters.newTEMPoperand();
+    return std::move(code) || instruction::NOT(temp, addr) || instruction::FJUMP(temp, label);
+  }
+  return std::move(code) || instruction::FJUMP(addr, label);
+}
+
 antlrcpp::Any CodeGenVisitor::visitValue(AslParser::ValueContext *ctx) {
   DEBUG_ENTER();
   instructionList code;
   //TypesMgr::TypeId  t = getTypeDecor(ctx);
-  std::string temp = "%"+codeCounters.newTEMP();
-  if(ctx->FLOATVAL()) code = instruction::FLOAD(temp, ctx->getText());
-  else if(ctx->CHARVAL()) code = instruction::LOAD(temp, ctx->getText());
-  else if(ctx->INTVAL()) code = instruction::ILOAD(temp, ctx->getText());
+  operand temp = codeCounters.newTEMPoperand();
+  if(ctx->FLOATVAL()) code = instruction::FLOAD(temp, nameOperand(ctx->getText()));
+  else if(ctx->CHARVAL()) code = instruction::LOAD(temp, nameOperand(ctx->getText()));
+  else if(ctx->INTVAL()) code = instruction::ILOAD(temp, nameOperand(ctx->getText()));
   else if(ctx->TRUE()) code = instruction::ILOAD(temp, "1");
   else code = instruction::ILOAD(temp, "0");
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -579,30 +638,30 @@ antlrcpp::Any CodeGenVisitor::visitExprFunc(AslParser::ExprFuncContext *ctx) {
         TypesMgr::TypeId tidp = getTypeDecor(ctx->list_expr()->expr(i));
         CodeAttribs     && codAt = visit(ctx->list_expr()->expr(i));
         instructionList &   exprCode = codAt.code;
-        std::string         addr = codAt.addr;  
-        code = code || exprCode;
+        operand             addr = codAt.addr;  
+        code = std::move(code) || exprCode;
 //         if (Types.isFloatTy(params[i]) && Types.isIntegerTy(tidp) && not Types.isArrayTy(params[i])) {
         if (Types.isFloatTy(params[i]) && Types.isIntegerTy(tidp)) {
-            std::string temp = "%"+codeCounters.newTEMP();
-            code = code || instruction::FLOAT(temp,addr) || instruction::PUSH(temp);
+            operand temp = codeCounters.newTEMPoperand();
+            code = std::move(code) || instruction::FLOAT(temp,addr) || instruction::PUSH(temp);
         } else if (Types.isArrayTy(params[i])) {
             std::string name = ctx->list_expr()->expr(i)->getText();
             bool isParam = Symbols.isParameterClass(name);
-            std::string temp = "%"+codeCounters.newTEMP();
+            operand temp = codeCounters.newTEMPoperand();
             if (isParam) {
-                code = code || instruction::LOAD(temp, addr);
-            } else code = code || instruction::ALOAD(temp, addr);
-            code = code || instruction::PUSH(temp);
-        } else code = code || instruction::PUSH(addr);
+                code = std::move(code) || instruction::LOAD(temp, addr);
+            } else code = std::move(code) || instruction::ALOAD(temp, addr);
+            code = std::move(code) || instruction::PUSH(temp);
+        } else code = std::move(code) || instruction::PUSH(addr);
     }
-    code = code || instruction::CALL(ctx->ident()->getText());
-    for (unsigned int i = 0;i < ctx->list_expr()->expr().size(); i++) code = code || instruction::POP("");
+    code = std::move(code) || instruction::CALL(nameOperand(ctx->ident()->getText()));
+    for (unsigned int i = 0;i < ctx->list_expr()->expr().size(); i++) code = std::move(code) || instruction::POP("");
   } else {
-      code = code || instruction::CALL(ctx->ident()->getText());
+      code = std::move(code) || instruction::CALL(nameOperand(ctx->ident()->getText()));
   }
-  std::string temp = "%"+codeCounters.newTEMP();
-  code = code || instruction::POP(temp);
-  CodeAttribs codAts(temp, "", code);
+  operand temp = codeCounters.newTEMPoperand();
+  code = std::move(code) || instruction::POP(temp);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -618,9 +677,9 @@ antlrcpp::Any CodeGenVisitor::visitParens(AslParser::ParensContext *ctx) {
   DEBUG_ENTER();
   CodeAttribs     && codAt = visit(ctx->expr());
   instructionList &   code = codAt.code;
-  std::string         addr = codAt.addr;
+  operand             addr = codAt.addr;
 //   std::string temp = "%"+codeCounters.newTEMP();
-  CodeAttribs codAts(addr, "", code);
+  CodeAttribs codAts(addr, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -629,15 +688,16 @@ antlrcpp::Any CodeGenVisitor::visitIdent(AslParser::IdentContext *ctx) {
   DEBUG_ENTER();
   instructionList code;
   TypesMgr::TypeId tid = getTypeDecor(ctx);
-  std::string name = ctx->ID()->getText();
-  bool isParam = Symbols.isParameterClass(name);
+  std::string ident = ctx->ID()->getText();
+  bool isParam = Symbols.isParameterClass(ident);
+  operand name = nameOperand(ident);
   
   if (isParam && Types.isArrayTy(tid)) {
-      std::string temp = "%"+codeCounters.newTEMP();
+      operand temp = codeCounters.newTEMPoperand();
       code = instruction::LOAD(temp, name);
       name = temp;
   } else code = instructionList();
-  CodeAttribs codAts(name, "", code);
+  CodeAttribs codAts(name, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
@@ -645,24 +705,30 @@ antlrcpp::Any CodeGenVisitor::visitIdent(AslParser::IdentContext *ctx) {
 
 // Getters for the necessary tree node atributes:
 //   Scope and Type
-SymTable::ScopeId CodeGenVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) const {
+SymTable::ScopeId CodeGenVisitor::getScopeDecor(DecoratedContext *ctx) const {
   return Decorations.getScope(ctx);
 }
-TypesMgr::TypeId CodeGenVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) const {
+TypesMgr::TypeId CodeGenVisitor::getTypeDecor(DecoratedContext *ctx) const {
   return Decorations.getType(ctx);
 }
 
+// Operand for a name used in the current function (interned in
+// the name table of its subroutine)
+operand CodeGenVisitor::nameOperand(const std::string & name) const {
+  return operand(name, *currNames);
+}
+
 
 // Constructors of the class CodeAttribs:
 //
-CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
-                                         const std::string & offs,
+CodeGenVisitor::CodeAttribs::CodeAttribs(const operand & addr,
+                                         const operand & offs,
                                          instructionList & code) :
   addr{addr}, offs{offs}, code{code} {
 }
 
-CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
-                                         const std::string & offs,
+CodeGenVisitor::CodeAttribs::CodeAttribs(const operand & addr,
+                                         const operand & offs,
                                          instructionList && code) :
-  addr{addr}, offs{offs}, code{code} {
+  addr{addr}, offs{offs}, code{std::move(code)} {
 }
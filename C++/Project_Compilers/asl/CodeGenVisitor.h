@@ -38,6 +38,7 @@
 #include "../common/code.h"
 
 #include <string>
+#include <vector>
 
 // using namespace std;
 
@@ -60,7 +61,12 @@ public:
   // Constructor
   CodeGenVisitor(TypesMgr       & Types,
                  SymTable       & Symbols,
-                 TreeDecoration & Decorations);
+                 TreeDecoration & Decorations,
+                 counters       & Counters);
+
+  // Visit only the functions of the program whose position in it is
+  // true in 'selected' (by default, all of them are visited)
+  void selectFunctions(const std::vector<bool> & selected);
 
   // Methods to visit each kind of node:
   antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
@@ -97,9 +103,13 @@ private:
   TypesMgr        & Types;
   SymTable        & Symbols;
   TreeDecoration  & Decorations;
-  counters          codeCounters;
+  counters        & codeCounters;
   // Current function type (assigned before visit its instructions)
   TypesMgr::TypeId currFunctionType;
+  // Names table of the subroutine being generated
+  nameTable       * currNames;
+  // Functions to visit (all of them, if empty)
+  std::vector<bool> selectedFunctions;
 
   // Accessor/Mutator to the type (TypeId) of the current function
   TypesMgr::TypeId getCurrentFunctionTy ()                      const;
@@ -107,8 +117,14 @@ private:
 
   // Getters for the necessary tree node atributes:
   //   Scope and Type
-  SymTable::ScopeId getScopeDecor (antlr4::ParserRuleContext *ctx) const;
-  TypesMgr::TypeId  getTypeDecor  (antlr4::ParserRuleContext *ctx) const;
+  SymTable::ScopeId getScopeDecor (DecoratedContext *ctx) const;
+  TypesMgr::TypeId  getTypeDecor  (DecoratedContext *ctx) const;
+
+  // Operand for a name of the current function
+  operand nameOperand(const std::string & name) const;
+
+  // Code for a condition: jump to label when its value is jumpIf
+  instructionList codeCondJump(AslParser::ExprContext *ctx, const operand & label, bool jumpIf);
 
 
   //////////////////////////////////////////////////////////////////
@@ -122,18 +138,18 @@ private:
     
   public:
     // Constructors
-    CodeAttribs(const std::string & addr,
-                const std::string & offs,
+    CodeAttribs(const operand & addr,
+                const operand & offs,
                 instructionList & code);
-    CodeAttribs(const std::string & addr,
-                const std::string & offs,
+    CodeAttribs(const operand & addr,
+                const operand & offs,
                 instructionList && code);
 
     // Attributes (publics):
     //   - the address that will hold the value of an expression
-    std::string addr;
+    operand addr;
     //   - the offset applied to the address (for array access)
-    std::string offs;
+    operand offs;
     //   - the three-address code associated to an statement/expression
     instructionList code;
 
@@ -0,0 +1,349 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    Compilation - State and steps of the compilation of
+//                  one ASL program
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "Compilation.h"
+
+#include "antlr4-runtime.h"
+#include "AslLexer.h"
+#include "AslScanner.h"
+#include "AslParser.h"
+#include "MappedCharStream.h"
+
+#include "SymbolsVisitor.h"
+#include "TypeCheckVisitor.h"
+#include "CodeGenVisitor.h"
+#include "CompileCache.h"
+#include "../common/Optimizer.h"
+
+#include <string>
+#include <sstream>
+#include <iterator>   // istreambuf_iterator
+#include <vector>
+#include <unordered_set>
+#include <memory>
+#include <exception>
+#include <utility>    // std::move
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint64_t
+
+// using namespace std;
+
+
+namespace {
+
+  // writes the lexical and syntactical errors as antlr4's console
+  // listener does, but to the stream of the compilation
+  class StreamErrorListener : public antlr4::BaseErrorListener {
+  public:
+    StreamErrorListener(std::ostream & err) : Err(err) {}
+    void syntaxError(antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol,
+                     size_t line, size_t charPositionInLine,
+                     const std::string &msg, std::exception_ptr e) override {
+      Err << "line " << line << ":" << charPositionInLine << " " << msg << std::endl;
+    }
+  private:
+    std::ostream & Err;
+  };
+
+  // the key of the code of a function in the cache: its tokens (type and
+  // text, so that comments and blanks do not matter) and the name and
+  // type of each function it names (the rest of its code depends on its
+  // own declarations only). Needs the global scope in the stack
+  CompileCache::Key functionKey(AslParser::FunctionContext *ctx, const CompileCache & cache,
+                                const SymTable & Symbols, const TypesMgr & Types) {
+    CompileCache::Key key = cache.newKey();
+    std::vector<std::string> idents;
+    std::unordered_set<std::string> seen;
+    std::vector<antlr4::tree::ParseTree *> pending(1, ctx);
+    while (not pending.empty()) {
+      antlr4::tree::ParseTree *node = pending.back();
+      pending.pop_back();
+      if (auto terminal = dynamic_cast<antlr4::tree::TerminalNode *>(node)) {
+        antlr4::Token *token = terminal->getSymbol();
+        key.add(std::uint64_t(token->getType()));
+        key.add(token->getText());
+        if (token->getType() == AslParser::ID and seen.insert(token->getText()).second)
+          idents.push_back(token->getText());
+      }
+      pending.insert(pending.end(), node->children.rbegin(), node->children.rend());
+    }
+    for (const std::string & ident : idents) {
+      SymTable::IdentId id = Symbols.findIdent(ident);
+      if (id != SymTable::NO_IDENT and Symbols.findInCurrentScope(id) and
+          Symbols.isFunctionClass(id)) {
+        key.add(ident);
+        key.add(Types.to_string(Symbols.getType(id)));
+      }
+    }
+    return key;
+  }
+
+}
+
+
+// Constructor and destructor of Frontend (a lexer and a parser with
+// no input yet, which each compilation gives them)
+Frontend::Frontend() :
+  Input{new MappedCharStream()},
+  Lexer{new AslLexer(Input.get())},
+  Scanner{new AslScanner()},
+  Parser{new AslParser(nullptr)},
+  TwoStage{true},
+  HandWritten{false} {
+}
+
+Frontend::~Frontend() {
+}
+
+void Frontend::setTwoStageParsing(bool twoStage) {
+  TwoStage = twoStage;
+}
+
+void Frontend::setHandWrittenLexer(bool handWritten) {
+  HandWritten = handWritten;
+}
+
+
+// Constructor
+Compilation::Compilation(std::ostream & out, std::ostream & err) :
+  Out{out},
+  Err{err},
+  Symbols{Types},
+  Errors{out},
+  Cache{nullptr} {
+}
+
+void Compilation::setCache(CompileCache * cache) {
+  Cache = cache;
+}
+
+bool Compilation::compile(std::istream & source, bool optimize, std::ostream * stats,
+                          bool forLLVM) {
+  Frontend frontend;
+  return compile(source, frontend, optimize, stats, forLLVM);
+}
+
+bool Compilation::compile(std::istream & source, Frontend & frontend, bool optimize,
+                          std::ostream * stats, bool forLLVM) {
+  // read the program to the buffer of the frontend, where it is lexed
+  frontend.Buffer.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+  frontend.Input->load(frontend.Buffer.data(), frontend.Buffer.size());
+  return compileInput(frontend, optimize, stats, forLLVM);
+}
+
+bool Compilation::compileFile(const std::string & fileName, Frontend & frontend, bool optimize,
+                              std::ostream * stats, bool forLLVM) {
+  frontend.Buffer.clear();
+  if (not frontend.Input->open(fileName)) {
+    Out << "No such file: " << fileName << std::endl;
+    return false;
+  }
+  bool ok = compileInput(frontend, optimize, stats, forLLVM);
+  frontend.Input->close();
+  return ok;
+}
+
+bool Compilation::compileInput(Frontend & frontend, bool optimize, std::ostream * stats,
+                               bool forLLVM) {
+  // the names of the operands go to the table of their subroutine: the
+  // code generator and the optimizer open a scope for each one
+  nameTable::Scope namesRequired;
+
+  // the lexer consumes the character stream of the frontend and produces
+  // a token stream, which its parser consumes (setting the streams again
+  // resets the lexer and the parser)
+  MappedCharStream & input = *frontend.Input;
+  AslLexer & lexer = *frontend.Lexer;
+  AslScanner & scanner = *frontend.Scanner;
+  AslParser & parser = *frontend.Parser;
+  antlr4::TokenSource * tokenSource = &lexer;
+  if (frontend.HandWritten) tokenSource = &scanner;
+  auto interpreter = parser.getInterpreter<antlr4::atn::ParserATNSimulator>();
+  StreamErrorListener errorListener(Err);
+  antlr4::tree::ParseTree *tree = nullptr;
+
+  // (re)start the lexer in use from the beginning of the program
+  auto startLexer = [&](antlr4::ANTLRErrorListener * listener) {
+    if (frontend.HandWritten) {
+      scanner.setInput(input.data(), input.bytes(), &input);
+      scanner.removeErrorListeners();
+      scanner.addErrorListener(listener);
+    }
+    else {
+      lexer.setInputStream(&input);
+      lexer.removeErrorListeners();
+      lexer.addErrorListener(listener);
+    }
+  };
+
+  // first stage: SLL prediction and no error recovery. The messages of
+  // the lexer are kept until we know that there is no second stage
+  antlr4::CommonTokenStream tokens(tokenSource);
+  if (frontend.TwoStage) {
+    std::ostringstream lexerMessages;
+    StreamErrorListener lexerListener(lexerMessages);
+    startLexer(&lexerListener);
+    parser.setTokenStream(&tokens);
+    parser.removeErrorListeners();
+    parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+    interpreter->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    try {
+      tree = parser.program();
+      Err << lexerMessages.str();
+    }
+    catch (antlr4::ParseCancellationException &) {
+      tree = nullptr;
+    }
+    lexer.removeErrorListeners();
+    scanner.removeErrorListeners();
+  }
+
+  // second stage (or the only one): lex and parse again from the start
+  // with full LL prediction, error recovery and messages
+  antlr4::CommonTokenStream retryTokens(tokenSource);
+  if (tree == nullptr) {
+    startLexer(&errorListener);
+    parser.setTokenStream(&retryTokens);
+    parser.removeErrorListeners();
+    parser.addErrorListener(&errorListener);
+    parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+    interpreter->setPredictionMode(antlr4::atn::PredictionMode::LL);
+    tree = parser.program();
+    lexer.removeErrorListeners();
+    scanner.removeErrorListeners();
+    parser.removeErrorListeners();
+  }
+
+  // check for lexical or syntactical errors
+  std::size_t lexicalErrors = frontend.HandWritten ? scanner.getNumberOfSyntaxErrors()
+                                                   : lexer.getNumberOfSyntaxErrors();
+  if (lexicalErrors > 0 or parser.getNumberOfSyntaxErrors() > 0) {
+    Out << "Lexical and/or syntactical errors have been found." << std::endl;
+    return false;
+  }
+
+  // number the nodes of the tree, so that their attributes are kept
+  // in vectors indexed by that number
+  Decorations.setTree(tree);
+
+  // create a visitor that looks for variables and function declarations
+  // in the tree and stores required information
+  SymbolsVisitor symboldecl(Types, Symbols, Decorations, Errors);
+  symboldecl.visit(tree);
+
+  // with a cache (and no errors in the declarations), the functions
+  // whose code is found in it are neither type checked nor generated:
+  // they compiled with no errors before, exactly as they are now
+  auto program = static_cast<AslParser::ProgramContext *>(tree);
+  std::vector<AslParser::FunctionContext *> functions = program->function();
+  std::vector<CompileCache::Key> keys;
+  std::vector<subroutine> cached;
+  std::vector<std::string> fragments;
+  std::vector<bool> compiled;
+  bool useCache = Cache != nullptr and Errors.getNumberOfSemanticErrors() == 0;
+  if (useCache) {
+    Symbols.pushThisScope(Decorations.getScope(program));
+    for (auto ctxFunc : functions) {
+      keys.push_back(functionKey(ctxFunc, *Cache, Symbols, Types));
+      cached.push_back(subroutine(ctxFunc->ID()->getText()));
+      fragments.push_back(std::string());
+      compiled.push_back(not Cache->load(keys.back(), cached.back(), fragments.back()));
+    }
+    Symbols.popScope();
+  }
+
+  // create another visitor that will perform type checkings wherever
+  // it is needed (on expressions, assignments, parameter passing, etc)
+  TypeCheckVisitor typecheck(Types, Symbols, Decorations, Errors);
+  typecheck.selectFunctions(compiled);
+  typecheck.visit(tree);
+
+  if (Errors.getNumberOfSemanticErrors() > 0) {
+    Out << "There are semantic errors: no code generated." << std::endl;
+    return false;
+  }
+
+  // create a third visitor that will return the generated code
+  // for each part of the tree
+  CodeGenVisitor codegenerator(Types, Symbols, Decorations, Counters);
+  codegenerator.selectFunctions(compiled);
+  Code = codegenerator.visit(tree);
+
+  // the generated functions go to the cache, and the code of the program
+  // has all of them, in the order of the program
+  if (useCache) {
+    code program;
+    const std::vector<subroutine> & subroutines = Code.get_subroutine_list();
+    for (std::size_t i = 0, next = 0; i < functions.size(); ++i) {
+      if (compiled[i]) {
+        Cache->store(keys[i], subroutines[next]);
+        program.add_subroutine(subroutines[next++]);
+      }
+      else program.add_subroutine(cached[i]);
+    }
+    Code = std::move(program);
+    if (not optimize) {
+      Keys = std::move(keys);
+      Fragments = std::move(fragments);
+    }
+  }
+
+  // optimize the generated code
+  if (optimize) {
+    Optimizer optimizer(forLLVM);
+    optimizer.optimize(Code);
+    if (stats) optimizer.print_stats(*stats);
+  }
+  return true;
+}
+
+std::string Compilation::dumpLLVM() {
+  if (Keys.empty()) return Code.dumpLLVM(Types, Symbols);
+  std::vector<std::string> fragments = Fragments;
+  std::string llvm = Code.dumpLLVM(Types, Symbols, fragments);
+  const std::vector<subroutine> & subroutines = Code.get_subroutine_list();
+  for (std::size_t i = 0; i < Keys.size(); ++i) {
+    if (not Fragments[i].empty()) Cache->reuseLLVM();
+    else Cache->store(Keys[i], subroutines[i], fragments[i]);
+  }
+  Fragments = std::move(fragments);
+  return llvm;
+}
+
+const code & Compilation::getCode() const {
+  return Code;
+}
+
+const TypesMgr & Compilation::getTypes() const {
+  return Types;
+}
+
+const SymTable & Compilation::getSymbols() const {
+  return Symbols;
+}
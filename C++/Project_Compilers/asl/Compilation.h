@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    Compilation - State and steps of the compilation of
+//                  one ASL program
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../common/TypesMgr.h"
+#include "../common/SymTable.h"
+#include "../common/TreeDecoration.h"
+#include "../common/SemErrors.h"
+#include "../common/code.h"
+#include "CompileCache.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+// using namespace std;
+
+class AslLexer;
+class AslParser;
+class AslScanner;
+class MappedCharStream;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class Frontend: a lexer and a parser (with their character stream)
+// that several compilations can use, one after the other, instead of
+// building new ones for each program. A thread that compiles many
+// programs keeps one of these.
+// By default programs are parsed in two stages: first with the faster
+// SLL prediction, giving up at the first syntax error, and only if that
+// fails, again with full LL prediction (which reports the errors).
+// The tokens come from AslLexer or, if selected, from AslScanner (a
+// faster lexer written by hand, with the same tokens). Both of them read
+// the program in place: mapped in memory, if it is in a file, or in a
+// buffer of the frontend, if it is read from a stream.
+
+class Frontend {
+
+public:
+
+  // Constructor and destructor
+  Frontend();
+  ~Frontend();
+
+  // Parse in two stages (the default) or with full LL prediction only
+  void setTwoStageParsing(bool twoStage);
+
+  // Read the tokens from AslScanner instead of AslLexer (the default)
+  void setHandWrittenLexer(bool handWritten);
+
+private:
+
+  friend class Compilation;
+
+  std::unique_ptr<MappedCharStream>         Input;
+  std::string                               Buffer;
+  std::unique_ptr<AslLexer>                 Lexer;
+  std::unique_ptr<AslScanner>               Scanner;
+  std::unique_ptr<AslParser>                Parser;
+  bool                                      TwoStage;
+  bool                                      HandWritten;
+
+};  // class Frontend
+
+
+//////////////////////////////////////////////////////////////////////
+// Class Compilation: everything the compilation of one program needs
+// (types, symbols, tree decorations, semantic errors, label and temporal
+// counters) and the code it produces. Nothing is shared between two
+// objects of this class, so several programs can be compiled at the
+// same time in different threads, each one with its own Compilation.
+
+class Compilation {
+
+public:
+
+  // Constructor: the messages of the compilation (semantic errors and
+  // the final diagnostic) are written to 'out', and those of the lexer
+  // and the parser to 'err'
+  Compilation(std::ostream & out, std::ostream & err);
+
+  // Compile the program read from 'source', optimizing the generated
+  // code if required (with the optimizer statistics written to 'stats',
+  // if not null). With 'forLLVM' the optimized code keeps the single
+  // type per temporary that LLVM code generation needs. Returns false
+  // if the program has errors
+  bool compile(std::istream & source, bool optimize, std::ostream * stats = nullptr,
+               bool forLLVM = false);
+  // The same, with the lexer and the parser of 'frontend'
+  bool compile(std::istream & source, Frontend & frontend, bool optimize,
+               std::ostream * stats = nullptr, bool forLLVM = false);
+  // The same, for the program in the file <fileName>, which is mapped
+  // in memory and lexed in place (it is not copied). If the file cannot
+  // be read, says so in 'out' and returns false
+  bool compileFile(const std::string & fileName, Frontend & frontend, bool optimize,
+                   std::ostream * stats = nullptr, bool forLLVM = false);
+
+  // Reuse the code of the functions found in 'cache' (and add to it
+  // that of the others): only the functions not found are type checked
+  // and generated. The cache may be shared by several compilations
+  void setCache(CompileCache * cache);
+
+  // The LLVM code of the generated code. With a cache (and without
+  // optimizing, as the optimizer changes the code of a function with
+  // that of others) the LLVM code of each function is reused from the
+  // cache, or added to it
+  std::string dumpLLVM();
+
+  // Accessors to the results of the compilation
+  const code     & getCode() const;
+  const TypesMgr & getTypes() const;
+  const SymTable & getSymbols() const;
+
+private:
+
+  // Compile the program in the input stream of 'frontend'
+  bool compileInput(Frontend & frontend, bool optimize, std::ostream * stats, bool forLLVM);
+
+  // Streams for the messages
+  std::ostream & Out;
+  std::ostream & Err;
+
+  // Per-compilation state (used by the visitors)
+  TypesMgr       Types;
+  SymTable       Symbols;
+  TreeDecoration Decorations;
+  SemErrors      Errors;
+  counters       Counters;
+
+  // The code of the functions compiled before (null if not used), and
+  // the keys and the LLVM code (empty if not known) of the functions of
+  // the generated code, if it can be kept in the cache
+  CompileCache * Cache;
+  std::vector<CompileCache::Key> Keys;
+  std::vector<std::string>       Fragments;
+
+  // The generated code
+  code           Code;
+
+};  // class Compilation
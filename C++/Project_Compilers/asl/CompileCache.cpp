@@ -0,0 +1,281 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileCache - On-disk cache of the code generated for
+//                   each function of ASL programs
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "CompileCache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>       // std::rename, std::remove
+
+#include <sys/stat.h>   // mkdir, stat
+#include <unistd.h>     // getpid
+
+// using namespace std;
+
+
+namespace {
+
+  // first line of the entries: a new format gives new keys too
+  const std::string ENTRY_HEADER = "aslcache 2";
+
+  // FNV-1a parameters
+  const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  const std::uint64_t FNV_PRIME  = 1099511628211ULL;
+
+  std::uint64_t fnv1a(const char *bytes, std::size_t size, std::uint64_t hash) {
+    for (std::size_t i = 0; i < size; ++i)
+      hash = (hash ^ (unsigned char)(bytes[i])) * FNV_PRIME;
+    return hash;
+  }
+
+  // texts are written with their length, as they may have blanks
+  void writeText(std::ostream & out, const std::string & text) {
+    out << text.size() << ' ' << text << '\n';
+  }
+
+  bool readText(std::istream & in, std::string & text) {
+    std::size_t size;
+    if (not (in >> size) or in.get() != ' ') return false;
+    text.resize(size);
+    return size == 0 or in.read(&text[0], size);
+  }
+
+  // operands are written as their kind, followed by their number or
+  // their text (if they have one)
+  void writeOperand(std::ostream & out, const operand & op) {
+    out << op.kind() << ' ';
+    if (op.isTemp() or op.isInt()) out << op.number() << '\n';
+    else if (op.isSymbol() or op.isLiteral()) writeText(out, op.str());
+    else out << '\n';
+  }
+
+  // the names of the operand are interned in the table of 'subr'
+  bool readOperand(std::istream & in, subroutine & subr, operand & op) {
+    int kind, number;
+    std::string text;
+    if (not (in >> kind)) return false;
+    switch (kind) {
+    case operand::_NONE:
+      op = operand();
+      return true;
+    case operand::_TEMP:
+      if (not (in >> number)) return false;
+      op = operand::temp(number);
+      return true;
+    case operand::_INT:
+      if (not (in >> number)) return false;
+      op = operand::integer(number);
+      return true;
+    case operand::_SYMBOL:
+    case operand::_LITERAL:
+      if (not readText(in, text)) return false;
+      op = operand(text, subr.get_names());
+      return op.kind() == kind and op.str() == text;
+    default:
+      return false;
+    }
+  }
+
+}
+
+
+// Key: the bytes added
+CompileCache::Key::Key(const std::string & seed) : Text{seed} {
+}
+
+void CompileCache::Key::add(const std::string & text) {
+  add(std::uint64_t(text.size()));
+  Text += text;
+}
+
+void CompileCache::Key::add(std::uint64_t number) {
+  for (int i = 0; i < 8; ++i) Text += char(number >> (8 * i));
+}
+
+const std::string & CompileCache::Key::text() const {
+  return Text;
+}
+
+std::uint64_t CompileCache::Key::value() const {
+  return fnv1a(Text.data(), Text.size(), FNV_OFFSET);
+}
+
+
+// Constructor
+CompileCache::CompileCache(const std::string & directory) :
+  Directory{directory},
+  Hits{0},
+  Misses{0},
+  Stores{0},
+  LLVMHits{0},
+  TempFiles{0} {
+}
+
+bool CompileCache::open() {
+  mkdir(Directory.c_str(), 0777);
+  struct stat info;
+  if (stat(Directory.c_str(), &info) != 0 or not S_ISDIR(info.st_mode)) return false;
+
+  // the code of a function depends on the compiler that generates it:
+  // all the keys start with the size and the hash of its binary (or,
+  // where it cannot be read, the time it was built)
+  Key seed("");
+  seed.add(ENTRY_HEADER);
+  std::ifstream binary("/proc/self/exe", std::ios::binary);
+  if (binary) {
+    char buffer[1 << 16];
+    std::uint64_t size = 0, hash = FNV_OFFSET;
+    while (binary.read(buffer, sizeof(buffer)) or binary.gcount() > 0) {
+      size += binary.gcount();
+      hash = fnv1a(buffer, binary.gcount(), hash);
+    }
+    seed.add(size);
+    seed.add(hash);
+  }
+  else seed.add(std::string(__DATE__ " " __TIME__));
+  Seed = seed.text();
+  return true;
+}
+
+CompileCache::Key CompileCache::newKey() const {
+  return Key(Seed);
+}
+
+std::string CompileCache::entryFileName(std::uint64_t key) const {
+  std::ostringstream name;
+  name << Directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".t";
+  return name.str();
+}
+
+bool CompileCache::load(const Key & key, subroutine & subr, std::string & llvm) {
+  // an entry that cannot be read (or is not complete, or is the one of
+  // another key with the same hash) is a miss, and it is written again
+  // after the function is compiled
+  std::ifstream in(entryFileName(key.value()), std::ios::binary);
+  std::string header, text, name;
+  std::size_t count;
+  bool ok = in and std::getline(in, header) and header == ENTRY_HEADER and
+            readText(in, text) and text == key.text() and
+            readText(in, name) and name == subr.get_name();
+
+  // parameters and local variables: name and size
+  for (int list = 0; ok and list < 2; ++list) {
+    std::list<var> & vars = list == 0 ? subr.params : subr.vars;
+    ok = bool(in >> count);
+    for (std::size_t i = 0; ok and i < count; ++i) {
+      std::size_t size;
+      ok = readText(in, name) and (in >> size);
+      if (ok) vars.push_back(var(name, size));
+    }
+  }
+
+  // instructions: operation and three operands
+  instructionList instructions;
+  ok = ok and (in >> count);
+  for (std::size_t i = 0; ok and i < count; ++i) {
+    int oper;
+    operand arg1, arg2, arg3;
+    ok = (in >> oper) and oper >= 0 and oper < instruction::_INVALID and
+         readOperand(in, subr, arg1) and readOperand(in, subr, arg2) and
+         readOperand(in, subr, arg3);
+    if (ok) instructions.push_back(instruction(instruction::Operation(oper), arg1, arg2, arg3));
+  }
+
+  // and the LLVM code (empty if not generated yet)
+  ok = ok and readText(in, llvm);
+
+  if (not ok) {
+    subr = subroutine(subr.get_name());
+    llvm.clear();
+    ++Misses;
+    return false;
+  }
+  subr.set_instructions(std::move(instructions));
+  ++Hits;
+  return true;
+}
+
+void CompileCache::store(const Key & key, const subroutine & subr, const std::string & llvm) {
+  std::ostringstream tempName;
+  tempName << Directory << "/.tmp." << getpid() << "." << TempFiles++;
+  std::ofstream out(tempName.str(), std::ios::binary);
+  out << ENTRY_HEADER << '\n';
+  writeText(out, key.text());
+  writeText(out, subr.get_name());
+  for (const std::list<var> * vars : {&subr.params, &subr.vars}) {
+    out << vars->size() << '\n';
+    for (const var & v : *vars) {
+      writeText(out, v.name);
+      out << v.size << '\n';
+    }
+  }
+  const instructionList & instructions = subr.get_instructions();
+  out << instructions.size() << '\n';
+  for (const instruction & inst : instructions) {
+    out << inst.oper << '\n';
+    writeOperand(out, inst.arg1);
+    writeOperand(out, inst.arg2);
+    writeOperand(out, inst.arg3);
+  }
+  writeText(out, llvm);
+  out.close();
+
+  // the entry appears complete or not at all, even to other processes
+  if (out and std::rename(tempName.str().c_str(), entryFileName(key.value()).c_str()) == 0)
+    ++Stores;
+  else std::remove(tempName.str().c_str());
+}
+
+std::size_t CompileCache::getHits() const {
+  return Hits;
+}
+
+std::size_t CompileCache::getMisses() const {
+  return Misses;
+}
+
+std::size_t CompileCache::getStores() const {
+  return Stores;
+}
+
+void CompileCache::reuseLLVM() {
+  ++LLVMHits;
+}
+
+std::size_t CompileCache::getLLVMHits() const {
+  return LLVMHits;
+}
+
+void CompileCache::printStatistics(std::ostream & out) const {
+  std::size_t hits = Hits, misses = Misses;
+  out << "cache " << Directory << ": " << hits + misses << " functions, "
+      << hits << " hits, " << misses << " misses, " << Stores << " stored, "
+      << LLVMHits << " LLVM reused" << std::endl;
+}
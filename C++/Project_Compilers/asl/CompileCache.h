@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileCache - On-disk cache of the code generated for
+//                   each function of ASL programs
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../common/code.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CompileCache: the code generated for the functions of the
+// programs compiled, kept on disk (in a directory, one file per
+// function) to reuse it when the same function is compiled again.
+// An entry is found by a key: everything its code depends on (the
+// tokens of the function, the types of the functions it calls and the
+// compiler itself), so that any change gives a different key and there
+// is no need to invalidate entries. The file of an entry is named by a
+// hash of its key, and keeps the whole key, which must be the same to
+// use it. The code kept is the one of the code generator, before the
+// optimizer, which works on the whole program, and its LLVM code (once
+// it has been generated). Several compilations (in different threads
+// or processes) can use the same directory at the same time: entries
+// are written to a temporal file and then renamed.
+
+class CompileCache {
+
+public:
+
+  // Key of an entry, built by adding to it the pieces of what the code
+  // depends on
+  class Key {
+  public:
+    Key(const std::string & seed);
+    // Add a text (with its length, so that consecutive pieces cannot
+    // be confused) or a number
+    void add(const std::string & text);
+    void add(std::uint64_t number);
+    // All the pieces added, and their 64-bit FNV-1a hash
+    const std::string & text() const;
+    std::uint64_t value() const;
+  private:
+    std::string Text;
+  };
+
+  // Constructor: the entries are files in <directory>
+  CompileCache(const std::string & directory);
+
+  // Create the directory (if it does not exist) and hash the compiler
+  // binary. Returns false if the directory cannot be used
+  bool open();
+
+  // A new key, which already includes the compiler binary
+  Key newKey() const;
+
+  // Look for the entry of 'key': if found, its code is read into
+  // 'subr' (which must be an empty subroutine with the name of the
+  // function), its LLVM code into 'llvm' (empty if it has none yet),
+  // and returns true. Counted as a hit or a miss
+  bool load(const Key & key, subroutine & subr, std::string & llvm);
+
+  // Write the code of 'subr' (and its LLVM code, if not empty) as the
+  // entry of 'key'
+  void store(const Key & key, const subroutine & subr, const std::string & llvm = "");
+
+  // Count the LLVM code of a function taken from its entry
+  void reuseLLVM();
+
+  // Statistics: functions found, not found and written, and LLVM code
+  // of functions reused
+  std::size_t getHits() const;
+  std::size_t getMisses() const;
+  std::size_t getStores() const;
+  std::size_t getLLVMHits() const;
+  void printStatistics(std::ostream & out) const;
+
+private:
+
+  // Name of the file of the entry of 'key'
+  std::string entryFileName(std::uint64_t key) const;
+
+  std::string              Directory;
+  std::string              Seed;
+  std::atomic<std::size_t> Hits;
+  std::atomic<std::size_t> Misses;
+  std::atomic<std::size_t> Stores;
+  std::atomic<std::size_t> LLVMHits;
+  std::atomic<std::size_t> TempFiles;
+
+};  // class CompileCache
@@ -0,0 +1,216 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    MappedCharStream - Character stream that reads an ASL program
+//                       in place, from a file mapped in memory
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "MappedCharStream.h"
+
+#include "antlr4-runtime.h"
+
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// using namespace std;
+
+
+namespace {
+
+  bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+  }
+
+}
+
+
+// Constructor and destructor
+MappedCharStream::MappedCharStream() :
+  Data{nullptr},
+  Bytes{0},
+  Size{0},
+  Mapping{nullptr},
+  Index{0},
+  Offset{0} {
+}
+
+MappedCharStream::~MappedCharStream() {
+  close();
+}
+
+bool MappedCharStream::open(const std::string & fileName) {
+  close();
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &st) == 0 and S_ISREG(st.st_mode) and st.st_size > 0)
+    p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p != MAP_FAILED) {
+    // the lexer goes through the text from the start to the end
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    Mapping = p;
+    setText(static_cast<const char *>(p), st.st_size);
+  }
+  else {
+    std::ifstream stream(fileName, std::ios::binary);
+    if (not stream) return false;
+    std::ostringstream contents;
+    contents << stream.rdbuf();
+    Copy = contents.str();
+    setText(Copy.data(), Copy.size());
+  }
+  Name = fileName;
+  return true;
+}
+
+void MappedCharStream::load(const char * data, std::size_t size) {
+  close();
+  setText(data, size);
+}
+
+void MappedCharStream::close() {
+  if (Mapping) munmap(Mapping, Bytes);
+  Mapping = nullptr;
+  Copy.clear();
+  Name.clear();
+  Checkpoints.clear();
+  Data = nullptr;
+  Bytes = Size = Index = Offset = 0;
+}
+
+const char * MappedCharStream::data() const {
+  return Data;
+}
+
+std::size_t MappedCharStream::bytes() const {
+  return Bytes;
+}
+
+void MappedCharStream::setText(const char * data, std::size_t size) {
+  Data = data;
+  Bytes = size;
+  Index = Offset = 0;
+
+  // a character is a leading byte and the continuation bytes after it
+  Size = 0;
+  for (std::size_t offset = 0; offset < Bytes; ++Size) {
+    if (Size % CHECKPOINT == 0) Checkpoints.push_back(offset);
+    for (++offset; offset < Bytes and isContinuation(Data[offset]); ++offset);
+  }
+  if (Size == Bytes) Checkpoints.clear();
+}
+
+std::size_t MappedCharStream::offsetOf(std::size_t index) const {
+  if (Checkpoints.empty()) return index;
+  if (index >= Size) return Bytes;
+  // walk from the current position or from the checkpoint before
+  // 'index', whichever is nearer
+  std::size_t from = index / CHECKPOINT * CHECKPOINT;
+  std::size_t offset = Checkpoints[index / CHECKPOINT];
+  if ((Index > index ? Index - index : index - Index) < index - from) {
+    from = Index;
+    offset = Offset;
+  }
+  for (; from < index; ++from)
+    for (++offset; offset < Bytes and isContinuation(Data[offset]); ++offset);
+  for (; from > index; --from)
+    for (--offset; offset > 0 and isContinuation(Data[offset]); --offset);
+  return offset;
+}
+
+std::size_t MappedCharStream::decode(std::size_t offset) const {
+  unsigned char c = Data[offset];
+  if (c < 0x80) return c;
+  // the bits of the leading byte, and 6 more for each continuation
+  // byte (a malformed sequence gives some value, as any other text)
+  std::size_t n = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+  std::size_t codePoint = c & (0x3F >> n);
+  for (std::size_t k = 1; k <= n and offset + k < Bytes and isContinuation(Data[offset + k]); ++k)
+    codePoint = (codePoint << 6) | (Data[offset + k] & 0x3F);
+  return codePoint;
+}
+
+void MappedCharStream::consume() {
+  if (Index >= Size) throw antlr4::IllegalStateException("cannot consume EOF");
+  ++Index;
+  if (Checkpoints.empty()) Offset = Index;
+  else for (++Offset; Offset < Bytes and isContinuation(Data[Offset]); ++Offset);
+}
+
+std::size_t MappedCharStream::LA(ssize_t i) {
+  if (i == 0) return 0;    // undefined
+  ssize_t position = static_cast<ssize_t>(Index) + (i > 0 ? i - 1 : i);
+  if (position < 0 or position >= static_cast<ssize_t>(Size)) return antlr4::IntStream::EOF;
+  if (Checkpoints.empty()) return static_cast<unsigned char>(Data[position]);
+  if (i == 1) return decode(Offset);
+  return decode(offsetOf(position));
+}
+
+ssize_t MappedCharStream::mark() {
+  return -1;
+}
+
+void MappedCharStream::release(ssize_t marker) {
+}
+
+std::size_t MappedCharStream::index() {
+  return Index;
+}
+
+void MappedCharStream::seek(std::size_t index) {
+  if (index > Size) index = Size;
+  Offset = offsetOf(index);
+  Index = index;
+}
+
+std::size_t MappedCharStream::size() {
+  return Size;
+}
+
+std::string MappedCharStream::getSourceName() const {
+  if (Name.empty()) return antlr4::IntStream::UNKNOWN_SOURCE_NAME;
+  return Name;
+}
+
+std::string MappedCharStream::getText(const antlr4::misc::Interval & interval) {
+  if (interval.a < 0 or interval.b < 0) return "";
+  std::size_t start = interval.a, stop = interval.b;
+  if (start >= Size or stop < start) return "";
+  std::size_t first = offsetOf(start);
+  std::size_t last = stop + 1 >= Size ? Bytes : offsetOf(stop + 1);
+  return std::string(Data + first, last - first);
+}
+
+std::string MappedCharStream::toString() const {
+  return std::string(Data, Bytes);
+}
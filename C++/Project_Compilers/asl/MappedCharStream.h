@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    MappedCharStream - Character stream that reads an ASL program
+//                       in place, from a file mapped in memory
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class MappedCharStream: an antlr4 character stream over the UTF-8
+// bytes of a program, which are read in place: those of a file mapped
+// in memory, or those of a buffer of the caller. An ANTLRInputStream
+// copies the program and decodes it to UTF-32 (four bytes for each
+// character); this one decodes each character when the lexer asks for
+// it, so the program takes in memory just its own size.
+// Indexes are those of the characters (code points), as in an
+// ANTLRInputStream. If the text is ASCII they are byte offsets;
+// otherwise the byte offset of an index is found from the current
+// position, or from the nearest of the checkpoints kept every
+// CHECKPOINT characters.
+
+class MappedCharStream : public antlr4::CharStream {
+
+public:
+
+  // Constructor and destructor
+  MappedCharStream();
+  ~MappedCharStream();
+
+  // Map the file <fileName> and read from it (if it cannot be mapped,
+  // as with a pipe, it is read to memory). Returns false if the file
+  // cannot be opened
+  bool open(const std::string & fileName);
+
+  // Read from the 'size' bytes at 'data', which are not copied: they
+  // must not change nor disappear while the stream is in use
+  void load(const char * data, std::size_t size);
+
+  // Unmap the file (if any) and leave the stream empty
+  void close();
+
+  // The bytes of the text (not the characters)
+  const char * data() const;
+  std::size_t  bytes() const;
+
+  // Methods of antlr4::CharStream
+  void consume() override;
+  std::size_t LA(ssize_t i) override;
+  ssize_t mark() override;
+  void release(ssize_t marker) override;
+  std::size_t index() override;
+  void seek(std::size_t index) override;
+  std::size_t size() override;
+  std::string getSourceName() const override;
+  std::string getText(const antlr4::misc::Interval & interval) override;
+  std::string toString() const override;
+
+private:
+
+  // Number of characters between two checkpoints
+  static const std::size_t CHECKPOINT = 1024;
+
+  // Read from 'data', finding its characters and the checkpoints
+  void setText(const char * data, std::size_t size);
+
+  // Byte offset of the character with index 'index' (at most Size)
+  std::size_t offsetOf(std::size_t index) const;
+
+  // Code point of the character at byte offset 'offset'
+  std::size_t decode(std::size_t offset) const;
+
+  // Text, its size in bytes and in characters, and the mapping (if the
+  // text is that of a mapped file) or the copy (if it was read)
+  const char * Data;
+  std::size_t  Bytes;
+  std::size_t  Size;
+  void *       Mapping;
+  std::string  Copy;
+  std::string  Name;
+
+  // Byte offsets of the characters CHECKPOINT * i (if not ASCII)
+  std::vector<std::size_t> Checkpoints;
+
+  // Current position: character index and its byte offset
+  std::size_t  Index;
+  std::size_t  Offset;
+
+};  // class MappedCharStream
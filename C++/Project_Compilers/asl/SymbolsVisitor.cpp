@@ -117,7 +117,7 @@ antlrcpp::Any SymbolsVisitor::visitVariable_decl(AslParser::Variable_declContext
   DEBUG_ENTER();
   visit(ctx->type());
   for (unsigned int i = 0;i < ctx->ID().size();i++) {
-    std::string ident = ctx->ID(i)->getText();
+    SymTable::IdentId ident = Symbols.internIdent(ctx->ID(i)->getText());
     if (Symbols.findInCurrentScope(ident)) Errors.declaredIdent(ctx->ID(i));
     else {
       TypesMgr::TypeId t1 = getTypeDecor(ctx->type());
@@ -132,7 +132,7 @@ antlrcpp::Any SymbolsVisitor::visitParameters(AslParser::ParametersContext *ctx)
   DEBUG_ENTER();
   for (unsigned int i = 0;i < ctx->ID().size();i++) {
     visit(ctx->type(i));
-    std::string ident = ctx->ID(i)->getText();
+    SymTable::IdentId ident = Symbols.internIdent(ctx->ID(i)->getText());
     if (Symbols.findInCurrentScope(ident)) Errors.declaredIdent(ctx->ID(i));
     else {
       TypesMgr::TypeId t1 = getTypeDecor(ctx->type(i));
@@ -278,18 +278,18 @@ antlrcpp::Any SymbolsVisitor::visitArray_type(AslParser::Array_typeContext *ctx)
 
 // Getters for the necessary tree node atributes:
 //   Scope and Type
-SymTable::ScopeId SymbolsVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) {
+SymTable::ScopeId SymbolsVisitor::getScopeDecor(DecoratedContext *ctx) {
   return Decorations.getScope(ctx);
 }
-TypesMgr::TypeId SymbolsVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) {
+TypesMgr::TypeId SymbolsVisitor::getTypeDecor(DecoratedContext *ctx) {
   return Decorations.getType(ctx);
 }
 
 // Setters for the necessary tree node attributes:
 //   Scope and Type
-void SymbolsVisitor::putScopeDecor(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
+void SymbolsVisitor::putScopeDecor(DecoratedContext *ctx, SymTable::ScopeId s) {
   Decorations.putScope(ctx, s);
 }
-void SymbolsVisitor::putTypeDecor(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
+void SymbolsVisitor::putTypeDecor(DecoratedContext *ctx, TypesMgr::TypeId t) {
   Decorations.putType(ctx, t);
 }
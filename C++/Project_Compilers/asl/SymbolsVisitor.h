@@ -92,12 +92,12 @@ private:
 
   // Getters for the necessary tree node atributes:
   //   Scope and Type
-  SymTable::ScopeId getScopeDecor (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getTypeDecor  (antlr4::ParserRuleContext *ctx);
+  SymTable::ScopeId getScopeDecor (DecoratedContext *ctx);
+  TypesMgr::TypeId  getTypeDecor  (DecoratedContext *ctx);
 
   // Setters for the necessary tree node attributes:
   //   Scope and Type
-  void putScopeDecor (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
-  void putTypeDecor  (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
+  void putScopeDecor (DecoratedContext *ctx, SymTable::ScopeId s);
+  void putTypeDecor  (DecoratedContext *ctx, TypesMgr::TypeId t);
 
 };  // class SymbolsVisitor
@@ -37,6 +37,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <cstddef>    // std::size_t
 
 // uncomment the following line to enable debugging messages with DEBUG*
 //#define DEBUG_BUILD
@@ -56,6 +59,10 @@ TypeCheckVisitor::TypeCheckVisitor(TypesMgr       & Types,
   Errors{Errors} {
 }
 
+void TypeCheckVisitor::selectFunctions(const std::vector<bool> & selected) {
+  selectedFunctions = selected;
+}
+
 // Accessor/Mutator to the attribute currFunctionType
 TypesMgr::TypeId TypeCheckVisitor::getCurrentFunctionTy() const {
   return currFunctionType;
@@ -71,8 +78,9 @@ antlrcpp::Any TypeCheckVisitor::visitProgram(AslParser::ProgramContext *ctx) {
   DEBUG_ENTER();
   SymTable::ScopeId sc = getScopeDecor(ctx);
   Symbols.pushThisScope(sc);
-  for (auto ctxFunc : ctx->function()) { 
-    visit(ctxFunc);
+  std::vector<AslParser::FunctionContext *> functions = ctx->function();
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    if (selectedFunctions.empty() or selectedFunctions[i]) visit(functions[i]);
   }
   if (Symbols.noMainProperlyDeclared()) Errors.noMainProperlyDeclared(ctx);
   Symbols.popScope();
@@ -438,7 +446,7 @@ antlrcpp::Any TypeCheckVisitor::visitParens(AslParser::ParensContext *ctx) {
 
 antlrcpp::Any TypeCheckVisitor::visitIdent(AslParser::IdentContext *ctx) {
   DEBUG_ENTER();
-  std::string ident = ctx->getText();
+  SymTable::IdentId ident = Symbols.findIdent(ctx->getText());
   if (Symbols.findInStack(ident) == -1) {
     Errors.undeclaredIdent(ctx->ID());
     TypesMgr::TypeId te = Types.createErrorTy();
@@ -464,24 +472,24 @@ antlrcpp::Any TypeCheckVisitor::visitList_expr(AslParser::List_exprContext *ctx)
 
 // Getters for the necessary tree node atributes:
 //   Scope, Type ans IsLValue
-SymTable::ScopeId TypeCheckVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) {
+SymTable::ScopeId TypeCheckVisitor::getScopeDecor(DecoratedContext *ctx) {
   return Decorations.getScope(ctx);
 }
-TypesMgr::TypeId TypeCheckVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) {
+TypesMgr::TypeId TypeCheckVisitor::getTypeDecor(DecoratedContext *ctx) {
   return Decorations.getType(ctx);
 }
-bool TypeCheckVisitor::getIsLValueDecor(antlr4::ParserRuleContext *ctx) {
+bool TypeCheckVisitor::getIsLValueDecor(DecoratedContext *ctx) {
   return Decorations.getIsLValue(ctx);
 }
 
 // Setters for the necessary tree node attributes:
 //   Scope, Type ans IsLValue
-void TypeCheckVisitor::putScopeDecor(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
+void TypeCheckVisitor::putScopeDecor(DecoratedContext *ctx, SymTable::ScopeId s) {
   Decorations.putScope(ctx, s);
 }
-void TypeCheckVisitor::putTypeDecor(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
+void TypeCheckVisitor::putTypeDecor(DecoratedContext *ctx, TypesMgr::TypeId t) {
   Decorations.putType(ctx, t);
 }
-void TypeCheckVisitor::putIsLValueDecor(antlr4::ParserRuleContext *ctx, bool b) {
+void TypeCheckVisitor::putIsLValueDecor(DecoratedContext *ctx, bool b) {
   Decorations.putIsLValue(ctx, b);
 }
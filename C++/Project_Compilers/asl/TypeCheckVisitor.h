@@ -37,6 +37,8 @@
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
 
+#include <vector>
+
 // using namespace std;
 
 
@@ -59,6 +61,10 @@ public:
                    TreeDecoration & Decorations,
                    SemErrors      & Errors);
 
+  // Visit only the functions of the program whose position in it is
+  // true in 'selected' (by default, all of them are visited)
+  void selectFunctions(const std::vector<bool> & selected);
+
   // Methods to visit each kind of node.
   // Non visited nodes have been commented out:
   antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
@@ -97,6 +103,8 @@ private:
   SemErrors      & Errors;
   // Current function type (assigned before visit its instructions)
   TypesMgr::TypeId currFunctionType;
+  // Functions to visit (all of them, if empty)
+  std::vector<bool> selectedFunctions;
 
   // Accessor/Mutator to the type (TypeId) of the current function
   TypesMgr::TypeId getCurrentFunctionTy ()                      const;
@@ -104,14 +112,14 @@ private:
 
   // Getters for the necessary tree node atributes:
   //   Scope, Type ans IsLValue
-  SymTable::ScopeId getScopeDecor    (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getTypeDecor     (antlr4::ParserRuleContext *ctx);
-  bool              getIsLValueDecor (antlr4::ParserRuleContext *ctx);
+  SymTable::ScopeId getScopeDecor    (DecoratedContext *ctx);
+  TypesMgr::TypeId  getTypeDecor     (DecoratedContext *ctx);
+  bool              getIsLValueDecor (DecoratedContext *ctx);
 
   // Setters for the necessary tree node attributes:
   //   Scope, Type ans IsLValue
-  void putScopeDecor    (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
-  void putTypeDecor     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
-  void putIsLValueDecor (antlr4::ParserRuleContext *ctx, bool b);
+  void putScopeDecor    (DecoratedContext *ctx, SymTable::ScopeId s);
+  void putTypeDecor     (DecoratedContext *ctx, TypesMgr::TypeId t);
+  void putIsLValueDecor (DecoratedContext *ctx, bool b);
 
 };  // class TypeCheckVisitor
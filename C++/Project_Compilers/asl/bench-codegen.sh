@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Scaling benchmark for code generation: compiles synthetic ASL
+# programs whose main function has an increasing number of statements
+# and prints the compilation time for each size.
+#
+#   usage: ./bench-codegen.sh [asl-binary ...]
+#
+# With several binaries (e.g. a build before and after a change) their
+# times are printed side by side. Sizes can be overridden with SIZES.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+SIZES=${SIZES:-"1000 2000 4000 8000 16000 32000"}
+if (test $# == 0); then
+    set -- ./asl
+fi
+
+#--------------------------------------------
+# write to stdout a program with $1 groups of statements
+function gen_program() {
+    awk -v n=$1 'BEGIN {
+        print "func main()";
+        print "  var a, b : int";
+        print "  var x : float";
+        print "  var v : array [10] of int";
+        print "  a = 1; b = 0; x = 0.5;";
+        for (i = 0; i < n; i++) {
+            print "  b = (a + 2 * b) % 1000 - " i % 7 ";";
+            print "  if b > 100 and not (b == 500) then v[b % 10] = b; else x = x * 1.5 + b; endif";
+        }
+        print "  write b; write \"\\n\";";
+        print "endfunc";
+    }'
+}
+
+#--------------------------------------------
+# print the elapsed seconds compiling file $2 with binary $1
+function time_compile() {
+    local TIMEFORMAT=%R
+    { time "$1" "$2" >/dev/null 2>&1 ; } 2>&1
+}
+
+printf "%10s" "stmts"
+for asl in "$@"; do printf "  %20s" "$(basename "$asl")"; done
+echo ""
+for n in $SIZES; do
+    gen_program $n >bench.asl
+    printf "%10d" $((2 * n))
+    for asl in "$@"; do printf "  %19.3fs" $(time_compile "$asl" bench.asl); done
+    echo ""
+done
+rm -f bench.asl
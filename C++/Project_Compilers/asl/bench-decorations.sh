@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Benchmark of the tree decorations (the attributes of the nodes of the
+# parser tree): time per node to set and read them in TreeDecoration,
+# with the nodes numbered, and in hash maps keyed by the address of the
+# node (measured by asltools --decor-bench), on the examples and on
+# synthetic programs of increasing size. Given a baseline compiler
+# (e.g. one built before the nodes were numbered), the time to compile
+# those programs with it and with asl-binary is measured too.
+#
+#   usage: ./bench-decorations.sh [asltools-binary] [asl-binary] [baseline-binary]
+#
+# Sizes of the synthetic programs can be overridden with SIZES.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+TOOLS=${1:-./asltools}
+ASL=${2:-./asl}
+BASELINE=$3
+SIZES=${SIZES:-"1000 10000 50000"}
+
+#--------------------------------------------
+# write to stdout a program with $1 statements, with long expressions
+# (deep trees, with many nodes to decorate)
+function gen_program() {
+    awk -v n=$1 'BEGIN {
+        print "func f(x : int, y : float) : int";
+        print "  return x + 1;";
+        print "endfunc";
+        print "func main()";
+        print "  var a, b : int";
+        print "  var x : float";
+        print "  var v : array [10] of int";
+        for (i = 0; i < n; i++) {
+            if (i % 2 == 0) print "  v[a % 10] = (a + b * " i ") - f(v[b % 10], x * 2.0) + (a - (b + (a * (b - 1))));";
+            else print "  if a < b and not (x >= 1.5 or v[a % 10] == " i ") then a = a + f(b, x); else x = x * 2; endif";
+        }
+        print "endfunc";
+    }'
+}
+
+#--------------------------------------------
+# print the elapsed seconds running binary $1 with arguments $2...
+function time_run() {
+    local TIMEFORMAT=%R
+    { time "$@" >/dev/null 2>&1 ; } 2>&1
+}
+
+echo "**** set and get the attributes of the nodes"
+echo "examples:"
+$TOOLS --decor-bench ../examples/*.asl | sed 's/^/  /'
+for n in $SIZES; do
+    gen_program $n >bench.asl
+    echo "$n statements:"
+    $TOOLS --decor-bench bench.asl | sed 's/^/  /'
+done
+
+if test -n "$BASELINE"; then
+    echo "**** compilation"
+    printf "%18s  %12s  %12s\n" "program" "$(basename $ASL)" "$(basename $BASELINE)"
+    for n in $SIZES; do
+        gen_program $n >bench.asl
+        printf "%18s  %11.3fs  %11.3fs\n" "$n statements" $(time_run $ASL bench.asl) $(time_run $BASELINE bench.asl)
+    done
+fi
+rm -f bench.asl
@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Benchmark of the input of the compiler: time and peak resident memory
+# to compile synthetic programs of increasing size, which the front end
+# reads in place (mapped in memory). Given a second binary (e.g. one
+# built before the programs were mapped, which copies them to UTF-32),
+# it is measured too, to compare them.
+#
+#   usage: ./bench-input.sh [asl-binary] [baseline-binary]
+#
+# Sizes of the synthetic programs, in MB, can be overridden with SIZES.
+# It needs GNU time (/usr/bin/time) to measure the memory.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+ASL=${1:-./asl}
+BASELINE=$2
+SIZES=${SIZES:-"1 10 50"}
+
+#--------------------------------------------
+# write to stdout a program of about $1 MB: many small functions, with
+# long comments (which the parser never sees, but the lexer reads)
+function gen_program() {
+    awk -v mb=$1 'BEGIN {
+        comment = "//";
+        for (i = 0; i < 30; i++) comment = comment " comment";
+        n = mb * 1000000 / 400;
+        for (i = 0; i < n; i++) {
+            print comment;
+            print "func f" i "(a : int, b : int) : int";
+            print "  var c : int";
+            print "  c = a * " i " + b; if c > 100 then c = c % 100; endif";
+            print "  return c;";
+            print "endfunc";
+        }
+        print "func main()";
+        print "  write f0(1, 2);";
+        print "endfunc";
+    }'
+}
+
+#--------------------------------------------
+# print the elapsed seconds and the peak memory (MB) running binary $1
+# with arguments $2...
+function measure() {
+    /usr/bin/time -f "%e %M" "$@" 2>&1 >/dev/null | tail -1 |
+        awk '{ printf "%8.2fs %8.1f MB", $1, $2 / 1024 }'
+}
+
+printf "%10s  %22s" "program" "$(basename $ASL)"
+test -n "$BASELINE" && printf "  %22s" "$(basename $BASELINE)"
+echo
+for mb in $SIZES; do
+    gen_program $mb >bench.asl
+    printf "%7.1f MB  %22s" $(echo "$(stat -c %s bench.asl) / 1000000" | bc -l) "$(measure $ASL bench.asl)"
+    test -n "$BASELINE" && printf "  %22s" "$(measure $BASELINE bench.asl)"
+    echo
+done
+rm -f bench.asl
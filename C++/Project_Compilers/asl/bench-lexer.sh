@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Benchmark of the lexer written by hand (AslScanner) against the one
+# generated by antlr4 (AslLexer): tokens per second of each one on the
+# examples and on synthetic programs of increasing size (measured by
+# asltools --lex-bench), and the time to compile the examples with each
+# one.
+#
+#   usage: ./bench-lexer.sh [asl-binary] [asltools-binary]
+#
+# The examples are compiled ROUNDS times in a single process. Sizes of
+# the synthetic programs can be overridden with SIZES.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+ASL=${1:-./asl}
+TOOLS=${2:-./asltools}
+ROUNDS=${ROUNDS:-50}
+SIZES=${SIZES:-"1000 10000 100000"}
+
+#--------------------------------------------
+# write to stdout a program with $1 statements, with comments, strings
+# and all kinds of literals
+function gen_program() {
+    awk -v n=$1 'BEGIN {
+        print "// synthetic program for the lexer benchmark";
+        print "func main()";
+        print "  var a, b : int";
+        print "  var x : float";
+        print "  var c : char";
+        for (i = 0; i < n; i++) {
+            if (i % 10 == 0) print "  // statement " i ": some comment text";
+            if (i % 3 == 0) print "  write \"value of a\\t\"; write a; write \"\\n\";";
+            else if (i % 3 == 1) print "  if a <= " i " and not (x >= 3.25) then c = \047\\n\047; else b = b % 7; endif";
+            else print "  while b != " i " do a = (a + b) * 2 - 1; b = b + 1; endwhile";
+        }
+        print "endfunc";
+    }'
+}
+
+#--------------------------------------------
+# print the elapsed seconds running binary $1 with arguments $2...
+function time_run() {
+    local TIMEFORMAT=%R
+    { time "$@" >/dev/null 2>&1 ; } 2>&1
+}
+
+echo "**** tokens per second"
+echo "examples:"
+$TOOLS --lex-bench ../examples/*.asl | sed 's/^/  /'
+for n in $SIZES; do
+    gen_program $n >bench.asl
+    echo "$n statements:"
+    $TOOLS --lex-bench bench.asl | sed 's/^/  /'
+done
+rm -f bench.asl
+
+echo "**** compilation of the examples x $ROUNDS"
+EXAMPLES=$(for r in $(seq $ROUNDS); do ls ../examples/*.asl; done)
+generated=$(time_run $ASL --threads 1 $EXAMPLES)
+handWritten=$(time_run $ASL --hand-lexer --threads 1 $EXAMPLES)
+printf "  %-12s %8.3fs\n  %-12s %8.3fs\n" "AslLexer:" $generated "AslScanner:" $handWritten
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Benchmark for the two-stage parsing: compiles the examples and some
+# synthetic programs of increasing size with full LL prediction only
+# (--ll) and with SLL first (the default), and prints both times.
+# Everything but the parsing is the same in both, so the difference
+# is the reduction of the parse time.
+#
+#   usage: ./bench-parse.sh [asl-binary]
+#
+# The examples are compiled ROUNDS times in a single process (so that
+# the process start does not hide the parse time). Sizes of the
+# synthetic programs can be overridden with SIZES.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+ASL=${1:-./asl}
+ROUNDS=${ROUNDS:-50}
+SIZES=${SIZES:-"1000 2000 4000 8000 16000"}
+
+#--------------------------------------------
+# write to stdout a program with $1 groups of statements, with calls
+# and array accesses that need some lookahead to be told apart
+function gen_program() {
+    awk -v n=$1 'BEGIN {
+        print "func f(x : int, y : float) : int";
+        print "  if y > 1.5 then return x; endif";
+        print "  return x * 2;";
+        print "endfunc";
+        print "func p(x : int)";
+        print "  write x;";
+        print "endfunc";
+        print "func main()";
+        print "  var a, b : int";
+        print "  var x : float";
+        print "  var v : array [10] of int";
+        print "  a = 1; b = 0; x = 0.5;";
+        for (i = 0; i < n; i++) {
+            print "  v[a % 10] = f(v[(b + " i % 5 ") % 10], x * (a - 1.0)) + (a * (b + 2) - v[b % 10]);";
+            print "  p(f(a, x) + v[a % 10]);";
+            print "  if not (a < b or b >= f(a, 2.0)) and v[0] != 3 then a = a + 1; else b = (b + a) % 100; endif";
+        }
+        print "endfunc";
+    }'
+}
+
+#--------------------------------------------
+# print the elapsed seconds running binary $1 with arguments $2...
+function time_run() {
+    local TIMEFORMAT=%R
+    { time "$@" >/dev/null 2>&1 ; } 2>&1
+}
+
+printf "%24s  %10s  %10s  %8s\n" "input" "LL only" "SLL + LL" "speedup"
+EXAMPLES=$(for r in $(seq $ROUNDS); do ls ../examples/*.asl; done)
+ll=$(time_run $ASL --ll --threads 1 $EXAMPLES)
+sll=$(time_run $ASL --threads 1 $EXAMPLES)
+printf "%24s  %9.3fs  %9.3fs  %7.2fx\n" "examples x $ROUNDS" $ll $sll $(echo "$ll / $sll" | bc -l)
+for n in $SIZES; do
+    gen_program $n >bench.asl
+    ll=$(time_run $ASL --ll bench.asl)
+    sll=$(time_run $ASL bench.asl)
+    printf "%24s  %9.3fs  %9.3fs  %7.2fx\n" "$((3 * n)) stmts" $ll $sll $(echo "$ll / $sll" | bc -l)
+done
+rm -f bench.asl
@@ -0,0 +1,89 @@
+#!/bin/bash
+
+# Test of the compilation cache (--cache-dir): compiles all the examples
+# with an empty cache and again with the cache filled by the first round,
+# and checks that both outputs are byte-identical to compiling them with
+# no cache, with and without -O. The second round should find every
+# function of the examples that have no errors. Then adds a function to
+# each example, so that only that one has to be compiled. Last, asks a
+# --server for the LLVM code of the examples, which the second time
+# should be taken from the cache.
+#
+#   usage: ./check-cache.sh [threads]
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+THREADS=${1:-4}
+EXAMPLES=$(ls ../examples/*.asl)
+DIR=$(mktemp -d)
+
+#--------------------------------------------
+# compile the files $3... with options $2 (and --cache-dir $DIR/cache,
+# unless $1 is "none"), printing the statistics of the cache to stderr
+function compile() {
+    local cache=$1 opt=$2
+    shift 2
+    if test "$cache" == none; then
+        ./asl $opt --threads $THREADS "$@" >$DIR/out 2>$DIR/err
+    else
+        ./asl $opt --threads $THREADS --cache-dir $DIR/cache "$@" >$DIR/out 2>$DIR/err
+        grep "^cache " $DIR/err >&2
+        grep -v "^cache " $DIR/err >$DIR/err.tmp; mv $DIR/err.tmp $DIR/err
+    fi
+    cat $DIR/out $DIR/err
+}
+
+status=0
+for opt in "" "-O"; do
+    rm -rf $DIR/cache
+    compile none "$opt" $EXAMPLES >$DIR/expected
+    for round in empty filled; do
+        echo -n "**** $round cache ${opt:-(no -O)} ...."
+        compile cache "$opt" $EXAMPLES >$DIR/got 2>$DIR/stats
+        if cmp -s $DIR/expected $DIR/got; then
+            echo "OK  ($(cat $DIR/stats))"
+        else
+            echo "Different output"
+            diff $DIR/expected $DIR/got | head -20
+            status=1
+        fi
+    done
+done
+
+echo -n "**** a function added to each example ...."
+mkdir $DIR/edited
+for f in $EXAMPLES; do
+    (cat "$f"; printf '\nfunc check_cache_added(a : int) : int\n  return a + 1;\nendfunc\n') \
+        >$DIR/edited/$(basename "$f")
+done
+compile none "" $DIR/edited/*.asl >$DIR/expected
+compile cache "" $DIR/edited/*.asl >$DIR/got 2>$DIR/stats
+if cmp -s $DIR/expected $DIR/got; then
+    echo "OK  ($(cat $DIR/stats))"
+else
+    echo "Different output"
+    diff $DIR/expected $DIR/got | head -20
+    status=1
+fi
+
+echo -n "**** LLVM code through --server ...."
+for f in $EXAMPLES; do
+    printf "compile llvm %d\n" $(wc -c <"$f")
+    cat "$f"
+done >$DIR/requests
+./asl --server <$DIR/requests >$DIR/expected 2>/dev/null
+rm -rf $DIR/cache
+ok=1
+for round in empty filled; do
+    ./asl --server --cache-dir $DIR/cache <$DIR/requests >$DIR/got 2>$DIR/stats
+    cmp -s $DIR/expected $DIR/got || ok=0
+done
+if (test $ok == 1); then
+    echo "OK  ($(grep "^cache " $DIR/stats))"
+else
+    echo "Different output"
+    diff $DIR/expected $DIR/got | head -20
+    status=1
+fi
+rm -rf $DIR
+exit $status
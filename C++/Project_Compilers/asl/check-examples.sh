@@ -94,3 +94,93 @@ for f in ../examples/jp_genc_*.asl; do
 done
 echo "=== END examples/jp_genc_* codegen ===================="
 echo "======================================================="
+
+########### check all 'genc' examples again, with the optimizer
+echo ""
+echo "======================================================="
+echo "=== BEGIN examples/*genc_* codegen with -O ============"
+for f in ../examples/jpbasic_genc_*.asl ../examples/jp_genc_*.asl; do
+    echo -n "****" $(basename "$f") "...." 
+    ./asl -O "$f" >tmp.t 2>&1 
+    if (test $? != 0); then
+       echo "Compilation errors"
+    else
+       ../tvm/tvm tmp.t < "${f/asl/in}" >tmp.out
+       check_genc_example "${f/asl/out}" tmp.out
+    fi
+    rm -f tmp.t tmp.out tmp.diff
+done
+echo "=== END examples/*genc_* codegen with -O =============="
+echo "======================================================="
+
+########### check all 'genc' examples on the in-tree VM (--run), which
+########### must give the same output as tvm
+echo ""
+echo "======================================================="
+echo "=== BEGIN examples/*genc_* run with --run ============="
+for opt in "" "-O"; do
+    for f in ../examples/jpbasic_genc_*.asl ../examples/jp_genc_*.asl; do
+	test -f "$f" || continue
+	echo -n "****" $(basename "$f") $opt "...."
+	input="${f/asl/in}"
+	test -f "$input" || input=/dev/null
+	./asl $opt --run "$f" <"$input" >tmp.out 2>&1
+	check_genc_example "${f/asl/out}" tmp.out
+	rm -f tmp.out
+    done
+done
+echo "=== END examples/*genc_* run with --run ==============="
+echo "======================================================="
+
+########### check all 'genc' examples saved to an object file (--emit)
+########### and run from it (--exec); then objects that are truncated
+########### or corrupt must be rejected
+echo ""
+echo "======================================================="
+echo "=== BEGIN examples/*genc_* with --emit and --exec ====="
+for opt in "" "-O"; do
+    for f in ../examples/jpbasic_genc_*.asl ../examples/jp_genc_*.asl; do
+	test -f "$f" || continue
+	echo -n "****" $(basename "$f") $opt "...."
+	input="${f/asl/in}"
+	test -f "$input" || input=/dev/null
+	if ! ./asl $opt --emit tmp.tobj "$f" >tmp.out 2>&1; then
+	    echo "Compilation errors"
+	else
+	    ./asl --exec tmp.tobj <"$input" >tmp.out 2>&1
+	    check_genc_example "${f/asl/out}" tmp.out
+	fi
+	rm -f tmp.tobj tmp.out
+    done
+done
+
+#--------------------------------------------
+# the object file $1 must be rejected with the message $2
+function check_bad_object() {
+    echo -n "****" $3 "...."
+    ./asl --exec $1 </dev/null >tmp.out 2>&1
+    if (test $? != 0) && grep -q "$2" tmp.out; then
+	echo "OK"
+    else
+	echo "Not rejected"
+	cat tmp.out
+    fi
+    rm -f tmp.out
+}
+
+f=$(ls ../examples/jp_genc_*.asl | head -1)
+./asl --emit tmp.tobj "$f" >/dev/null 2>&1
+size=$(wc -c <tmp.tobj)
+head -c $((size - 1)) tmp.tobj >bad.tobj
+check_bad_object bad.tobj "truncated file" "object without its last byte"
+head -c 10 tmp.tobj >bad.tobj
+check_bad_object bad.tobj "not an object file" "object shorter than its header"
+cp tmp.tobj bad.tobj
+printf 'x' | dd of=bad.tobj bs=1 seek=$((size - 1)) conv=notrunc 2>/dev/null
+check_bad_object bad.tobj "corrupt contents" "object with unterminated strings"
+cp tmp.tobj bad.tobj
+printf '\377\377\377\177' | dd of=bad.tobj bs=1 seek=12 conv=notrunc 2>/dev/null
+check_bad_object bad.tobj "corrupt contents" "object with a wrong main function"
+rm -f tmp.tobj bad.tobj
+echo "=== END examples/*genc_* with --emit and --exec ======="
+echo "======================================================="
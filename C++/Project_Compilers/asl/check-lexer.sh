@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Differential test of the lexer written by hand (AslScanner) against
+# the one generated by antlr4 (AslLexer): both must give the same
+# tokens (types, texts, lines, columns and indexes) and the same
+# lexical errors on the examples and on generated programs, with the
+# corner cases of the grammar (incomplete comments, strings and
+# characters, wrong escapes, maximal munch, non-ASCII text), compared
+# by asltools (make asltools). Then checks that compiling the examples
+# with --hand-lexer gives the same output as with the lexer of antlr4.
+#
+#   usage: ./check-lexer.sh [programs]
+#
+# 'programs' is the number of generated programs of each kind.
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+PROGRAMS=${1:-200}
+EXAMPLES=$(ls ../examples/*.asl)
+EXAMPLE=($EXAMPLES)
+DIR=$(mktemp -d)
+
+# pieces of programs, separated by '|': tokens, and fragments of them
+# that are not (as an awk string; the generated programs are ASCII but
+# for the random ones, which get some multibyte characters too)
+FRAGMENTS='"\047|\\|\"|/|//|\r|\n|\r\n|!|=|==|!=|<|<=|>|>=| |\t|1|23|.|4.5|12.|a|x_1|_|'\
+'endwhile|if|ifx|and|or|not|(|)|[|]|:|,|;|+|-|*|%|?|#|$|~|@|{|}|\047a\047|\047\\n\047|'\
+'\047\\t\047|\047\\\047\047|\047\047|\047\047\047|\"ab\\n\"|\"x|\\\"|\\b|\\q|n|t"'
+
+#--------------------------------------------
+# write to stdout the program $1 with $3 random changes (insertions of
+# fragments and deletions), using the random seed $2
+function mutate() {
+    LC_ALL=C awk -v seed=$2 -v changes=$3 '{ s = s $0 "\n" }
+    END {
+        srand(seed);
+        n = split('"$FRAGMENTS"', frag, "|");
+        for (k = 0; k < changes; k++) {
+            i = int(rand() * (length(s) + 1));
+            if (rand() < 0.5) s = substr(s, 1, i) frag[int(rand() * n) + 1] substr(s, i + 1);
+            else s = substr(s, 1, i) substr(s, i + 2 + int(rand() * 5));
+        }
+        printf "%s", s;
+    }' "$1"
+}
+
+#--------------------------------------------
+# write to stdout $2 random fragments, using the random seed $1
+function random_program() {
+    awk -v seed=$1 -v size=$2 'BEGIN {
+        srand(seed);
+        n = split('"$FRAGMENTS"' "|é|€|😀", frag, "|");
+        for (k = 0; k < size; k++) printf "%s", frag[int(rand() * n) + 1];
+    }'
+}
+
+for p in $(seq $PROGRAMS); do
+    mutate ${EXAMPLE[(p - 1) % ${#EXAMPLE[@]}]} $p $(( p % 12 + 1 )) >$DIR/mutated$p.asl
+    random_program $p $(( p % 60 )) >$DIR/random$p.asl
+done
+
+status=0
+for corpus in "$EXAMPLES" "$DIR/mutated*.asl" "$DIR/random*.asl"; do
+    echo -n "**** tokens of $(echo $corpus | wc -w) programs like $(echo $corpus | cut -d' ' -f1) ...."
+    if ./asltools --lex-check $corpus >$DIR/report; then
+        echo "OK  ($(tail -1 $DIR/report))"
+    else
+        echo "Different tokens"
+        head -30 $DIR/report
+        status=1
+    fi
+done
+
+echo -n "**** compilation of the examples with --hand-lexer ...."
+ok=1
+for f in $EXAMPLES; do
+    ./asl "$f" >$DIR/antlr.out 2>$DIR/antlr.err
+    ./asl --hand-lexer "$f" >$DIR/hand.out 2>$DIR/hand.err
+    cmp -s $DIR/antlr.out $DIR/hand.out && cmp -s $DIR/antlr.err $DIR/hand.err || { ok=0; echo; echo "  $f"; }
+done
+if (test $ok == 1); then echo "OK"; else echo "Different output"; status=1; fi
+rm -rf $DIR
+exit $status
@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Stress test for concurrent compilations: compiles all the examples
+# (each one several times) in a single process with many threads, and
+# checks that its output is byte-identical to compiling them serially,
+# one process per file, with and without -O. Then checks that --batch
+# writes beside each example the same code as a serial compilation, and
+# that --threads 0 (one thread per hardware thread) works and wrong
+# numbers of threads are rejected.
+#
+#   usage: ./check-threads.sh [threads] [rounds]
+
+export LD_LIBRARY_PATH=$HOME/assig/cl/runtime/lib
+
+THREADS=${1:-16}
+ROUNDS=${2:-8}
+EXAMPLES=$(ls ../examples/*.asl)
+FILES=$(for r in $(seq $ROUNDS); do echo $EXAMPLES; done)
+
+status=0
+for opt in "" "-O"; do
+    echo -n "**** $THREADS threads, $ROUNDS rounds ${opt:-(no -O)} ...."
+    rm -f tmp.serial.out tmp.serial.err
+    for f in $FILES; do
+        ./asl $opt "$f" >>tmp.serial.out 2>>tmp.serial.err
+    done
+    ./asl $opt --threads $THREADS $FILES >tmp.threads.out 2>tmp.threads.err
+    if cmp -s tmp.serial.out tmp.threads.out && cmp -s tmp.serial.err tmp.threads.err; then
+        echo "OK"
+    else
+        echo "Different output"
+        diff tmp.serial.out tmp.threads.out | head -20
+        diff tmp.serial.err tmp.threads.err | head -20
+        status=1
+    fi
+    rm -f tmp.serial.out tmp.serial.err tmp.threads.out tmp.threads.err
+done
+echo -n "**** --batch with a manifest ...."
+DIR=$(mktemp -d)
+cp $EXAMPLES $DIR
+ls $DIR/*.asl >$DIR/manifest
+./asl --batch --threads $THREADS --manifest $DIR/manifest >/dev/null 2>$DIR/report
+ok=1
+for f in $EXAMPLES; do
+    if ./asl "$f" >$DIR/serial.t 2>/dev/null; then
+        cmp -s $DIR/serial.t $DIR/$(basename "${f%.asl}").t || ok=0
+    elif test -e $DIR/$(basename "${f%.asl}").t; then
+        ok=0
+    fi
+done
+if (test $ok == 1); then
+    echo "OK  ($(tail -1 $DIR/report))"
+else
+    echo "Different code"
+    status=1
+fi
+rm -rf $DIR
+
+echo -n "**** --threads 0 and wrong numbers of threads ...."
+ok=1
+for f in $EXAMPLES; do
+    ./asl "$f" >>tmp.serial.out 2>/dev/null
+done
+./asl --threads 0 $EXAMPLES >tmp.threads.out 2>/dev/null
+cmp -s tmp.serial.out tmp.threads.out || ok=0
+for n in foo -1 3x "" 99999999999; do
+    if ./asl --threads "$n" $EXAMPLES >tmp.threads.out 2>&1 || ! grep -q "^Usage" tmp.threads.out; then
+        ok=0
+        echo -n " (--threads '$n' accepted)"
+    fi
+done
+rm -f tmp.serial.out tmp.threads.out
+if (test $ok == 1); then echo "OK"; else echo "Wrong"; status=1; fi
+exit $status
@@ -30,111 +30,394 @@
 ////////////////////////////////////////////////////////////////
 
 
+#include "Compilation.h"
+#include "CompileCache.h"
 #include "antlr4-runtime.h"
-#include "AslLexer.h"
-#include "AslParser.h"
-
-#include "../common/TypesMgr.h"
-#include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
-#include "../common/SemErrors.h"
-#include "SymbolsVisitor.h"
-#include "TypeCheckVisitor.h"
 #include "../common/code.h"
-#include "CodeGenVisitor.h"
+#include "../common/TCodeVM.h"
+#include "../common/WorkPool.h"
 
 #include <iostream>
-#include <fstream>    // ifstream
+#include <fstream>    // ifstream, ofstream
+#include <sstream>    // ostringstream, istringstream
 
 #include <cstdio>     // fopen
 #include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
+#include <string>
+#include <vector>
+#include <memory>     // unique_ptr
+#include <chrono>
 
 // using namespace std;
 // using namespace antlr4;
 
 
-int main(int argc, const char* argv[]) {
-  // check the correct use of the program
-  if (argc > 2) {
-    std::cout << "Usage: ./main [<file>]" << std::endl;
-    return EXIT_FAILURE;
+namespace {
+
+  // print generated code as output, without the instructions that
+  // tvm does not have (array copies, modulo and compare-and-jumps)
+  void printCode(const code & mycode, std::ostream & out) {
+    code tvmCode = mycode;
+    tvmCode.expand_for_tvm();
+    out << tvmCode.dump() << std::endl;
   }
-  if (argc == 2 and not std::fopen(argv[1], "r")) {
-    std::cout << "No such file: " << argv[1] << std::endl;
-    return EXIT_FAILURE;
+
+  // name of the file for the code of <fileName> in a batch: the same
+  // name with extension .t instead of .asl (or of any other)
+  std::string outputFileName(const std::string & fileName) {
+    std::size_t slashPos = fileName.rfind("/");
+    std::size_t dotPos   = fileName.rfind(".");
+    if (dotPos == std::string::npos or
+        (slashPos != std::string::npos and dotPos < slashPos))
+      return fileName + ".t";
+    return fileName.substr(0, dotPos) + ".t";
   }
 
-  // open input file (or std::cin) and create a character stream
-  antlr4::ANTLRInputStream input;
-  if (argc == 2) {  // read from <file>
-    std::ifstream stream;
-    stream.open(argv[1]);
-    input = antlr4::ANTLRInputStream(stream);
+  // add to 'fileNames' those listed in the manifest <listName>, one per
+  // line (empty lines and lines starting with '#' are skipped)
+  bool readManifest(const char *listName, std::vector<std::string> & fileNames) {
+    std::ifstream list(listName);
+    if (not list) return false;
+    std::string line;
+    while (std::getline(list, line)) {
+      std::size_t last = line.find_last_not_of(" \t\r");
+      if (last == std::string::npos or line[0] == '#') continue;
+      fileNames.push_back(line.substr(0, last+1));
+    }
+    return true;
   }
-  else {            // read fron std::cin
-    input = antlr4::ANTLRInputStream(std::cin);
+
+  // the number of threads in <text>, only decimal digits (false if it
+  // is anything else, or too big)
+  bool readThreads(const char *text, unsigned & nThreads) {
+    std::string digits(text);
+    if (digits.empty() or digits.size() > 9 or
+        digits.find_first_not_of("0123456789") != std::string::npos)
+      return false;
+    nThreads = std::stoul(digits);
+    return true;
+  }
+
+  // a file of a batch and the results of its compilation
+  struct BatchFile {
+    std::string        fileName;
+    std::ostringstream out, err;
+    std::size_t        bytes;
+    int                status;
+  };
+
+  // compile one file of a batch with the lexer and parser of 'frontend'
+  // (and the code in 'cache', if not null). Its code is written to
+  // 'file.out' or, with 'beside', to a file next to the source (and then
+  // 'file.out' only gets the errors)
+  void compileFile(BatchFile & file, Frontend & frontend, bool optimize, bool optStats,
+                   bool beside, CompileCache * cache) {
+    std::ifstream stream(file.fileName, std::ios::binary | std::ios::ate);
+    file.bytes = stream ? std::size_t(stream.tellg()) : 0;
+    file.status = EXIT_FAILURE;
+    Compilation compilation(file.out, file.err);
+    compilation.setCache(cache);
+    if (not compilation.compileFile(file.fileName, frontend, optimize,
+                                    optStats ? &file.err : nullptr))
+      return;
+    if (not beside) printCode(compilation.getCode(), file.out);
+    else {
+      std::string outName = outputFileName(file.fileName);
+      std::ofstream output(outName);
+      printCode(compilation.getCode(), output);
+      if (not output) {
+        file.out << "Cannot write file: " << outName << std::endl;
+        return;
+      }
+    }
+    file.status = EXIT_SUCCESS;
+  }
+
+  // compile several files in this process, on a work-stealing pool of
+  // 'nThreads' workers (0: one per hardware thread), each one with its
+  // own lexer and parser. Without 'batch', the outputs are printed in
+  // the order of the files (the same as compiling them one after the
+  // other); with 'batch', the code of each file is written beside it,
+  // the errors are printed after the name of their file, and the
+  // throughput is reported to stderr. With 'onlyLL' the files are
+  // parsed with full LL prediction only, and with 'handLexer' their
+  // tokens come from AslScanner. All the workers share 'cache'
+  int compileFiles(const std::vector<std::string> & fileNames, unsigned nThreads,
+                   bool optimize, bool optStats, bool batch, bool onlyLL, bool handLexer,
+                   CompileCache * cache) {
+    std::size_t n = fileNames.size();
+    std::vector<BatchFile> files(n);
+    for (std::size_t i = 0; i < n; ++i) files[i].fileName = fileNames[i];
+
+    WorkPool pool(nThreads);
+    std::vector<std::unique_ptr<Frontend>> frontends(pool.size());
+    auto start = std::chrono::steady_clock::now();
+    pool.run(n, [&](std::size_t i, std::size_t worker) {
+      if (not frontends[worker]) {
+        frontends[worker].reset(new Frontend());
+        frontends[worker]->setTwoStageParsing(not onlyLL);
+        frontends[worker]->setHandWrittenLexer(handLexer);
+      }
+      compileFile(files[i], *frontends[worker], optimize, optStats, batch, cache);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    int result = EXIT_SUCCESS;
+    std::size_t failed = 0, bytes = 0;
+    for (auto & file : files) {
+      std::string out = file.out.str(), err = file.err.str();
+      if (batch and not (out.empty() and err.empty()))
+        std::cout << "==> " << file.fileName << " <==" << std::endl;
+      std::cout << out;
+      std::cerr << err;
+      bytes += file.bytes;
+      if (file.status != EXIT_SUCCESS) {
+        result = EXIT_FAILURE;
+        ++failed;
+      }
+    }
+    if (batch) {
+      double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+      double megabytes = bytes / 1e6;
+      std::ostringstream report;
+      report.setf(std::ios::fixed);
+      report.precision(2);
+      report << n << " files (" << failed << " with errors), " << megabytes << " MB in "
+             << seconds << " s with " << pool.size() << " threads: "
+             << n / seconds << " files/s, " << megabytes / seconds << " MB/s";
+      std::cerr << report.str() << std::endl;
+    }
+    return result;
+  }
+
+  // write an answer of the compile server: its header line and payload
+  void answer(std::ostream & out, bool ok, const std::string & payload) {
+    out << (ok ? "ok " : "error ") << payload.size() << "\n" << payload << std::flush;
   }
 
-  // create a lexer that consumes the character stream and produces a token stream
-  AslLexer lexer(&input);
-  antlr4::CommonTokenStream tokens(&lexer);
+  // serve compile requests read from 'in', answering to 'out', until
+  // the end of 'in' or a "quit" line. A request is a line
+  //     compile <tcode|llvm> [-O] <n>
+  // followed by the <n> bytes of an ASL program, and its answer is a line
+  //     ok <m>     or     error <m>
+  // followed by <m> bytes: the t-code or LLVM IR of the program, or its
+  // diagnostics (or what is wrong in the request). The lexer and the
+  // parser of 'frontend' are kept warm for all the requests, which also
+  // share 'cache' (if not null)
+  int serve(std::istream & in, std::ostream & out, Frontend & frontend, CompileCache * cache) {
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream request(line);
+      std::vector<std::string> words;
+      for (std::string word; request >> word; ) words.push_back(word);
+      if (words.empty()) continue;
+      if (words.size() == 1 and words[0] == "quit") break;
 
-  // create a parser that consumes the token stream, and parses it.
-  AslParser parser(&tokens);
+      bool optimize = words.size() == 4 and words[2] == "-O";
+      bool llvm = words.size() > 1 and words[1] == "llvm";
+      std::size_t size = 0;
+      std::istringstream sizeText(words.back());
+      bool wellFormed = words[0] == "compile" and (words.size() == 3 or optimize) and
+                        (llvm or words[1] == "tcode") and
+                        words.back().find_first_not_of("0123456789") == std::string::npos and
+                        (sizeText >> size);
+      if (not wellFormed) {
+        answer(out, false, "Wrong request: " + line + "\n");
+        continue;
+      }
+      std::string text(size, '\0');
+      if (size > 0 and not in.read(&text[0], size)) return EXIT_FAILURE;
 
-  // call the parser and get the parse tree
-  antlr4::tree::ParseTree *tree = parser.program();
+      std::ostringstream messages, result;
+      std::istringstream source(text);
+      try {
+        Compilation compilation(messages, messages);
+        compilation.setCache(cache);
+        if (not compilation.compile(source, frontend, optimize, nullptr, llvm)) {
+          answer(out, false, messages.str());
+          continue;
+        }
+        if (llvm)
+          result << compilation.dumpLLVM() << std::endl;
+        else
+          printCode(compilation.getCode(), result);
+      }
+      catch (const std::exception & e) {
+        answer(out, false, messages.str() + "Internal error: " + e.what() + "\n");
+        continue;
+      }
+      answer(out, true, result.str());
+    }
+    return EXIT_SUCCESS;
+  }
+
+}
 
-  // check for lexical or syntactical errors
-  if (lexer.getNumberOfSyntaxErrors() > 0 or
-      parser.getNumberOfSyntaxErrors() > 0) {
-    std::cout << "Lexical and/or syntactical errors have been found." << std::endl;
+
+int main(int argc, const char* argv[]) {
+  // check the correct use of the program
+  //   --run         : execute the generated code instead of printing it
+  //   --emit <obj>  : save the generated code to an object file
+  //   --exec <obj>  : execute an object file (nothing is compiled)
+  //   -O            : optimize the generated code
+  //   --opt-stats   : print to stderr what the optimizer did
+  //   --ll          : parse with full LL prediction only, instead of
+  //                   trying the faster SLL first (to compare them)
+  //   --hand-lexer  : read the tokens from the lexer written by hand
+  //                   (AslScanner) instead of the one of antlr4
+  //   --threads <n> : compile all the given files, <n> at a time (0:
+  //                   one at a time per hardware thread)
+  //   --batch       : compile all the given files (and those listed in
+  //                   the --manifest <list>), writing the code of each
+  //                   one beside it, with extension .t
+  //   --server      : compile the programs requested through stdin,
+  //                   answering through stdout (see 'serve' above)
+  //   --cache-dir <dir> : reuse the code of the functions compiled before
+  //                   (kept in <dir>), and print to stderr how many were
+  //                   found
+  bool run = false;
+  bool optimize = false;
+  bool optStats = false;
+  bool batch = false;
+  bool server = false;
+  bool onlyLL = false;
+  bool handLexer = false;
+  const char *fileName = nullptr;
+  const char *emitFile = nullptr;
+  const char *execFile = nullptr;
+  const char *manifest = nullptr;
+  const char *cacheDir = nullptr;
+  std::vector<std::string> fileNames;
+  unsigned nThreads = 0;
+  bool threads = false;
+  bool usageOk = true;
+  for (int i = 1; i < argc and usageOk; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--run") run = true;
+    else if (arg == "-O") optimize = true;
+    else if (arg == "--opt-stats") optimize = optStats = true;
+    else if (arg == "--ll") onlyLL = true;
+    else if (arg == "--hand-lexer") handLexer = true;
+    else if (arg == "--emit" and i+1 < argc) emitFile = argv[++i];
+    else if (arg == "--exec" and i+1 < argc) execFile = argv[++i];
+    else if (arg == "--threads" and i+1 < argc) usageOk = threads = readThreads(argv[++i], nThreads);
+    else if (arg == "--batch") batch = true;
+    else if (arg == "--server") server = true;
+    else if (arg == "--manifest" and i+1 < argc) manifest = argv[++i];
+    else if (arg == "--cache-dir" and i+1 < argc) cacheDir = argv[++i];
+    else if (arg[0] != '-') fileNames.push_back(argv[i]);
+    else usageOk = false;
+  }
+  if (manifest and not readManifest(manifest, fileNames)) {
+    std::cout << "No such file: " << manifest << std::endl;
+    return EXIT_FAILURE;
+  }
+  bool manyFiles = batch or threads;
+  bool compiling = optimize or run or emitFile or execFile or manyFiles or manifest;
+  if (server) usageOk = usageOk and not compiling and fileNames.empty();
+  else if (manyFiles) usageOk = usageOk and not fileNames.empty() and not (run or emitFile or execFile);
+  else usageOk = usageOk and fileNames.size() <= 1 and not manifest;
+  if (not manyFiles and not fileNames.empty()) fileName = fileNames[0].c_str();
+  if (not usageOk or (execFile and (fileName or run or emitFile or optimize or cacheDir))) {
+    std::cout << "Usage: ./main [-O] [--opt-stats] [--ll] [--hand-lexer] [--cache-dir <dir>] [--run] [--emit <obj>] [<file>]" << std::endl;
+    std::cout << "       ./main --exec <obj>" << std::endl;
+    std::cout << "       ./main [-O] [--opt-stats] [--ll] [--hand-lexer] [--cache-dir <dir>] --threads <n> <file>..." << std::endl;
+    std::cout << "       ./main [-O] [--opt-stats] [--ll] [--hand-lexer] [--cache-dir <dir>] --batch [--threads <n>] [--manifest <list>] [<file>...]" << std::endl;
+    std::cout << "       ./main [--ll] [--hand-lexer] [--cache-dir <dir>] --server" << std::endl;
     return EXIT_FAILURE;
   }
 
-  //return EXIT_SUCCESS; // ***********per no provar el typecheck ni el codegen
+  // run a saved object file, mapped in place
+  if (execFile) {
+    TCodeImage image;
+    if (not image.load(execFile)) {
+      std::cerr << image.error() << std::endl;
+      return EXIT_FAILURE;
+    }
+    TCodeVM vm(image, std::cin, std::cout);
+    return vm.run();
+  }
 
-  // print the parse tree (for debugging purposes)
-  // std::cout << tree->toStringTree(&parser) << std::endl;
+  // the code of the functions compiled before, shared by all the
+  // compilations of this process
+  std::unique_ptr<CompileCache> cache;
+  if (cacheDir) {
+    cache.reset(new CompileCache(cacheDir));
+    if (not cache->open()) {
+      std::cerr << "Cannot use cache directory: " << cacheDir << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
-  // auxililary classes we are going to need to store information while
-  // traversing the tree. They are described below in this document
-  TypesMgr       types;
-  SymTable       symbols(types);
-  TreeDecoration decorations;
-  SemErrors      errors;
+  // several compilations in this process, each in its own context
+  if (manyFiles) {
+    int result = compileFiles(fileNames, nThreads, optimize, optStats, batch, onlyLL, handLexer,
+                              cache.get());
+    if (cache) cache->printStatistics(std::cerr);
+    return result;
+  }
 
-  // create a visitor that looks for variables and function declarations
-  // in the tree and stores required information
-  SymbolsVisitor symboldecl(types, symbols, decorations, errors);
-  symboldecl.visit(tree);
+  // the lexer and the parser for the compilations of this process
+  Frontend frontend;
+  frontend.setTwoStageParsing(not onlyLL);
+  frontend.setHandWrittenLexer(handLexer);
 
-  // create another visitor that will perform type checkings wherever
-  // it is needed (on expressions, assignments, parameter passing, etc)
-  TypeCheckVisitor typecheck(types, symbols, decorations, errors);
-  typecheck.visit(tree);
+  // a long-running compiler, driven by requests through stdin
+  if (server) {
+    std::ios::sync_with_stdio(false);
+    int result = serve(std::cin, std::cout, frontend, cache.get());
+    if (cache) cache->printStatistics(std::cerr);
+    return result;
+  }
 
-  if (errors.getNumberOfSemanticErrors() > 0) {
-    std::cout << "There are semantic errors: no code generated." << std::endl;
+  if (fileName and not std::fopen(fileName, "r")) {
+    std::cout << "No such file: " << fileName << std::endl;
     return EXIT_FAILURE;
   }
 
-//   return EXIT_SUCCESS; // ***********per no provar el codegen
+  // the state of the compilation (types, symbols, decorations, errors
+  // and counters) and the code it generates. It reads the program from
+  // <file> or from std::cin
+  Compilation compilation(std::cout, std::cerr);
+  compilation.setCache(cache.get());
+  bool ok;
+  if (fileName) {   // read from <file>, mapped in memory
+    ok = compilation.compileFile(fileName, frontend, optimize, optStats ? &std::cerr : nullptr);
+  }
+  else {            // read fron std::cin
+    ok = compilation.compile(std::cin, frontend, optimize, optStats ? &std::cerr : nullptr);
+  }
+  if (cache) cache->printStatistics(std::cerr);
+  if (not ok) return EXIT_FAILURE;
+  const code & mycode = compilation.getCode();
 
-  // create a third visitor that will return the generated code
-  // for each part of the tree, and will store it in 'mycode'
-  CodeGenVisitor codegenerator(types, symbols, decorations);
-  code mycode = codegenerator.visit(tree);
+  // with --run or --emit, decode the generated code to an executable
+  // image and run it (reading the program input from std::cin) or save it
+  if (run or emitFile) {
+    TCodeImage image;
+    if (not image.build(mycode)) {
+      std::cerr << image.error() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (emitFile and not image.save(emitFile)) {
+      std::cerr << "Cannot write object file: " << emitFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (not run) return EXIT_SUCCESS;
+    TCodeVM vm(image, std::cin, std::cout);
+    return vm.run();
+  }
 
   // print generated code as output
-  std::cout << mycode.dump() << std::endl;
+  printCode(mycode, std::cout);
 
   // uncomment the following lines to generate LLVM code
-  // and write it to a .ll file
-  // std::string llvmStr = mycode.dumpLLVM(types, symbols);
+  // and write it to a .ll file (with -O, call compile with forLLVM:
+  // LLVM needs a single type per temporary)
+  // std::string llvmStr = compilation.dumpLLVM();
   // std::string llvmFileName;
-  // if (argc == 2) { // read from <file>
-  //   std::string inputFileName = std::string(argv[1]);
+  // if (fileName) { // read from <file>
+  //   std::string inputFileName = std::string(fileName);
   //   std::size_t slashPos = inputFileName.rfind("/");
   //   std::size_t dotPos   = inputFileName.rfind(".");
   //   llvmFileName = inputFileName.substr(slashPos+1, dotPos-slashPos-1) + ".ll";
@@ -0,0 +1,330 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Asl tools - Checks and benchmarks of parts of the front-end
+//                of the Asl compiler (not part of the compiler)
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluís Padró (padro@cs.upc.edu)
+//             José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+#include "AslLexer.h"
+#include "AslParser.h"
+#include "AslScanner.h"
+#include "MappedCharStream.h"
+#include "antlr4-runtime.h"
+#include "tree/ParseTreeProperty.h"
+#include "../common/DecoratedContext.h"
+#include "../common/TreeDecoration.h"
+
+#include <iostream>
+#include <fstream>    // ifstream
+#include <sstream>    // ostringstream, istringstream
+
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
+#include <string>
+#include <vector>
+#include <memory>     // unique_ptr
+#include <chrono>
+#include <functional>
+
+// using namespace std;
+// using namespace antlr4;
+
+
+namespace {
+
+
+  // contents of the file <fileName> (false if it cannot be read)
+  bool readFile(const std::string & fileName, std::string & text) {
+    std::ifstream stream(fileName, std::ios::binary);
+    if (not stream) return false;
+    std::ostringstream contents;
+    contents << stream.rdbuf();
+    text = contents.str();
+    return true;
+  }
+
+  // writes the lexical errors, in the order they are found, to a stream
+  class ErrorDump : public antlr4::BaseErrorListener {
+  public:
+    ErrorDump(std::ostream & out) : Out(out) {}
+    void syntaxError(antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol,
+                     std::size_t line, std::size_t charPositionInLine,
+                     const std::string &msg, std::exception_ptr e) override {
+      Out << "line " << line << ":" << charPositionInLine << " " << msg << "\n";
+    }
+  private:
+    std::ostream & Out;
+  };
+
+
+  // write all the tokens of 'source' (type, position, indexes and text,
+  // one per line) and its lexical errors to 'out'. Returns the number
+  // of tokens
+  std::size_t dumpTokens(antlr4::TokenSource & source, std::ostream & out) {
+    std::size_t n = 0;
+    for (;;) {
+      std::unique_ptr<antlr4::Token> token = source.nextToken();
+      bool atEOF = token->getType() == antlr4::Token::EOF;
+      out << (atEOF ? std::string("EOF") : std::to_string(token->getType())) << " "
+          << token->getLine() << ":" << token->getCharPositionInLine() << " "
+          << token->getStartIndex() << ":" << long(token->getStopIndex()) << " "
+          << (atEOF ? std::string() : token->getText()) << "\n";
+      if (atEOF) return n;
+      ++n;
+    }
+  }
+
+  // differential test of the lexers: the tokens and lexical errors of
+  // AslScanner must be the same as those of AslLexer in every file, and
+  // so must be those of AslLexer reading a MappedCharStream instead of
+  // an ANTLRInputStream. The first difference in each file is printed
+  int checkLexers(const std::vector<std::string> & fileNames) {
+    std::size_t differ = 0, tokens = 0;
+    for (auto & fileName : fileNames) {
+      std::string text;
+      if (not readFile(fileName, text)) {
+        std::cout << "No such file: " << fileName << std::endl;
+        return EXIT_FAILURE;
+      }
+      antlr4::ANTLRInputStream input(text);
+      MappedCharStream mapped;
+      mapped.open(fileName);
+      AslLexer lexer(&input), mappedLexer(&mapped);
+      AslScanner scanner;
+      scanner.setInput(mapped.data(), mapped.bytes(), &mapped);
+      std::ostringstream expected, mappedGot, got;
+      ErrorDump expectedErrors(expected), mappedErrors(mappedGot), gotErrors(got);
+      lexer.removeErrorListeners();
+      lexer.addErrorListener(&expectedErrors);
+      mappedLexer.removeErrorListeners();
+      mappedLexer.addErrorListener(&mappedErrors);
+      scanner.addErrorListener(&gotErrors);
+      tokens += dumpTokens(lexer, expected);
+      dumpTokens(mappedLexer, mappedGot);
+      dumpTokens(scanner, got);
+      bool same = true;
+      for (auto & other : {std::make_pair("AslScanner:                ", &got),
+                           std::make_pair("AslLexer (mapped input):   ", &mappedGot)}) {
+        if (expected.str() == other.second->str()) continue;
+        same = false;
+        std::istringstream e(expected.str()), g(other.second->str());
+        std::string eLine, gLine;
+        for (std::size_t i = 1; ; ++i) {
+          bool eMore = bool(std::getline(e, eLine)), gMore = bool(std::getline(g, gLine));
+          if (eMore and gMore and eLine == gLine) continue;
+          std::cout << fileName << ": line " << i << " of the token dumps differs" << std::endl
+                    << "  AslLexer (ANTLRInputStream): " << (eMore ? eLine : "(end)") << std::endl
+                    << "  " << other.first << (gMore ? gLine : "(end)") << std::endl;
+          break;
+        }
+      }
+      if (not same) ++differ;
+    }
+    std::cout << fileNames.size() << " files, " << tokens << " tokens: "
+              << differ << " files with different tokens" << std::endl;
+    return differ == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // tokens per second of 'source' over 'texts' (loaded in 'input'), read
+  // again and again for at least a second
+  double tokenRate(antlr4::TokenSource & source, antlr4::ANTLRInputStream & input,
+                   const std::vector<std::string> & texts,
+                   const std::function<void(const std::string &)> & restart) {
+    std::size_t tokens = 0;
+    std::chrono::duration<double> elapsed(0);
+    auto start = std::chrono::steady_clock::now();
+    while (elapsed.count() < 1.0) {
+      for (auto & text : texts) {
+        input.load(text);
+        restart(text);
+        while (source.nextToken()->getType() != antlr4::Token::EOF) ++tokens;
+      }
+      elapsed = std::chrono::steady_clock::now() - start;
+    }
+    return tokens / elapsed.count();
+  }
+
+  // benchmark of the lexers: tokens per second of AslLexer and of
+  // AslScanner over the given files
+  int benchLexers(const std::vector<std::string> & fileNames) {
+    std::vector<std::string> texts(fileNames.size());
+    for (std::size_t i = 0; i < fileNames.size(); ++i)
+      if (not readFile(fileNames[i], texts[i])) {
+        std::cout << "No such file: " << fileNames[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+    antlr4::ANTLRInputStream input;
+    AslLexer lexer(&input);
+    AslScanner scanner;
+    lexer.removeErrorListeners();
+    double generated = tokenRate(lexer, input, texts, [&](const std::string &) {
+      lexer.setInputStream(&input);
+    });
+    double handWritten = tokenRate(scanner, input, texts, [&](const std::string & text) {
+      scanner.setInput(text.data(), text.size(), &input);
+    });
+    std::ostringstream report;
+    report.setf(std::ios::fixed);
+    report.precision(0);
+    report << "AslLexer:   " << generated << " tokens/s" << std::endl
+           << "AslScanner: " << handWritten << " tokens/s" << std::endl;
+    report.precision(2);
+    report << "speedup:    " << handWritten / generated << "x" << std::endl;
+    std::cout << report.str();
+    return EXIT_SUCCESS;
+  }
+
+  // the attributes of the nodes kept as TreeDecoration kept them before
+  // they were numbered: in hash maps keyed by the address of the node
+  class HashedDecoration {
+  public:
+    std::size_t setTree(antlr4::tree::ParseTree *tree) { return 0; }
+    SymTable::ScopeId getScope(DecoratedContext *ctx) { return ScopeDecor.get(ctx); }
+    TypesMgr::TypeId getType(DecoratedContext *ctx) { return TypeDecor.get(ctx); }
+    bool getIsLValue(DecoratedContext *ctx) { return IsLValueDecor.get(ctx); }
+    void putScope(DecoratedContext *ctx, SymTable::ScopeId s) { ScopeDecor.put(ctx, s); }
+    void putType(DecoratedContext *ctx, TypesMgr::TypeId t) { TypeDecor.put(ctx, t); }
+    void putIsLValue(DecoratedContext *ctx, bool b) { IsLValueDecor.put(ctx, b); }
+  private:
+    antlr4::tree::ParseTreeProperty<SymTable::ScopeId> ScopeDecor;
+    antlr4::tree::ParseTreeProperty<TypesMgr::TypeId>  TypeDecor;
+    antlr4::tree::ParseTreeProperty<bool>              IsLValueDecor;
+  };
+
+  // a program parsed by AslParser (which owns its tree)
+  struct ParsedFile {
+    antlr4::ANTLRInputStream  input;
+    AslLexer                  lexer;
+    antlr4::CommonTokenStream tokens;
+    AslParser                 parser;
+    antlr4::tree::ParseTree  *tree;
+    std::vector<DecoratedContext *> nodes;
+    ParsedFile(const std::string & text)
+      : input(text), lexer(&input), tokens(&lexer), parser(&tokens) {
+      tree = parser.program();
+    }
+  };
+
+  // add the nodes of the tree 'tree' to 'nodes', in preorder
+  void collectNodes(antlr4::tree::ParseTree *tree, std::vector<DecoratedContext *> & nodes) {
+    DecoratedContext *ctx = dynamic_cast<DecoratedContext *>(tree);
+    if (ctx == nullptr) return;
+    nodes.push_back(ctx);
+    for (auto child : ctx->children) collectNodes(child, nodes);
+  }
+
+  // nanoseconds per node to decorate the trees of 'files' with a new
+  // Decoration for each one, again and again for at least a second: as
+  // the visitors do, the attributes of every node are set, in the order
+  // of the tree, and then read twice. 'checksum' gets a sum of what is
+  // read in the last round
+  template <typename Decoration>
+  double decorationTime(const std::vector<std::unique_ptr<ParsedFile>> & files,
+                        std::size_t & checksum) {
+    std::size_t decorated = 0;
+    std::chrono::duration<double> elapsed(0);
+    auto start = std::chrono::steady_clock::now();
+    while (elapsed.count() < 1.0) {
+      checksum = 0;
+      for (auto & file : files) {
+        Decoration decorations;
+        decorations.setTree(file->tree);
+        for (std::size_t k = 0; k < file->nodes.size(); ++k) {
+          decorations.putScope(file->nodes[k], k % 7);
+          decorations.putType(file->nodes[k], k);
+          decorations.putIsLValue(file->nodes[k], k % 3 == 0);
+        }
+        for (int pass = 0; pass < 2; ++pass)
+          for (auto node : file->nodes)
+            checksum += decorations.getScope(node) + decorations.getType(node) +
+                        decorations.getIsLValue(node);
+        decorated += file->nodes.size();
+      }
+      elapsed = std::chrono::steady_clock::now() - start;
+    }
+    return elapsed.count() * 1e9 / decorated;
+  }
+
+  // benchmark of the tree decorations: time per node to set and get its
+  // attributes with TreeDecoration and with hash maps, over the trees
+  // of the given files
+  int benchDecorations(const std::vector<std::string> & fileNames) {
+    std::vector<std::unique_ptr<ParsedFile>> files;
+    std::size_t nodes = 0;
+    for (auto & fileName : fileNames) {
+      std::string text;
+      if (not readFile(fileName, text)) {
+        std::cout << "No such file: " << fileName << std::endl;
+        return EXIT_FAILURE;
+      }
+      files.emplace_back(new ParsedFile(text));
+      if (files.back()->parser.getNumberOfSyntaxErrors() > 0) {
+        std::cout << "Syntax errors in: " << fileName << std::endl;
+        return EXIT_FAILURE;
+      }
+      collectNodes(files.back()->tree, files.back()->nodes);
+      nodes += files.back()->nodes.size();
+    }
+    std::size_t hashedSum, denseSum;
+    double hashed = decorationTime<HashedDecoration>(files, hashedSum);
+    double dense = decorationTime<TreeDecoration>(files, denseSum);
+    if (hashedSum != denseSum) {
+      std::cout << "Different attributes read from TreeDecoration" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::ostringstream report;
+    report.setf(std::ios::fixed);
+    report.precision(2);
+    report << files.size() << " trees, " << nodes << " nodes" << std::endl
+           << "ParseTreeProperty: " << hashed << " ns/node" << std::endl
+           << "TreeDecoration:    " << dense << " ns/node" << std::endl
+           << "speedup:           " << hashed / dense << "x" << std::endl;
+    std::cout << report.str();
+    return EXIT_SUCCESS;
+  }
+
+}
+
+
+int main(int argc, const char* argv[]) {
+  // check the correct use of the program
+  //   --lex-check   : compare the tokens of both lexers in the given files
+  //   --lex-bench   : tokens per second of both lexers in the given files
+  //   --decor-bench : time to set and get the attributes of the nodes of
+  //                   the trees of the given files, in TreeDecoration and
+  //                   in hash maps
+  std::string mode = argc > 1 ? argv[1] : "";
+  std::vector<std::string> fileNames(argv + (argc > 1 ? 2 : 1), argv + argc);
+  if (fileNames.empty()) mode.clear();
+
+  if (mode == "--lex-check") return checkLexers(fileNames);
+  if (mode == "--lex-bench") return benchLexers(fileNames);
+  if (mode == "--decor-bench") return benchDecorations(fileNames);
+  std::cout << "Usage: ./asltools --lex-check <file>..." << std::endl;
+  std::cout << "       ./asltools --lex-bench <file>..." << std::endl;
+  std::cout << "       ./asltools --decor-bench <file>..." << std::endl;
+  return EXIT_FAILURE;
+}
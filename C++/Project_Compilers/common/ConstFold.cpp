@@ -0,0 +1,283 @@
+/////////////////////////////////////////////////////////////////
+//
+//    ConstFold - constant propagation and folding on t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "ConstFold.h"
+
+#include <cstdint>
+#include <cstdlib>      // strtof
+#include <cstdio>       // snprintf
+#include <cstring>      // memcpy
+#include <cmath>        // isfinite, signbit
+#include <map>
+#include <set>
+#include <utility>
+
+using namespace std;
+
+
+namespace {
+
+  // a known value: the 32 bits of a cell (as in the t-code machine)
+  // and, if it can be written as an immediate, its t-code text
+  struct Value {
+    int32_t bits;
+    operand text;
+  };
+
+  int32_t bits_of(float f) { int32_t i; memcpy(&i, &f, sizeof(i)); return i; }
+  float float_of(int32_t i) { float f; memcpy(&f, &i, sizeof(f)); return f; }
+
+  // value of an immediate operand of a load instruction
+  bool immediate_value(const instruction &ins, Value &v) {
+    const operand & a = ins.arg2;
+    if (a.isTemp() or a.isSymbol() or a.empty()) return false;
+    string s = a.str();
+    v.text = a;
+    if (a.isInt()) {
+      v.bits = ins.oper == instruction::_FLOAD ? bits_of(a.number()) : a.number();
+      return true;
+    }
+    if (s.size() == 3 and s[0] == '\'' and s[2] == '\'') {
+      v.bits = (unsigned char) s[1];
+      return true;
+    }
+    if (s.size() == 4 and s[0] == '\'' and s[1] == '\\' and s[3] == '\'') {
+      char c = s[2] == 'n' ? '\n' : s[2] == 't' ? '\t' : s[2] == 'r' ? '\r' : s[2] == '0' ? '\0' : s[2];
+      v.bits = (unsigned char) c;
+      return true;
+    }
+    if (ins.oper == instruction::_ILOAD or ins.oper == instruction::_CHLOAD) return false;
+    char *end;
+    float f = strtof(s.c_str(), &end);
+    if (*end != '\0') return false;
+    v.bits = bits_of(f);
+    return true;
+  }
+
+  // an integer result (t-code has no negative immediates)
+  Value int_value(int32_t i, nameTable &names) {
+    Value v = {i, operand()};
+    if (i >= 0) v.text = operand(to_string(i), names);
+    return v;
+  }
+
+  // a float result, written with enough digits to be read back exactly
+  Value float_value(float f, nameTable &names) {
+    Value v = {bits_of(f), operand()};
+    if (not std::isfinite(f) or std::signbit(f)) return v;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", f);
+    string s = buf;
+    if (s.find('e') != string::npos) return v;
+    if (s.find('.') == string::npos) s += ".0";
+    v.text = operand(s, names);
+    return v;
+  }
+
+  // evaluate an operation over known operands
+  bool evaluate(const instruction &ins, int32_t b, int32_t c, nameTable &names, Value &v) {
+    uint32_t ub = b, uc = c;
+    float fb = float_of(b), fc = float_of(c);
+    switch (ins.oper) {
+    case instruction::_ADD: v = int_value(int32_t(ub + uc), names); return true;
+    case instruction::_SUB: v = int_value(int32_t(ub - uc), names); return true;
+    case instruction::_MUL: v = int_value(int32_t(ub * uc), names); return true;
+    case instruction::_DIV:
+      if (c == 0) return false;      // keep the runtime error
+      v = int_value(c == -1 ? int32_t(0u - ub) : b / c, names);
+      return true;
+    case instruction::_MOD:
+      if (c == 0) return false;
+      v = int_value(c == -1 ? 0 : b % c, names);
+      return true;
+    case instruction::_EQ:  v = int_value(b == c, names); return true;
+    case instruction::_LT:  v = int_value(b < c, names); return true;
+    case instruction::_LE:  v = int_value(b <= c, names); return true;
+    case instruction::_AND: v = int_value(b and c, names); return true;
+    case instruction::_OR:  v = int_value(b or c, names); return true;
+    case instruction::_NEG: v = int_value(int32_t(0u - ub), names); return true;
+    case instruction::_NOT: v = int_value(not b, names); return true;
+    case instruction::_FLOAT: v = float_value(float(b), names); return true;
+    case instruction::_FADD: v = float_value(fb + fc, names); return true;
+    case instruction::_FSUB: v = float_value(fb - fc, names); return true;
+    case instruction::_FMUL: v = float_value(fb * fc, names); return true;
+    case instruction::_FDIV: v = float_value(fb / fc, names); return true;
+    case instruction::_FEQ:  v = int_value(fb == fc, names); return true;
+    case instruction::_FLT:  v = int_value(fb < fc, names); return true;
+    case instruction::_FLE:  v = int_value(fb <= fc, names); return true;
+    case instruction::_FNEG: v = float_value(-fb, names); return true;
+    default: return false;
+    }
+  }
+
+  bool is_load(instruction::Operation op) {
+    return op == instruction::_LOAD or op == instruction::_ILOAD or
+           op == instruction::_CHLOAD or op == instruction::_FLOAD;
+  }
+
+  bool float_result(instruction::Operation op) {
+    return op == instruction::_FLOAT or op == instruction::_FADD or op == instruction::_FSUB or
+           op == instruction::_FMUL or op == instruction::_FDIV or op == instruction::_FNEG;
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'ConstFold'
+
+ConstFold::ConstFold() : folded(0), branches(0) {}
+
+ConstFold::~ConstFold() {}
+
+size_t ConstFold::get_folded() const { return folded; }
+
+size_t ConstFold::get_branches() const { return branches; }
+
+size_t ConstFold::optimize(subroutine &s) {
+  instructionList code = s.get_instructions();
+  nameTable & names = s.get_names();
+
+  // variables whose address is taken may change through pointers
+  set<operand> escaped;
+  for (auto & ins : code)
+    if (ins.oper == instruction::_ALOAD) escaped.insert(ins.arg2);
+
+  size_t changes = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    // temporaries with a single definition, which is a constant load,
+    // hold that constant everywhere (the code generator defines them
+    // before any use)
+    map<operand, int> defs;
+    for (auto & ins : code)
+      if (ins.defines_arg1() and ins.arg1.isTemp()) ++defs[ins.arg1];
+    map<operand, Value> globals;
+    for (auto & ins : code) {
+      Value v;
+      if (is_load(ins.oper) and defs[ins.arg1] == 1 and immediate_value(ins, v))
+        globals[ins.arg1] = v;
+    }
+
+    // propagation along each basic block
+    map<operand, Value> known = globals;
+    auto value_of = [&](const operand &a, Value &v) {
+      auto it = known.find(a);
+      if (it == known.end()) return false;
+      v = it->second;
+      return true;
+    };
+    vector<bool> removed(code.size(), false);
+    for (size_t i = 0; i < code.size(); ++i) {
+      instruction & ins = code[i];
+      if (ins.oper == instruction::_LABEL) {
+        known = globals;
+        continue;
+      }
+      if (ins.oper == instruction::_FJUMP) {
+        Value cond;
+        if (value_of(ins.arg1, cond)) {
+          if (cond.bits) removed[i] = true;
+          else ins = instruction::UJUMP(ins.arg2);
+          ++branches;  ++changes;  changed = true;
+        }
+        continue;
+      }
+      if (ins.is_compare_jump()) {
+        bool jumpIf;
+        instruction cmp(ins.jump_comparison(jumpIf), operand(), ins.arg1, ins.arg2);
+        Value b, c, cond;
+        if (value_of(ins.arg1, b) and value_of(ins.arg2, c) and
+            evaluate(cmp, b.bits, c.bits, names, cond)) {
+          if (bool(cond.bits) != jumpIf) removed[i] = true;
+          else ins = instruction::UJUMP(ins.arg3);
+          ++branches;  ++changes;  changed = true;
+        }
+        continue;
+      }
+      if (not ins.defines_arg1()) {
+        // a store through a pointer may change any escaped variable
+        if (ins.oper == instruction::_CLOAD or ins.oper == instruction::_XLOAD or
+            ins.oper == instruction::_ACOPY)
+          for (auto & e : escaped) known.erase(e);
+        continue;
+      }
+
+      // compute the value of the definition, if known
+      Value v;
+      bool isKnown = false;
+      if (is_load(ins.oper)) {
+        if (immediate_value(ins, v)) isKnown = true;
+        else if (value_of(ins.arg2, v)) {
+          isKnown = true;
+          // a copy of a known value becomes a load of the constant
+          // (FLOAD would convert an integer text to float)
+          bool isFloatText = v.text.isLiteral() and v.text.str()[0] != '\'';
+          if (not v.text.empty() and (isFloatText or ins.oper != instruction::_FLOAD)) {
+            if (isFloatText) ins.oper = instruction::_FLOAD;
+            else if (v.text.isInt()) ins.oper = instruction::_ILOAD;
+            else ins.oper = instruction::_LOAD;
+            ins.arg2 = v.text;
+            ++folded;  ++changes;  changed = true;
+          }
+        }
+      }
+      else if (ins.is_pure() or ins.oper == instruction::_DIV or ins.oper == instruction::_MOD) {
+        unsigned used = ins.used_args();
+        Value b = {0, operand()}, c = {0, operand()};
+        bool args = ((used & instruction::ARG2) == 0 or value_of(ins.arg2, b)) and
+                    ((used & instruction::ARG3) == 0 or value_of(ins.arg3, c));
+        if ((used & instruction::ARG2) and args and evaluate(ins, b.bits, c.bits, names, v)) {
+          isKnown = true;
+          if (not v.text.empty()) {
+            if (float_result(ins.oper)) ins = instruction::FLOAD(ins.arg1, v.text);
+            else ins = instruction::ILOAD(ins.arg1, v.text);
+            ++folded;  ++changes;  changed = true;
+          }
+        }
+      }
+
+      if (escaped.count(ins.arg1)) known.erase(ins.arg1);
+      else if (isKnown) known[ins.arg1] = v;
+      else known.erase(ins.arg1);
+    }
+
+    if (changed) {
+      instructionList kept;
+      kept.reserve(code.size());
+      for (size_t i = 0; i < code.size(); ++i)
+        if (not removed[i]) kept.push_back(std::move(code[i]));
+      code = std::move(kept);
+    }
+  }
+
+  s.set_instructions(std::move(code));
+  return changes;
+}
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////
+//
+//    ConstFold - constant propagation and folding on t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class ConstFold propagates the constants loaded with ILOAD, FLOAD,
+/// CHLOAD and LOAD through temporaries and variables, evaluates the
+/// operations whose operands are all known, and resolves the
+/// conditional jumps on a known condition or known operands.
+///
+/// Values are propagated inside each basic block, and across blocks
+/// for temporaries with a single definition. Results that t-code cannot
+/// write as an immediate (negative numbers, inf, nan) are propagated
+/// but the instruction computing them is kept.
+
+class ConstFold {
+public:
+  /// constructor and destructor
+  ConstFold();
+  ~ConstFold();
+
+  /// optimize a subroutine. Returns the number of changed instructions
+  std::size_t optimize(subroutine &s);
+
+  /// operations replaced by a constant so far
+  std::size_t get_folded() const;
+  /// conditional jumps resolved so far
+  std::size_t get_branches() const;
+
+private:
+  std::size_t folded, branches;
+};
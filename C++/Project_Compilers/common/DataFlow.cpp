@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////
+//
+//    DataFlow - iterative dataflow analysis over a FlowGraph
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "DataFlow.h"
+
+#include <deque>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'BitSet'
+
+BitSet::BitSet(size_t n) : words((n + 63) / 64, 0), nBits(n) {}
+
+size_t BitSet::size() const { return nBits; }
+
+bool BitSet::test(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+void BitSet::set(size_t i) { words[i / 64] |= uint64_t(1) << (i % 64); }
+
+void BitSet::reset(size_t i) { words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+void BitSet::fill(bool value) {
+  for (auto & w : words) w = value ? ~uint64_t(0) : 0;
+  // keep the unused bits of the last word clear, so that == works
+  if (value and nBits % 64) words.back() &= (uint64_t(1) << (nBits % 64)) - 1;
+}
+
+void BitSet::unite(const BitSet &other) {
+  for (size_t w = 0; w < words.size(); ++w) words[w] |= other.words[w];
+}
+
+void BitSet::intersect(const BitSet &other) {
+  for (size_t w = 0; w < words.size(); ++w) words[w] &= other.words[w];
+}
+
+void BitSet::subtract(const BitSet &other) {
+  for (size_t w = 0; w < words.size(); ++w) words[w] &= ~other.words[w];
+}
+
+bool BitSet::operator==(const BitSet &other) const { return words == other.words; }
+
+bool BitSet::operator!=(const BitSet &other) const { return words != other.words; }
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'DataFlow'
+
+DataFlow::DataFlow(const FlowGraph &g, Direction d, Meet m, size_t nBits) :
+  graph(g), gen(g.size(), BitSet(nBits)), kill(g.size(), BitSet(nBits)), boundary(nBits),
+  dir(d), meet(m), in(g.size(), BitSet(nBits)), out(g.size(), BitSet(nBits)) {}
+
+DataFlow::~DataFlow() {}
+
+const BitSet & DataFlow::get_in(size_t b) const { return in[b]; }
+
+const BitSet & DataFlow::get_out(size_t b) const { return out[b]; }
+
+void DataFlow::solve() {
+  size_t n = graph.size();
+  // with intersection, start from the full set (except at the boundary)
+  for (size_t b = 0; b < n; ++b) {
+    in[b].fill(meet == INTERSECTION);
+    out[b].fill(meet == INTERSECTION);
+  }
+
+  // postorder suits backward problems, reverse postorder forward ones.
+  // Unreachable blocks are solved too, after the rest
+  vector<size_t> order = graph.postorder();
+  vector<bool> queued(n, false);
+  for (size_t b : order) queued[b] = true;
+  for (size_t b = 0; b < n; ++b)
+    if (not queued[b]) order.push_back(b);
+  if (dir == FORWARD) order.assign(order.rbegin(), order.rend());
+  deque<size_t> work(order.begin(), order.end());
+  queued.assign(n, true);
+
+  BitSet joined(boundary.size());
+  while (not work.empty()) {
+    size_t b = work.front();
+    work.pop_front();
+    queued[b] = false;
+    const FlowGraph::BasicBlock & blk = graph.block(b);
+    // blocks the value comes from, and blocks to update if it changes
+    const vector<size_t> & sources = dir == FORWARD ? blk.preds : blk.succs;
+    const vector<size_t> & targets = dir == FORWARD ? blk.succs : blk.preds;
+    vector<BitSet> & before = dir == FORWARD ? in : out;
+    vector<BitSet> & after = dir == FORWARD ? out : in;
+
+    bool isBoundary = dir == FORWARD ? b == 0 : sources.empty();
+    if (isBoundary) joined = boundary;
+    else joined.fill(meet == INTERSECTION);
+    for (size_t s : sources) {
+      const BitSet & v = dir == FORWARD ? out[s] : in[s];
+      if (meet == UNION) joined.unite(v);
+      else joined.intersect(v);
+    }
+    before[b] = joined;
+    joined.subtract(kill[b]);
+    joined.unite(gen[b]);
+    if (joined == after[b]) continue;
+    after[b] = joined;
+    for (size_t t : targets)
+      if (not queued[t]) {
+        queued[t] = true;
+        work.push_back(t);
+      }
+  }
+}
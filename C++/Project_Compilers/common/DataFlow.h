@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////
+//
+//    DataFlow - iterative dataflow analysis over a FlowGraph
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FlowGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class BitSet is a fixed-size set of small integers
+
+class BitSet {
+public:
+  /// constructor: an empty set for elements 0..n-1
+  explicit BitSet(std::size_t n = 0);
+
+  std::size_t size() const;
+  bool test(std::size_t i) const;
+  void set(std::size_t i);
+  void reset(std::size_t i);
+  /// make it the empty or the full set
+  void fill(bool value);
+  /// union, intersection and difference in place
+  void unite(const BitSet &other);
+  void intersect(const BitSet &other);
+  void subtract(const BitSet &other);
+  bool operator==(const BitSet &other) const;
+  bool operator!=(const BitSet &other) const;
+
+private:
+  std::vector<uint64_t> words;
+  std::size_t nBits;
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// Class DataFlow solves a gen/kill bit-vector problem over the blocks
+/// of a FlowGraph with a worklist:
+///    forward:  in = meet(out of preds),  out = gen U (in - kill)
+///    backward: out = meet(in of succs),  in = gen U (out - kill)
+/// Subclasses fill gen, kill and boundary (the value at the entry for
+/// forward problems, at the exits for backward ones) before solve().
+
+class DataFlow {
+public:
+  typedef enum {FORWARD, BACKWARD} Direction;
+  typedef enum {UNION, INTERSECTION} Meet;
+
+  /// constructor and destructor
+  DataFlow(const FlowGraph &g, Direction d, Meet m, std::size_t nBits);
+  virtual ~DataFlow();
+
+  /// compute the fixed point
+  void solve();
+  /// value at the entry and at the exit of a block
+  const BitSet & get_in(std::size_t b) const;
+  const BitSet & get_out(std::size_t b) const;
+
+protected:
+  const FlowGraph & graph;
+  std::vector<BitSet> gen, kill;
+  BitSet boundary;
+
+private:
+  Direction dir;
+  Meet meet;
+  std::vector<BitSet> in, out;
+};
@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////
+//
+//    DeadCode - removal of useless t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "DeadCode.h"
+#include "FlowGraph.h"
+#include "Liveness.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'DeadCode'
+
+DeadCode::DeadCode() : threaded(0), unreachable(0), deadTemps(0), deadStores(0) {}
+
+DeadCode::~DeadCode() {}
+
+size_t DeadCode::get_threaded() const { return threaded; }
+size_t DeadCode::get_unreachable() const { return unreachable; }
+size_t DeadCode::get_dead_temps() const { return deadTemps; }
+size_t DeadCode::get_dead_stores() const { return deadStores; }
+
+size_t DeadCode::optimize(subroutine &s) {
+  instructionList code = s.get_instructions();
+  size_t changes = thread_jumps(code);
+  changes += remove_unreachable(code);
+  changes += remove_dead_defs(code);
+  if (changes > 0) s.set_instructions(std::move(code));
+  return changes;
+}
+
+size_t DeadCode::thread_jumps(instructionList &code) {
+  map<operand, size_t> labelPc;
+  for (size_t pc = 0; pc < code.size(); ++pc)
+    if (code[pc].oper == instruction::_LABEL) labelPc[code[pc].arg1] = pc;
+
+  // final destination of a jump to a label, following gotos
+  auto destination = [&](const operand &label) {
+    operand dest = label;
+    for (size_t steps = 0; steps < code.size(); ++steps) {   // bounded: goto cycles
+      auto it = labelPc.find(dest);
+      if (it == labelPc.end()) break;
+      size_t pc = it->second;
+      while (pc < code.size() and code[pc].oper == instruction::_LABEL) ++pc;
+      if (pc == code.size() or code[pc].oper != instruction::_UJUMP) break;
+      dest = code[pc].arg1;
+    }
+    return dest;
+  };
+
+  size_t n = 0;
+  for (auto & ins : code) {
+    if (not ins.is_jump()) continue;
+    operand dest = destination(ins.jump_target());
+    if (dest == ins.jump_target()) continue;
+    ins.jump_target() = dest;
+    ++n;
+  }
+  threaded += n;
+  return n;
+}
+
+size_t DeadCode::remove_unreachable(instructionList &code) {
+  FlowGraph graph(code);
+  vector<bool> reached = graph.reachable();
+  size_t n = 0;
+  instructionList kept;
+  kept.reserve(code.size());
+  for (size_t pc = 0; pc < code.size(); ++pc) {
+    if (reached[graph.block_of(pc)]) kept.push_back(std::move(code[pc]));
+    else ++n;
+  }
+  code = std::move(kept);
+  unreachable += n;
+  return n;
+}
+
+size_t DeadCode::remove_dead_defs(instructionList &code) {
+  FlowGraph graph(code);
+  Liveness live(graph);
+  vector<bool> removed(code.size(), false);
+  size_t n = 0;
+  vector<size_t> uses;
+  size_t def;
+  for (size_t b = 0; b < graph.size(); ++b) {
+    const FlowGraph::BasicBlock & blk = graph.block(b);
+    BitSet alive = live.get_out(b);
+    for (size_t pc = blk.last; pc-- > blk.first; ) {
+      instruction & ins = code[pc];
+      live.uses_and_def(ins, uses, def);
+      if (def != Liveness::NONE and not alive.test(def) and
+          (ins.is_pure() or ins.oper == instruction::_POP)) {   // reads and divisions stay
+        ++(ins.arg1.isTemp() ? deadTemps : deadStores);
+        ++n;
+        if (ins.oper == instruction::_POP) ins.arg1 = operand();  // keep the pop, drop the value
+        else {
+          removed[pc] = true;
+          continue;
+        }
+      }
+      if (def != Liveness::NONE) alive.reset(def);
+      for (size_t u : uses) alive.set(u);
+    }
+  }
+  if (n == 0) return 0;
+  instructionList kept;
+  kept.reserve(code.size());
+  for (size_t pc = 0; pc < code.size(); ++pc)
+    if (not removed[pc]) kept.push_back(std::move(code[pc]));
+  code = std::move(kept);
+  return n;
+}
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////
+//
+//    DeadCode - removal of useless t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class DeadCode cleans a subroutine using its FlowGraph:
+///   - jump threading: a jump to a goto jumps directly to its target
+///   - unreachable blocks are removed
+///   - with Liveness, pure definitions of temporaries and variables
+///     that are never read afterwards are removed
+
+class DeadCode {
+public:
+  /// constructor and destructor
+  DeadCode();
+  ~DeadCode();
+
+  /// optimize a subroutine. Returns the number of changed instructions
+  std::size_t optimize(subroutine &s);
+
+  /// statistics so far
+  std::size_t get_threaded() const;
+  std::size_t get_unreachable() const;
+  std::size_t get_dead_temps() const;
+  std::size_t get_dead_stores() const;
+
+private:
+  std::size_t threaded, unreachable, deadTemps, deadStores;
+
+  /// each pass returns the number of changed instructions
+  std::size_t thread_jumps(instructionList &code);
+  std::size_t remove_unreachable(instructionList &code);
+  std::size_t remove_dead_defs(instructionList &code);
+};
@@ -0,0 +1,50 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    DecoratedContext - Parser tree nodes with a dense index
+//                       for their attributes
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "DecoratedContext.h"
+
+#include "antlr4-runtime.h"
+
+#include <cstddef>
+
+
+const std::size_t DecoratedContext::NO_INDEX;
+
+DecoratedContext::DecoratedContext(antlr4::ParserRuleContext *parent,
+                                   std::size_t invokingState)
+  : antlr4::ParserRuleContext(parent, invokingState) {
+}
+
+std::size_t DecoratedContext::getDecorIndex() const {
+  return DecorIndex;
+}
+
+void DecoratedContext::setDecorIndex(std::size_t index) {
+  DecorIndex = index;
+}
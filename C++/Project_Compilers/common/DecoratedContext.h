@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    DecoratedContext - Parser tree nodes with a dense index
+//                       for their attributes
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <cstddef>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class DecoratedContext: the base class of all the nodes (contexts)
+// of the parser tree generated by the antlr4 parser (it is the
+// contextSuperClass of the grammar). Each node has an index, dense
+// within its tree, that TreeDecoration assigns after the parse and uses
+// to keep the attributes of the node in plain vectors, instead of hash
+// maps keyed by the address of the node.
+
+class DecoratedContext : public antlr4::ParserRuleContext {
+
+public:
+  // Index of a node that has not been numbered yet
+  static const std::size_t NO_INDEX = ~std::size_t(0);
+
+  // Constructors (those of antlr4::ParserRuleContext)
+  DecoratedContext() = default;
+  DecoratedContext(antlr4::ParserRuleContext *parent, std::size_t invokingState);
+
+  // Index of the node for its attributes
+  std::size_t getDecorIndex() const;
+  void        setDecorIndex(std::size_t index);
+
+private:
+  std::size_t DecorIndex = NO_INDEX;
+
+};  // class DecoratedContext
@@ -0,0 +1,170 @@
+/////////////////////////////////////////////////////////////////
+//
+//    FlowGraph - basic blocks of a subroutine
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "FlowGraph.h"
+
+#include <utility>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'FlowGraph'
+
+const size_t FlowGraph::NONE;
+
+FlowGraph::FlowGraph(const instructionList &c) : code(c), blockOf(c.size(), NONE) {
+  // leaders: the first instruction, labels, and instructions after a jump or return
+  for (size_t pc = 0; pc < code.size(); ++pc) {
+    const instruction & ins = code[pc];
+    bool leader = pc == 0 or ins.oper == instruction::_LABEL;
+    if (pc > 0) {
+      const instruction & prev = code[pc-1];
+      leader = leader or prev.is_jump() or prev.oper == instruction::_RETURN;
+    }
+    if (leader) {
+      if (not blocks.empty()) blocks.back().last = pc;
+      blocks.push_back(BasicBlock{pc, code.size(), {}, {}});
+    }
+    blockOf[pc] = blocks.size() - 1;
+    if (ins.oper == instruction::_LABEL) labels[ins.arg1] = blocks.size() - 1;
+  }
+
+  // edges
+  auto link = [&](size_t from, size_t to) {
+    if (to == NONE) return;
+    blocks[from].succs.push_back(to);
+    blocks[to].preds.push_back(from);
+  };
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    const instruction & ins = code[blocks[b].last - 1];
+    bool fallsThrough = ins.oper != instruction::_UJUMP and ins.oper != instruction::_RETURN;
+    if (ins.is_jump()) link(b, label_block(ins.jump_target()));
+    if (fallsThrough and b+1 < blocks.size()) {
+      // a conditional jump to the next block gives a single edge
+      if (blocks[b].succs.empty() or blocks[b].succs.back() != b+1) link(b, b+1);
+    }
+  }
+}
+
+FlowGraph::~FlowGraph() {}
+
+const instructionList & FlowGraph::get_code() const { return code; }
+
+size_t FlowGraph::size() const { return blocks.size(); }
+
+const FlowGraph::BasicBlock & FlowGraph::block(size_t b) const { return blocks[b]; }
+
+size_t FlowGraph::block_of(size_t pc) const { return blockOf[pc]; }
+
+size_t FlowGraph::label_block(const operand &label) const {
+  auto it = labels.find(label);
+  return it == labels.end() ? NONE : it->second;
+}
+
+vector<bool> FlowGraph::reachable() const {
+  vector<bool> seen(blocks.size(), false);
+  if (blocks.empty()) return seen;
+  vector<size_t> pending = {0};
+  seen[0] = true;
+  while (not pending.empty()) {
+    size_t b = pending.back();
+    pending.pop_back();
+    for (size_t s : blocks[b].succs)
+      if (not seen[s]) {
+        seen[s] = true;
+        pending.push_back(s);
+      }
+  }
+  return seen;
+}
+
+vector<size_t> FlowGraph::postorder() const {
+  vector<size_t> order;
+  if (blocks.empty()) return order;
+  // iterative depth-first search: (block, next successor to visit)
+  vector<bool> seen(blocks.size(), false);
+  vector<pair<size_t, size_t>> stack = {{0, 0}};
+  seen[0] = true;
+  while (not stack.empty()) {
+    size_t b = stack.back().first;
+    size_t & next = stack.back().second;
+    if (next < blocks[b].succs.size()) {
+      size_t s = blocks[b].succs[next++];
+      if (not seen[s]) {
+        seen[s] = true;
+        stack.push_back({s, 0});
+      }
+    }
+    else {
+      order.push_back(b);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+vector<size_t> FlowGraph::dominators() const {
+  vector<size_t> idom(blocks.size(), NONE);
+  if (blocks.empty()) return idom;
+  // iterative algorithm of Cooper, Harvey and Kennedy, in reverse postorder
+  vector<size_t> order = postorder();
+  vector<size_t> number(blocks.size(), NONE);
+  for (size_t i = 0; i < order.size(); ++i) number[order[i]] = i;
+  auto intersect = [&](size_t a, size_t b) {
+    while (a != b) {
+      while (number[a] < number[b]) a = idom[a];
+      while (number[b] < number[a]) b = idom[b];
+    }
+    return a;
+  };
+  idom[0] = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      if (*it == 0) continue;
+      size_t newIdom = NONE;
+      for (size_t p : blocks[*it].preds) {
+        if (idom[p] == NONE) continue;
+        newIdom = newIdom == NONE ? p : intersect(p, newIdom);
+      }
+      if (idom[*it] != newIdom) {
+        idom[*it] = newIdom;
+        changed = true;
+      }
+    }
+  }
+  return idom;
+}
+
+bool FlowGraph::dominates(size_t a, size_t b, const vector<size_t> &idom) {
+  if (idom[b] == NONE) return false;
+  while (b != a and b != 0) b = idom[b];
+  return b == a;
+}
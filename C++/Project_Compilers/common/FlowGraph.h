@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////
+//
+//    FlowGraph - basic blocks of a subroutine
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class FlowGraph splits an instruction list in basic blocks and
+/// links them with the possible transfers of control. Block 0 is the
+/// entry. A block ends after a jump or a return, and starts at every
+/// label; a return (or a jump to an unknown label) has no successor.
+
+class FlowGraph {
+public:
+  /// a basic block: instructions [first, last) of the list
+  struct BasicBlock {
+    std::size_t first, last;
+    std::vector<std::size_t> succs, preds;
+  };
+  /// value returned for "no block"
+  static const std::size_t NONE = std::size_t(-1);
+
+  /// build the graph of a list (which must outlive the graph)
+  explicit FlowGraph(const instructionList &code);
+  ~FlowGraph();
+
+  /// instructions the graph was built from
+  const instructionList & get_code() const;
+  /// number of blocks
+  std::size_t size() const;
+  /// a block
+  const BasicBlock & block(std::size_t b) const;
+  /// block an instruction belongs to
+  std::size_t block_of(std::size_t pc) const;
+  /// block starting with a label (NONE if it is not defined)
+  std::size_t label_block(const operand &label) const;
+  /// blocks reachable from the entry
+  std::vector<bool> reachable() const;
+  /// reachable blocks, each one after all its successors (except
+  /// on back edges): the best order for backward dataflow problems
+  std::vector<std::size_t> postorder() const;
+  /// immediate dominator of each block (the entry is its own one, and
+  /// unreachable blocks have NONE)
+  std::vector<std::size_t> dominators() const;
+  /// does block a dominate block b, given the immediate dominators?
+  static bool dominates(std::size_t a, std::size_t b, const std::vector<std::size_t> &idom);
+
+private:
+  const instructionList & code;
+  std::vector<BasicBlock> blocks;
+  std::vector<std::size_t> blockOf;
+  std::map<operand, std::size_t> labels;
+};
@@ -0,0 +1,342 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Inliner - inlining of small subroutines in t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Inliner.h"
+
+#include <set>
+#include <utility>
+
+using namespace std;
+
+
+namespace {
+
+  // a caller may grow by inlining up to this factor of its size, plus
+  // a constant so that tiny callers can still get their calls inlined
+  const size_t GROWTH_FACTOR = 4, GROWTH_SLACK = 64;
+
+  // size of some code for the cost model (labels are free)
+  size_t cost(const instructionList &code) {
+    size_t n = 0;
+    for (auto & ins : code)
+      if (ins.oper != instruction::_LABEL) ++n;
+    return n;
+  }
+
+  int max_temp(const instructionList &code) {
+    int maxTemp = 0;
+    for (auto & ins : code)
+      for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+        if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+    return maxTemp;
+  }
+
+  // names used as arrays or whose address is taken: they must stay in
+  // memory, they cannot become temporaries
+  set<string> memory_names(const instructionList &code) {
+    set<string> names;
+    for (auto & ins : code) {
+      if (ins.oper == instruction::_XLOAD and ins.arg1.isSymbol()) names.insert(ins.arg1.str());
+      if (ins.oper == instruction::_LOADX and ins.arg2.isSymbol()) names.insert(ins.arg2.str());
+      if (ins.oper == instruction::_ALOAD and ins.arg2.isSymbol()) names.insert(ins.arg2.str());
+      if (ins.oper == instruction::_ACOPY) {
+        if (ins.arg1.isSymbol()) names.insert(ins.arg1.str());
+        if (ins.arg2.isSymbol()) names.insert(ins.arg2.str());
+      }
+    }
+    return names;
+  }
+
+  // does the instruction read the variable 'name'?
+  bool uses(const instruction &ins, const string &name) {
+    return (ins.arg1.isSymbol() and ins.arg1.str() == name and not ins.defines_arg1()) or
+           (ins.arg2.isSymbol() and ins.arg2.str() == name) or
+           (ins.arg3.isSymbol() and ins.arg3.str() == name);
+  }
+
+  // can the variable 'name' of some code become a temporary? Peephole
+  // and ConstFold take a temporary to have the same value wherever it is
+  // used, so it must have a single definition that runs before each of
+  // its uses (and, with 'atExit', before each return, as the result of
+  // the callee is used after it). It is so if no use can be reached from
+  // the start of the code without going through the definition
+  bool single_dominating_def(const instructionList &code, const string &name, bool atExit) {
+    size_t def = code.size();
+    for (size_t i = 0; i < code.size(); ++i) {
+      if (not (code[i].defines_arg1() and code[i].arg1.isSymbol() and code[i].arg1.str() == name))
+        continue;
+      if (def != code.size()) return false;
+      def = i;
+    }
+    if (def == code.size()) return false;
+
+    map<string, size_t> labels;
+    for (size_t i = 0; i < code.size(); ++i)
+      if (code[i].oper == instruction::_LABEL) labels[code[i].arg1.str()] = i;
+    vector<bool> reached(code.size(), false);
+    vector<size_t> pending(1, 0);
+    reached[0] = true;
+    auto reach = [&](size_t i) {
+      if (i < code.size() and not reached[i]) {
+        reached[i] = true;
+        pending.push_back(i);
+      }
+    };
+    while (not pending.empty()) {
+      size_t i = pending.back();
+      pending.pop_back();
+      const instruction & ins = code[i];
+      if (uses(ins, name) or (atExit and ins.oper == instruction::_RETURN)) return false;
+      if (i == def or ins.oper == instruction::_RETURN) continue;
+      if (ins.is_jump()) {
+        auto l = labels.find(ins.jump_target().str());
+        if (l != labels.end()) reach(l->second);
+      }
+      if (ins.oper != instruction::_UJUMP) reach(i+1);
+    }
+    return true;
+  }
+
+  // does the code write the variable 'name'?
+  bool is_defined(const instructionList &code, const string &name) {
+    for (auto & ins : code)
+      if (ins.defines_arg1() and ins.arg1.isSymbol() and ins.arg1.str() == name) return true;
+    return false;
+  }
+
+  bool has_result(const subroutine &s) {
+    return not s.params.empty() and s.params.front().name == "_result";
+  }
+
+  // does 'from' reach 'to' in the call graph?
+  bool reaches(size_t from, size_t to, const vector<vector<size_t>> &calls) {
+    vector<bool> seen(calls.size(), false);
+    vector<size_t> pending(1, from);
+    while (not pending.empty()) {
+      size_t f = pending.back();
+      pending.pop_back();
+      for (size_t g : calls[f]) {
+        if (g == to) return true;
+        if (not seen[g]) {
+          seen[g] = true;
+          pending.push_back(g);
+        }
+      }
+    }
+    return false;
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'Inliner'
+
+Inliner::Inliner(size_t maxSize) : maxSize(maxSize), inlined(0), nCopies(0) {}
+
+Inliner::~Inliner() {}
+
+size_t Inliner::get_inlined() const { return inlined; }
+
+vector<Inliner::CallSite> Inliner::call_sites(const instructionList &code) {
+  vector<CallSite> sites;
+  vector<size_t> pending;
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (code[i].oper == instruction::_PUSH) pending.push_back(i);
+    else if (code[i].oper == instruction::_CALL) {
+      CallSite site;
+      site.call = i;
+      size_t j = i+1;
+      while (j < code.size() and code[j].oper == instruction::_POP) ++j;
+      site.nPops = j-i-1;
+      if (site.nPops == 0 or site.nPops > pending.size()) return vector<CallSite>();
+      site.pushes.assign(pending.end() - site.nPops, pending.end());
+      pending.resize(pending.size() - site.nPops);
+      sites.push_back(std::move(site));
+      i = j-1;
+    }
+  }
+  return sites;
+}
+
+size_t Inliner::optimize(code &c) {
+  size_t initial = inlined;
+  vector<subroutine> & subs = c.get_subroutine_list();
+  map<string, size_t> index;
+  for (size_t f = 0; f < subs.size(); ++f) index[subs[f].get_name()] = f;
+
+  // call graph
+  vector<vector<size_t>> calls(subs.size());
+  for (size_t f = 0; f < subs.size(); ++f)
+    for (auto & ins : subs[f].get_instructions()) {
+      if (ins.oper != instruction::_CALL) continue;
+      auto it = index.find(ins.arg1.str());
+      if (it != index.end()) calls[f].push_back(it->second);
+    }
+
+  // candidates: not recursive, and no address taken of a parameter
+  // (array parameters hold an address, so they can be temporaries)
+  vector<bool> inlinable(subs.size());
+  for (size_t f = 0; f < subs.size(); ++f) {
+    inlinable[f] = not reaches(f, f, calls);
+    set<string> params;
+    for (auto & p : subs[f].params) params.insert(p.name);
+    for (auto & ins : subs[f].get_instructions())
+      if (ins.oper == instruction::_ALOAD and params.count(ins.arg2.str())) inlinable[f] = false;
+  }
+
+  // callees first, so that what they call is already inlined in them
+  vector<size_t> order;
+  vector<bool> visited(subs.size(), false);
+  for (size_t root = 0; root < subs.size(); ++root) {
+    if (visited[root]) continue;
+    visited[root] = true;
+    vector<pair<size_t, size_t>> stack(1, make_pair(root, size_t(0)));
+    while (not stack.empty()) {
+      size_t f = stack.back().first;
+      size_t & next = stack.back().second;
+      if (next < calls[f].size()) {
+        size_t g = calls[f][next++];
+        if (not visited[g]) {
+          visited[g] = true;
+          stack.push_back(make_pair(g, size_t(0)));
+        }
+      }
+      else {
+        order.push_back(f);
+        stack.pop_back();
+      }
+    }
+  }
+  for (size_t f : order) inline_calls(subs[f], subs, index, inlinable);
+  return inlined - initial;
+}
+
+void Inliner::inline_calls(subroutine &caller, const vector<subroutine> &subs,
+                           const map<string, size_t> &index,
+                           const vector<bool> &inlinable) {
+  const instructionList & code = caller.get_instructions();
+  nameTable & names = caller.get_names();
+  size_t size = cost(code);
+  const size_t limit = GROWTH_FACTOR * size + GROWTH_SLACK;
+  int nextTemp = max_temp(code);
+
+  // new code for the instructions of the inlined calls
+  vector<bool> replaced(code.size(), false);
+  vector<instructionList> replacement(code.size());
+  bool changed = false;
+
+  for (const CallSite & site : call_sites(code)) {
+    auto it = index.find(code[site.call].arg1.str());
+    if (it == index.end() or not inlinable[it->second]) continue;
+    const subroutine & callee = subs[it->second];
+    const instructionList & body = callee.get_instructions();
+    size_t nArgs = callee.params.size() - (has_result(callee) ? 1 : 0);
+    if (site.nPops != nArgs+1 or not code[site.pushes[0]].arg1.empty()) continue;
+    size_t bodyCost = cost(body);
+    if (bodyCost > maxSize or size + bodyCost > limit) continue;
+    size += bodyCost;
+
+    // names of the copy start with "_<copy number>_", which no ASL
+    // identifier nor label of CodeGenVisitor can clash with
+    string prefix = "_" + to_string(++nCopies) + "_";
+    // the names of the callee that cannot become temporaries become
+    // variables of the caller
+    map<string, operand> rename;
+    auto as_variable = [&](const string &name, size_t size) {
+      caller.add_var(prefix + name, size);
+      return rename[name] = operand(prefix + name, names);
+    };
+    auto p = callee.params.begin();
+    operand result, resultVar;
+    if (has_result(callee)) {
+      result = code[site.call + site.nPops].arg1;
+      if (result.empty()) result = operand::temp(++nextTemp);
+      if (single_dominating_def(body, p->name, true)) rename[p->name] = result;
+      else resultVar = as_variable(p->name, 1);
+      ++p;
+    }
+    // the arguments are copied where they were pushed (to a temporary,
+    // unless the callee writes the parameter)
+    replaced[site.pushes[0]] = true;
+    for (size_t a = 1; a < site.pushes.size(); ++a, ++p) {
+      operand param;
+      if (is_defined(body, p->name)) param = as_variable(p->name, 1);
+      else param = rename[p->name] = operand::temp(++nextTemp);
+      replaced[site.pushes[a]] = true;
+      replacement[site.pushes[a]] = instruction::LOAD(param, code[site.pushes[a]].arg1);
+    }
+    set<string> inMemory = memory_names(body);
+    for (auto & v : callee.vars) {
+      if (v.size == 1 and inMemory.count(v.name) == 0 and single_dominating_def(body, v.name, false))
+        rename[v.name] = operand::temp(++nextTemp);
+      else as_variable(v.name, v.size);
+    }
+    int tempBase = nextTemp;
+    nextTemp += max_temp(body);
+
+    // the body, with returns turned into jumps to its end
+    operand end(prefix, names);
+    instructionList copy;
+    copy.reserve(body.size() + 1);
+    for (instruction ins : body) {
+      if (ins.oper == instruction::_RETURN) {
+        copy.push_back(instruction::UJUMP(end));
+        continue;
+      }
+      operand * label = nullptr;
+      if (ins.oper == instruction::_LABEL) label = &ins.arg1;
+      else if (ins.is_jump()) label = &ins.jump_target();
+      for (operand *a : {&ins.arg1, &ins.arg2, &ins.arg3}) {
+        if (a->isTemp()) *a = operand::temp(tempBase + a->number());
+        else if (a == label) *a = operand(prefix + a->str(), names);
+        else if (ins.oper == instruction::_CALL) *a = operand(a->str(), names);
+        else if (a->isSymbol() or a->isLiteral()) {
+          auto r = rename.find(a->str());
+          *a = r != rename.end() ? r->second : operand(a->str(), names);
+        }
+      }
+      copy.push_back(ins);
+    }
+    copy.push_back(instruction::LABEL(end));
+    if (not resultVar.empty()) copy.push_back(instruction::LOAD(result, resultVar));
+    replaced[site.call] = true;
+    replacement[site.call] = std::move(copy);
+    for (size_t i = 1; i <= site.nPops; ++i) replaced[site.call + i] = true;
+    ++inlined;
+    changed = true;
+  }
+
+  if (not changed) return;
+  instructionList result;
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (not replaced[i]) result.push_back(code[i]);
+    else for (auto & ins : replacement[i]) result.push_back(std::move(ins));
+  }
+  caller.set_instructions(std::move(result));
+}
@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Inliner - inlining of small subroutines in t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class Inliner replaces calls to small non-recursive subroutines
+/// with a copy of their code. The parameters, local variables and
+/// temporaries of the callee are renamed into the caller, and the
+/// result goes directly to the temporary the call was popped into.
+/// Scalars become temporaries only if that keeps temporaries defined
+/// once, before all their uses (parameters not written by the callee,
+/// locals with a single definition that reaches every use); the rest
+/// become variables of the caller. Array parameters still hold the
+/// address of the caller's array, so they keep their by-reference
+/// semantics.
+
+class Inliner {
+public:
+  /// a call as generated by CodeGenVisitor: a push making room for the
+  /// result, a push per argument, the call, a pop per argument and the
+  /// pop of the result (given as positions in an instruction list)
+  struct CallSite {
+    std::vector<std::size_t> pushes;
+    std::size_t call;
+    std::size_t nPops;
+  };
+
+  /// constructor and destructor. Callees with more than maxSize
+  /// instructions (labels excluded) are never inlined
+  Inliner(std::size_t maxSize = 24);
+  ~Inliner();
+
+  /// inline the calls of all the subroutines of a program. Returns the
+  /// number of inlined calls
+  std::size_t optimize(code &c);
+
+  /// calls inlined so far
+  std::size_t get_inlined() const;
+
+  /// the calls of some code, each with its pushes (which may be mixed
+  /// with the evaluation of the arguments, including other calls).
+  /// Empty if the pushes and pops do not match
+  static std::vector<CallSite> call_sites(const instructionList &code);
+
+private:
+  std::size_t maxSize;
+  std::size_t inlined;
+  /// number of the next inlined copy (to build unique names)
+  int nCopies;
+
+  /// inline the suitable calls of subroutine 'caller'
+  void inline_calls(subroutine &caller, const std::vector<subroutine> &subs,
+                    const std::map<std::string, std::size_t> &index,
+                    const std::vector<bool> &inlinable);
+};
@@ -90,6 +90,7 @@ const std::map<instruction::Operation, std::string> LLVMCodeGen::tcode2llvmInstr
   { instruction::_SUB,  "sub" },
   { instruction::_MUL,  "mul" },
   { instruction::_DIV,  "sdiv" },
+  { instruction::_MOD,  "srem" },
   { instruction::_FADD, "fadd" },
   { instruction::_FSUB, "fsub" },
   { instruction::_FMUL, "fmul" },
@@ -100,6 +101,18 @@ const std::map<instruction::Operation, std::string> LLVMCodeGen::tcode2llvmInstr
   { instruction::_FEQ,  "fcmp oeq" },
   { instruction::_FLT,  "fcmp olt" },
   { instruction::_FLE,  "fcmp ole" },
+  { instruction::_JEQ,   "icmp eq" },
+  { instruction::_JLT,   "icmp slt" },
+  { instruction::_JLE,   "icmp sle" },
+  { instruction::_JNEQ,  "icmp ne" },
+  { instruction::_JNLT,  "icmp sge" },
+  { instruction::_JNLE,  "icmp sgt" },
+  { instruction::_FJEQ,  "fcmp oeq" },
+  { instruction::_FJLT,  "fcmp olt" },
+  { instruction::_FJLE,  "fcmp ole" },
+  { instruction::_FJNEQ, "fcmp une" },    // unordered: true with a NaN operand
+  { instruction::_FJNLT, "fcmp uge" },
+  { instruction::_FJNLE, "fcmp ugt" },
   { instruction::_AND,  "and" },
   { instruction::_OR,   "or" },
 };
@@ -109,63 +122,84 @@ LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const
   : Types{Types}, Symbols{Symbols}, tCode{tCode},
     writeI(false), writeF(false), writeC(false), writeLN(false),
     readI(false), readF(false), readC(false),
-    globalI(false), globalF(false), globalC(false)
+    globalI(false), globalF(false), globalC(false), arrayCopy(false)
 {
-  std::string failFunc, failTempVar;
-  check_SSA_tCode(failFunc, failTempVar);
-  if (failFunc != "") {
-    std::cerr << std::endl;
-    std::cerr << ";;; *****************************************************************************" << std::endl;
-    std::cerr << ";;; WARNING: in order to generate LLVM code, this emitter impose the following"    << std::endl;
-    std::cerr << ";;;          restriction: the temporal variables in the t-code cannot be multiply" << std::endl;
-    std::cerr << ";;;          defined inside a function."                                           << std::endl;
-    std::cerr << ";;;          For example, this happens in function '";
-    std::cerr << failFunc << "' with temporal '" << failTempVar << "'"       << std::endl;
-    std::cerr << ";;; *****************************************************************************" << std::endl;
-    std::cerr << std::endl;
-    std::exit(EXIT_SUCCESS);
-  }
 }
 
-void LLVMCodeGen::check_SSA_tCode(std::string & failFunc, std::string & failTempVar) const {
-  failFunc = "";
-  failTempVar = "";
-  for (auto & subr: tCode.get_subroutine_list()) {
-    std::map<std::string, int> modTempCounts;
-    for (auto & instr: subr.get_instructions()) {
-      switch (instr.oper) {
-      case instruction::_LABEL:
-      case instruction::_UJUMP:
-      case instruction::_FJUMP:
-      case instruction::_PUSH:
-      case instruction::_RETURN:
-      case instruction::_XLOAD:
-      case instruction::_CLOAD:
-      case instruction::_WRITEI:
-      case instruction::_WRITEF:
-      case instruction::_WRITEC:
-      case instruction::_WRITES:
-      case instruction::_WRITELN:
-      case instruction::_NOOP:
-      case instruction::_INVALID:
-        break;
-      default:                 // Except in instruction::_POP, where is optional (arg1 may be ""),
-                               // the argument arg1 always does exist.
-        std::string arg1 = getTCodeArg(instr, 1);
-        if (isTCodeTemporal(arg1)) {
-          modTempCounts[arg1] += 1;
-        }
-        break;
-      }
-    }
-    for (auto & pair : modTempCounts) {
-      if (pair.second > 1) {
-        failFunc = subr.get_name();
-        failTempVar = pair.first;
-        return;
+std::set<std::string> LLVMCodeGen::multiplyDefinedTemps(const subroutine & subr) const {
+  std::map<std::string, int> modTempCounts;
+  for (auto & instr: subr.get_instructions()) {
+    switch (instr.oper) {
+    case instruction::_LABEL:
+    case instruction::_UJUMP:
+    case instruction::_FJUMP:
+    case instruction::_JEQ:
+    case instruction::_JLT:
+    case instruction::_JLE:
+    case instruction::_JNEQ:
+    case instruction::_JNLT:
+    case instruction::_JNLE:
+    case instruction::_FJEQ:
+    case instruction::_FJLT:
+    case instruction::_FJLE:
+    case instruction::_FJNEQ:
+    case instruction::_FJNLT:
+    case instruction::_FJNLE:
+    case instruction::_PUSH:
+    case instruction::_RETURN:
+    case instruction::_XLOAD:
+    case instruction::_CLOAD:
+    case instruction::_ACOPY:
+    case instruction::_WRITEI:
+    case instruction::_WRITEF:
+    case instruction::_WRITEC:
+    case instruction::_WRITES:
+    case instruction::_WRITELN:
+    case instruction::_NOOP:
+    case instruction::_INVALID:
+      break;
+    default:                 // Except in instruction::_POP, where is optional (arg1 may be ""),
+                             // the argument arg1 always does exist.
+      std::string arg1 = getTCodeArg(instr, 1);
+      if (isTCodeTemporal(arg1)) {
+        modTempCounts[arg1] += 1;
       }
+      break;
     }
   }
+  std::set<std::string> temps;
+  for (auto & pair : modTempCounts)
+    if (pair.second > 1)
+      temps.insert(pair.first);
+  return temps;
+}
+
+subroutine LLVMCodeGen::demoteMultiplyDefinedTemps(const subroutine & subr) {
+  // Pre:  the types of the temporals of subr have been binded
+  //       (bindTCodeLocalSymbolsToLLVMTypes)
+  // Post: a temporal defined more than once (for example, the value of a
+  //       short-circuit 'and'/'or') is not a valid SSA value: it is replaced
+  //       by a local variable ".mem.N" of the same type (an alloca that
+  //       LLVM's mem2reg promotes back to registers). The names of these
+  //       variables are kept in demotedTemps.
+  demotedTemps.clear();
+  std::set<std::string> temps = multiplyDefinedTemps(subr);
+  if (temps.empty()) return subr;
+  subroutine demoted = subr;
+  nameTable & names = demoted.get_names();
+  for (auto & temp : temps) {
+    std::string var = ".mem." + temp.substr(1);
+    std::string llvmType = getLLVMTypeOfValue(getLLVMValue(temp));
+    bindLLVMLocalValueWithType(getLLVMValue(var), llvmType);
+    demotedTemps.push_back(var);
+  }
+  instructionList instrList = demoted.get_instructions();
+  for (auto & instr : instrList)
+    for (operand *arg : {&instr.arg1, &instr.arg2, &instr.arg3})
+      if (arg->isTemp() and temps.count(arg->str()))
+        *arg = operand(".mem." + arg->str().substr(1), names);
+  demoted.set_instructions(std::move(instrList));
+  return demoted;
 }
 
 bool LLVMCodeGen::isTCodeTemporal(const std::string & tcodeArg) const {
@@ -202,8 +236,10 @@ void LLVMCodeGen::computeReadWriteInfo() {
         writeC = true;
         break;
       case instruction::_WRITES:
-        if (std::find(writeSAslStrVec.begin(), writeSAslStrVec.end(), arg1) == writeSAslStrVec.end()) {
-          writeSAslStrVec.push_back(arg1);
+        {
+          std::vector<std::string> & strings = writeSAslStrMap[subr.get_name()];
+          if (std::find(strings.begin(), strings.end(), arg1) == strings.end())
+            strings.push_back(arg1);
         }
         writeS = true;
         break;
@@ -225,6 +261,9 @@ void LLVMCodeGen::computeReadWriteInfo() {
         if (isTCodeTemporal(arg1))
           globalC = true;
         break;
+      case instruction::_ACOPY:
+        arrayCopy = true;
+        break;
       default:
         break;
       }
@@ -276,6 +315,41 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
         bindTCodeLocalValueWithType(arg2, LLVM_LABEL);
         break;
       }
+    case instruction::_JEQ:
+    case instruction::_JLT:
+    case instruction::_JLE:
+    case instruction::_JNEQ:
+    case instruction::_JNLT:
+    case instruction::_JNLE:
+      {
+        if (isTCodeIdentifier(arg1) and isTCodeTemporal(arg2)) {
+          std::string llvmValue1 = getLLVMValue(arg1);
+          std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
+          bindTCodeLocalValueWithType(arg2, llvmType1);
+        }
+        else if (isTCodeTemporal(arg1) and isTCodeIdentifier(arg2)) {
+          std::string llvmValue2 = getLLVMValue(arg2);
+          std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
+          bindTCodeLocalValueWithType(arg1, llvmType2);
+        }
+        else if (isTCodeTemporal(arg1) and isTCodeTemporal(arg2)) {
+          bindPairOfTCodeLocalValuesWithTypes(arg1, arg2);
+        }
+        bindTCodeLocalValueWithType(arg3, LLVM_LABEL);
+        break;
+      }
+    case instruction::_FJEQ:
+    case instruction::_FJLT:
+    case instruction::_FJLE:
+    case instruction::_FJNEQ:
+    case instruction::_FJNLT:
+    case instruction::_FJNLE:
+      {
+        bindTCodeLocalValueWithType(arg1, LLVM_FLOAT);
+        bindTCodeLocalValueWithType(arg2, LLVM_FLOAT);
+        bindTCodeLocalValueWithType(arg3, LLVM_LABEL);
+        break;
+      }
     case instruction::_LOAD:
       {
         if (isTCodeIdentifier(arg1) and isTCodeTemporal(arg2)) {       //  a = %4
@@ -448,6 +522,7 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     case instruction::_SUB:
     case instruction::_MUL:
     case instruction::_DIV:
+    case instruction::_MOD:
       {
         bindTCodeLocalValueWithType(arg1, LLVM_INT);
         bindTCodeLocalValueWithType(arg2, LLVM_INT);
@@ -493,6 +568,7 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     case instruction::_FSUB:
     case instruction::_FMUL:
     case instruction::_FDIV:
+    case instruction::_FMOD:
       {
         bindTCodeLocalValueWithType(arg1, LLVM_FLOAT);
         bindTCodeLocalValueWithType(arg2, LLVM_FLOAT);
@@ -648,14 +724,14 @@ void LLVMCodeGen::generateReadWriteBeginEndCode(std::string & begin, std::string
     begin += "@.str.f = constant [3 x i8] c\"%g\\00\"\n";
   if (writeC or readC)
     begin += "@.str.c = constant [3 x i8] c\"%c\\00\"\n";
-  std::string::size_type n = writeSAslStrVec.size();
-  writeSLLVMStrSizeVec = std::vector<std::string::size_type>(n);
-  for (std::string::size_type i = 0; i < n; ++i) {
-    std::string            llvmStr;
-    std::string::size_type llvmStrSize;
-    getLLVMStringFromAslString(writeSAslStrVec[i], llvmStr, llvmStrSize);
-    begin += "@.str.s." + std::to_string(i+1) + " = constant [" + std::to_string(llvmStrSize+1) + " x i8] c\"" + llvmStr + "\\00\"\n";
-    writeSLLVMStrSizeVec[i] = llvmStrSize+1;
+  for (auto & subr: tCode.get_subroutine_list()) {
+    const std::vector<std::string> & strings = writeSAslStrMap[subr.get_name()];
+    for (std::string::size_type i = 0; i < strings.size(); ++i) {
+      std::string            llvmStr;
+      std::string::size_type llvmStrSize;
+      getLLVMStringFromAslString(strings[i], llvmStr, llvmStrSize);
+      begin += "@.str.s." + subr.get_name() + "." + std::to_string(i+1) + " = constant [" + std::to_string(llvmStrSize+1) + " x i8] c\"" + llvmStr + "\\00\"\n";
+    }
   }
   if (writeI or readI or writeF or readF or writeC or readC)
     begin += "\n\n";
@@ -678,18 +754,31 @@ void LLVMCodeGen::generateReadWriteBeginEndCode(std::string & begin, std::string
   if (readI or readF or readC) {
     end += "declare dso_local i32 @__isoc99_scanf(i8*, ...)\n";
   }
+  if (arrayCopy)
+    end += "declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)\n";
   if (writeI or writeF or writeC or writeS or writeLN or readI or readF or readC)
     end += "\n";
 }
 
 std::string LLVMCodeGen::dumpLLVM() {
+  std::vector<std::string> fragments;
+  return dumpLLVM(fragments);
+}
+
+std::string LLVMCodeGen::dumpLLVM(std::vector<std::string> & fragments) {
   std::string llvmCode, llvmBegin, llvmEnd;
   generateReadWriteBeginEndCode(llvmBegin, llvmEnd);
   bindGlobalValuesWithTypes();
-  for (auto & subr: tCode.get_subroutine_list()) {
-    bindTCodeLocalSymbolsToLLVMTypes(subr);
-    startNewFunction(subr);
-    llvmCode += dumpSubroutine(subr);
+  const std::vector<subroutine> & subroutines = tCode.get_subroutine_list();
+  fragments.resize(subroutines.size());
+  for (std::size_t i = 0; i < subroutines.size(); ++i) {
+    if (fragments[i].empty()) {
+      bindTCodeLocalSymbolsToLLVMTypes(subroutines[i]);
+      subroutine ssaSubr = demoteMultiplyDefinedTemps(subroutines[i]);
+      startNewFunction(ssaSubr);
+      fragments[i] = dumpSubroutine(ssaSubr);
+    }
+    llvmCode += fragments[i];
   }
   llvmCode = llvmBegin + llvmCode + llvmEnd;
   return llvmCode;
@@ -769,6 +858,15 @@ std::string LLVMCodeGen::dumpAllocaLocalVars(const subroutine & subr) {
     llvmCode += llvmComment("   localVar " + v.name +  " " + llvmType);
     llvmCode += createALLOCA(llvmValueAddr, llvmType);
   }
+  for (auto & var : demotedTemps) {
+    std::string llvmValue     = getLLVMValue(var);
+    std::string llvmType      = getLLVMTypeOfValue(llvmValue);
+    std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
+    std::string llvmTypePtr   = getPointerToType(llvmType);
+    bindLLVMLocalValueWithType(llvmValueAddr, llvmTypePtr);
+    llvmCode += llvmComment("   demoted temporal " + var + " " + llvmType);
+    llvmCode += createALLOCA(llvmValueAddr, llvmType);
+  }
   return llvmCode;
 }
 
@@ -856,11 +954,52 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
         llvmCode += createLABEL(labelContName);
       }
       else {
-        std::string labelCont = getLLVMValue(next.arg1);
+        std::string labelCont = getLLVMValue(next.arg1.str());
         llvmCode += createBR(llvmValue1, labelCont, labelJump);
       }
       break;
     }
+  case instruction::_JEQ:
+  case instruction::_JLT:
+  case instruction::_JLE:
+  case instruction::_JNEQ:
+  case instruction::_JNLT:
+  case instruction::_JNLE:
+  case instruction::_FJEQ:
+  case instruction::_FJLT:
+  case instruction::_FJLE:
+  case instruction::_FJNEQ:
+  case instruction::_FJNLT:
+  case instruction::_FJNLE:
+    {
+      // the comparison goes directly to the branch (no i1 in memory)
+      accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
+      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
+      std::string llvmType12 = LLVM_FLOAT;
+      if (instr.oper <= instruction::_JNLE) {
+        llvmType12 = LLVM_INT;
+        if (isTCodeIdentifier(tcodeArg1) or isTCodeTemporal(tcodeArg1))
+          llvmType12 = getLLVMTypeOfValue(getLLVMValue(tcodeArg1));
+        else if (isTCodeIdentifier(tcodeArg2) or isTCodeTemporal(tcodeArg2))
+          llvmType12 = getLLVMTypeOfValue(getLLVMValue(tcodeArg2));
+      }
+      std::string llvmCond = createNewPrefixedValueWithType("%.cmp", LLVM_BOOL);
+      llvmCode += llvmMemCodeValue1;
+      llvmCode += llvmMemCodeValue2;
+      llvmCode += createCOMPARISON(instr.oper, llvmCond, llvmValue1, llvmValue2, llvmType12);
+      std::string labelJump = getLLVMValue(tcodeArg3);
+      if (next.oper != instruction::_LABEL and next.oper != instruction::_NOOP) {
+        std::string labelCont = createNewPrefixedValueWithType("%.br.cont", LLVM_LABEL);
+        std::string labelContName = labelCont.substr(1);
+        llvmCode += createBR(llvmCond, labelJump, labelCont);
+        llvmCode += createLABEL(labelContName);
+      }
+      else {
+        std::string labelCont = getLLVMValue(next.arg1.str());
+        llvmCode += createBR(llvmCond, labelJump, labelCont);
+      }
+      break;
+    }
   case instruction::_LOAD:
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
@@ -992,7 +1131,7 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       llvmValue1 =  getLLVMValue(tcodeArg1);
       accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
       accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      std::string llvmType = getLLVMTypeOfValue(llvmValue1);   // it can  be "array of" or "pointer to"
+      std::string llvmType = getLLVMTypeOfValue(llvmValue1);   // it can be "array of" or "pointer to"
       std::string llvmElemType;
       if (isLLVMArrayType(llvmType))
         llvmElemType = getLLVMElementOfArrayType(llvmType);
@@ -1018,7 +1157,7 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
       llvmValue2 = getLLVMValue(tcodeArg2);
       accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      std::string llvmType = getLLVMTypeOfValue(llvmValue2);   // it can  be "array of" or "pointer to"
+      std::string llvmType = getLLVMTypeOfValue(llvmValue2);   // it can be "array of" or "pointer to"
       std::string llvmElemType;
       if (isLLVMArrayType(llvmType))
         llvmElemType = getLLVMElementOfArrayType(llvmType);
@@ -1051,6 +1190,40 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
         llvmCode += createLOAD(llvmValue1, llvmValue2Addr);
       break;
     }
+  case instruction::_ACOPY:
+    {
+      // memcpy between the first elements of both arrays
+      std::string llvmBytePtr[2];
+      std::string llvmElemType;
+      const std::string * tcodeArrays[2] = { &tcodeArg1, &tcodeArg2 };
+      for (int k = 0; k < 2; ++k) {
+        std::string llvmValue = getLLVMValue(*tcodeArrays[k]);
+        std::string llvmType = getLLVMTypeOfValue(llvmValue);   // it can be "array of" or "pointer to"
+        std::string llvmElemPtr;
+        if (isLLVMArrayType(llvmType)) {
+          llvmElemType = getLLVMElementOfArrayType(llvmType);
+          llvmElemPtr = createNewPrefixedValueWithType("%.arrPtr", getPointerToType(llvmElemType));
+          llvmCode += createGETELEMENTPTR(llvmElemPtr, getLLVMValueAddr(llvmValue), LLVM_ZERO_INT);
+        }
+        else {
+          llvmElemType = getPointedType(llvmType);
+          if (isTCodeIdentifier(*tcodeArrays[k])) {     // array parameter: load the address
+            std::string llvmMemCode;
+            accessValueOfArgument(*tcodeArrays[k], llvmElemPtr, llvmMemCode);
+            llvmCode += llvmMemCode;
+          }
+          else
+            llvmElemPtr = llvmValue;
+        }
+        llvmBytePtr[k] = createNewPrefixedValueWithType("%.bytePtr", LLVM_CHAR_PTR);
+        llvmCode += createCONVERSION("bitcast", llvmBytePtr[k], llvmElemPtr, getLLVMTypeOfValue(llvmElemPtr));
+      }
+      long elemSize = (llvmElemType == LLVM_INT or llvmElemType == LLVM_FLOAT) ? 4 : 1;
+      long nBytes = elemSize * std::stol(tcodeArg3);
+      llvmCode += INDENT_INSTR + "call void @llvm.memcpy.p0i8.p0i8.i64(i8* " + llvmBytePtr[0] +
+                  ", i8* " + llvmBytePtr[1] + ", i64 " + std::to_string(nBytes) + ", i1 false)\n";
+      break;
+    }
     /*
   case instruction::_LOADC:
     {
@@ -1096,11 +1269,14 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
     }
   case instruction::_WRITES:
     {
-      auto it = std::find(writeSAslStrVec.begin(), writeSAslStrVec.end(), tcodeArg1);
-      std::size_t i = std::distance(writeSAslStrVec.begin(), it);
-      std::string strFormat = "@.str.s." + std::to_string(i+1);
-      std::string::size_type llvmStrSize = writeSLLVMStrSizeVec[i];
-      llvmCode += createPRINTS(strFormat, llvmStrSize);
+      const std::vector<std::string> & strings = writeSAslStrMap[currentFunctionName];
+      auto it = std::find(strings.begin(), strings.end(), tcodeArg1);
+      std::size_t i = std::distance(strings.begin(), it);
+      std::string strFormat = "@.str.s." + currentFunctionName + "." + std::to_string(i+1);
+      std::string            llvmStr;
+      std::string::size_type llvmStrSize;
+      getLLVMStringFromAslString(tcodeArg1, llvmStr, llvmStrSize);
+      llvmCode += createPRINTS(strFormat, llvmStrSize+1);
       break;
     }
   case instruction::_WRITELN:
@@ -1175,6 +1351,7 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
   case instruction::_SUB:
   case instruction::_MUL:
   case instruction::_DIV:
+  case instruction::_MOD:
     {
       modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
       accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
@@ -1243,6 +1420,22 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       llvmCode += llvmMemCodeValue1;
       break;
     }
+  case instruction::_FMOD:
+    {
+      // the sequence tvm runs (see code::expand_for_tvm), not frem
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
+      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
+      std::string llvmQuot = createNewPrefixedValueWithType("%.fmod.quot", LLVM_FLOAT);
+      std::string llvmProd = createNewPrefixedValueWithType("%.fmod.prod", LLVM_FLOAT);
+      llvmCode += llvmMemCodeValue2;
+      llvmCode += llvmMemCodeValue3;
+      llvmCode += createARITHMETIC(instruction::_FDIV, llvmQuot, llvmValue2, llvmValue3, LLVM_FLOAT);
+      llvmCode += createARITHMETIC(instruction::_FMUL, llvmProd, llvmQuot, llvmValue3, LLVM_FLOAT);
+      llvmCode += createARITHMETIC(instruction::_FSUB, llvmValue1, llvmValue2, llvmProd, LLVM_FLOAT);
+      llvmCode += llvmMemCodeValue1;
+      break;
+    }
   case instruction::_FNEG:
     {
       modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
@@ -1307,11 +1500,11 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
 std::string LLVMCodeGen::getTCodeArg(const instruction & instr, int i) const {
   std::string arg;
   if (i == 1)
-    arg = instr.arg1;
+    arg = instr.arg1.str();
   else if (i == 2)
-    arg = instr.arg2;
+    arg = instr.arg2.str();
   else     // i == 3
-    arg = instr.arg3;
+    arg = instr.arg3.str();
   return arg;
 }
 
@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <stack>
 
 // using namespace std;
@@ -87,8 +88,10 @@ class LLVMCodeGen {
   bool writeI, writeF, writeC, writeS, writeLN;
   bool readI, readF, readC;
   bool globalI, globalF, globalC, globalS;
-  std::vector<std::string>            writeSAslStrVec;
-  std::vector<std::string::size_type> writeSLLVMStrSizeVec;
+  bool arrayCopy;
+  // the strings written by each function, numbered within it (so that
+  // the code of a function does not depend on the others)
+  std::map<std::string, std::vector<std::string>> writeSAslStrMap;
   std::string currentFunctionName;
   bool isMain;
   bool prevInstrIsTerminator;
@@ -101,8 +104,10 @@ class LLVMCodeGen {
   std::string                        pendingCallLLVMRetType;
   std::string                        pendingCallFunc;
   std::vector<std::string>           pendingCallArgs;
+  std::vector<std::string>           demotedTemps;
 
-  void check_SSA_tCode(std::string & failFunc, std::string & failTempVar) const;
+  std::set<std::string> multiplyDefinedTemps(const subroutine & subr) const;
+  subroutine demoteMultiplyDefinedTemps(const subroutine & subr);
   bool isTCodeTemporal   (const std::string & tcodeArg) const;
   bool isTCodeIdentifier (const std::string & tcodeArg) const;
 
@@ -207,4 +212,7 @@ class LLVMCodeGen {
 public:
   LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
   std::string dumpLLVM();
+  // the same, taking the code of the subroutine i from fragments[i]
+  // if it is not empty, and writing it there otherwise
+  std::string dumpLLVM(std::vector<std::string> & fragments);
 };
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Liveness - live temporaries and variables of a subroutine
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Liveness.h"
+
+#include <set>
+#include <utility>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'Liveness'
+
+const size_t Liveness::NONE;
+
+Liveness::Liveness(const FlowGraph &g) : Liveness(g, tracked_operands(g.get_code())) {}
+
+Liveness::Liveness(const FlowGraph &g, vector<operand> &&ops) :
+  DataFlow(g, BACKWARD, UNION, ops.size()), operands(std::move(ops)) {
+  for (size_t i = 0; i < operands.size(); ++i) indexes[operands[i]] = i;
+  // the caller reads the result when the subroutine ends
+  for (size_t i = 0; i < operands.size(); ++i)
+    if (operands[i].str() == "_result") boundary.set(i);
+
+  // gen: read before written in the block; kill: written in the block
+  const instructionList & code = g.get_code();
+  vector<size_t> uses;
+  size_t def;
+  for (size_t b = 0; b < g.size(); ++b) {
+    const FlowGraph::BasicBlock & blk = g.block(b);
+    for (size_t pc = blk.last; pc-- > blk.first; ) {
+      uses_and_def(code[pc], uses, def);
+      if (def != NONE) {
+        kill[b].set(def);
+        gen[b].reset(def);
+      }
+      for (size_t u : uses) gen[b].set(u);
+    }
+  }
+  solve();
+}
+
+Liveness::~Liveness() {}
+
+vector<operand> Liveness::tracked_operands(const instructionList &code) {
+  set<operand> found, excluded;
+  auto consider = [&](const operand &a) { if (a.isTemp() or a.isSymbol()) found.insert(a); };
+  for (auto & ins : code) {
+    unsigned used = ins.used_args();
+    if (used & instruction::ARG1) consider(ins.arg1);
+    if (used & instruction::ARG2) consider(ins.arg2);
+    if (used & instruction::ARG3) consider(ins.arg3);
+    if (ins.defines_arg1()) consider(ins.arg1);
+    // arrays and variables whose address is taken
+    if (ins.oper == instruction::_XLOAD and ins.arg1.isSymbol()) excluded.insert(ins.arg1);
+    if (ins.oper == instruction::_LOADX and ins.arg2.isSymbol()) excluded.insert(ins.arg2);
+    if (ins.oper == instruction::_ALOAD) excluded.insert(ins.arg2);
+    if (ins.oper == instruction::_ACOPY) {
+      if (ins.arg1.isSymbol()) excluded.insert(ins.arg1);
+      if (ins.arg2.isSymbol()) excluded.insert(ins.arg2);
+    }
+  }
+  vector<operand> ops;
+  for (auto & a : found)
+    if (excluded.count(a) == 0) ops.push_back(a);
+  return ops;
+}
+
+size_t Liveness::size() const { return operands.size(); }
+
+size_t Liveness::index(const operand &a) const {
+  auto it = indexes.find(a);
+  return it == indexes.end() ? NONE : it->second;
+}
+
+const operand & Liveness::get_operand(size_t i) const { return operands[i]; }
+
+void Liveness::uses_and_def(const instruction &ins, vector<size_t> &uses, size_t &def) const {
+  uses.clear();
+  def = ins.defines_arg1() ? index(ins.arg1) : NONE;
+  unsigned used = ins.used_args();
+  auto add = [&](const operand &a) {
+    size_t i = index(a);
+    if (i != NONE) uses.push_back(i);
+  };
+  if (used & instruction::ARG1) add(ins.arg1);
+  if (used & instruction::ARG2) add(ins.arg2);
+  if (used & instruction::ARG3) add(ins.arg3);
+}
+
+void Liveness::step_back(const instruction &ins, BitSet &live) const {
+  vector<size_t> uses;
+  size_t def;
+  uses_and_def(ins, uses, def);
+  if (def != NONE) live.reset(def);
+  for (size_t u : uses) live.set(u);
+}
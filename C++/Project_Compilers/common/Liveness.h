@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Liveness - live temporaries and variables of a subroutine
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "DataFlow.h"
+
+#include <map>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class Liveness computes which temporaries and scalar variables may
+/// be read before being written again. Arrays and variables whose
+/// address is taken are not tracked (they are always live).
+/// _result is live at the exits of the subroutine.
+
+class Liveness : public DataFlow {
+public:
+  /// constructor: analyze the code of a graph
+  explicit Liveness(const FlowGraph &g);
+  ~Liveness();
+
+  /// number of tracked operands
+  std::size_t size() const;
+  /// index of a tracked operand (NONE if not tracked)
+  std::size_t index(const operand &a) const;
+  /// tracked operand with an index
+  const operand & get_operand(std::size_t i) const;
+  /// indexes of the operands read and written by an instruction
+  void uses_and_def(const instruction &ins, std::vector<std::size_t> &uses, std::size_t &def) const;
+  /// update the set of live operands, going backward over an instruction
+  void step_back(const instruction &ins, BitSet &live) const;
+
+  static const std::size_t NONE = std::size_t(-1);
+
+private:
+  std::map<operand, std::size_t> indexes;
+  std::vector<operand> operands;
+
+  /// constructor once the tracked operands are known
+  Liveness(const FlowGraph &g, std::vector<operand> &&ops);
+  /// choose the tracked operands
+  static std::vector<operand> tracked_operands(const instructionList &code);
+};
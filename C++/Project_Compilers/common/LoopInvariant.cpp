@@ -0,0 +1,209 @@
+/////////////////////////////////////////////////////////////////
+//
+//    LoopInvariant - hoisting of loop-invariant t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "LoopInvariant.h"
+#include "FlowGraph.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+
+namespace {
+
+  // a natural loop: its header and all its blocks (header included)
+  struct Loop {
+    size_t header;
+    vector<bool> blocks;
+    size_t size;
+  };
+
+  // natural loops of a graph, merging the ones with the same header,
+  // from the smallest (innermost) to the largest
+  vector<Loop> natural_loops(const FlowGraph &g) {
+    vector<size_t> idom = g.dominators();
+    vector<Loop> loops;
+    for (size_t b = 0; b < g.size(); ++b)
+      for (size_t h : g.block(b).succs) {
+        if (not FlowGraph::dominates(h, b, idom)) continue;
+        auto it = find_if(loops.begin(), loops.end(), [h](const Loop &l) { return l.header == h; });
+        if (it == loops.end()) {
+          loops.push_back(Loop{h, vector<bool>(g.size(), false), 1});
+          loops.back().blocks[h] = true;
+          it = loops.end() - 1;
+        }
+        // blocks reaching b without going through the header
+        vector<size_t> pending;
+        if (not it->blocks[b]) {
+          it->blocks[b] = true;
+          ++it->size;
+          pending.push_back(b);
+        }
+        while (not pending.empty()) {
+          size_t x = pending.back();
+          pending.pop_back();
+          for (size_t p : g.block(x).preds)
+            if (not it->blocks[p]) {
+              it->blocks[p] = true;
+              ++it->size;
+              pending.push_back(p);
+            }
+        }
+      }
+    sort(loops.begin(), loops.end(), [](const Loop &a, const Loop &b) { return a.size < b.size; });
+    return loops;
+  }
+
+  // can the instruction be executed earlier, and even when the loop
+  // would not have executed it? (memory reads may see other values)
+  bool movable(const instruction &ins) {
+    return ins.is_pure() and ins.arg1.isTemp() and
+           ins.oper != instruction::_LOADX and ins.oper != instruction::_LOADC;
+  }
+
+  // instructions of a loop that can go to its preheader, in order
+  vector<size_t> invariants(const instructionList &code, const FlowGraph &g, const Loop &loop,
+                            const vector<int> &defs, const vector<size_t> &defAt,
+                            const set<operand> &inMemory) {
+    vector<bool> inLoop(code.size(), false);
+    set<operand> changed;
+    for (size_t b = 0; b < g.size(); ++b) {
+      if (not loop.blocks[b]) continue;
+      for (size_t pc = g.block(b).first; pc < g.block(b).last; ++pc) {
+        inLoop[pc] = true;
+        if (code[pc].defines_arg1()) changed.insert(code[pc].arg1);
+      }
+    }
+    vector<bool> moved(code.size(), false);
+    auto invariant = [&](const operand &a) {
+      if (a.isTemp())
+        return defs[a.number()] == 1 and (not inLoop[defAt[a.number()]] or moved[defAt[a.number()]]);
+      if (a.isSymbol()) return changed.count(a) == 0 and inMemory.count(a) == 0;
+      return true;
+    };
+    vector<size_t> result;
+    bool found = true;
+    while (found) {
+      found = false;
+      for (size_t pc = 0; pc < code.size(); ++pc) {
+        const instruction & ins = code[pc];
+        if (not inLoop[pc] or moved[pc] or not movable(ins) or defs[ins.arg1.number()] != 1) continue;
+        // the address of a variable does not change
+        bool ok = ins.oper == instruction::_ALOAD;
+        if (not ok) {
+          unsigned used = ins.used_args();
+          ok = (not (used & instruction::ARG2) or invariant(ins.arg2)) and
+               (not (used & instruction::ARG3) or invariant(ins.arg3));
+        }
+        if (ok) {
+          moved[pc] = found = true;
+          result.push_back(pc);
+        }
+      }
+    }
+    sort(result.begin(), result.end());
+    return result;
+  }
+
+  // can code be placed right before the header, to run only when the
+  // loop is entered? The only way in must be falling through from
+  // the previous block
+  bool has_preheader(const instructionList &code, const FlowGraph &g, const Loop &loop) {
+    size_t h = loop.header;
+    if (h == 0 or code[g.block(h).first].oper != instruction::_LABEL) return false;
+    for (size_t p : g.block(h).preds)
+      if (not loop.blocks[p] and p != h-1) return false;
+    const instruction & last = code[g.block(h-1).last - 1];
+    return not (last.is_jump() and last.jump_target() == code[g.block(h).first].arg1);
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'LoopInvariant'
+
+LoopInvariant::LoopInvariant() : hoisted(0), loops(0) {}
+
+LoopInvariant::~LoopInvariant() {}
+
+size_t LoopInvariant::get_hoisted() const { return hoisted; }
+
+size_t LoopInvariant::get_loops() const { return loops; }
+
+size_t LoopInvariant::optimize(subroutine &s) {
+  instructionList code = s.get_instructions();
+  size_t initial = hoisted;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    // definitions of the temporaries, and variables whose address is taken
+    int maxTemp = -1;
+    for (auto & ins : code)
+      for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+        if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+    vector<int> defs(maxTemp+1, 0);
+    vector<size_t> defAt(maxTemp+1, 0);
+    set<operand> inMemory;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+      const instruction & ins = code[pc];
+      if (ins.defines_arg1() and ins.arg1.isTemp()) {
+        ++defs[ins.arg1.number()];
+        defAt[ins.arg1.number()] = pc;
+      }
+      if (ins.oper == instruction::_ALOAD) inMemory.insert(ins.arg2);
+    }
+
+    FlowGraph g(code);
+    for (const Loop & loop : natural_loops(g)) {
+      if (not has_preheader(code, g, loop)) continue;
+      vector<size_t> moved = invariants(code, g, loop, defs, defAt, inMemory);
+      if (moved.empty()) continue;
+      // rebuild the list with the moved instructions before the header
+      size_t header = g.block(loop.header).first;
+      vector<bool> isMoved(code.size(), false);
+      for (size_t pc : moved) isMoved[pc] = true;
+      instructionList newCode;
+      newCode.reserve(code.size());
+      for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (pc == header)
+          for (size_t m : moved) newCode.push_back(code[m]);
+        if (not isMoved[pc]) newCode.push_back(code[pc]);
+      }
+      code = std::move(newCode);
+      hoisted += moved.size();
+      ++loops;
+      changed = true;
+      break;
+    }
+  }
+  if (hoisted > initial) s.set_instructions(std::move(code));
+  return hoisted - initial;
+}
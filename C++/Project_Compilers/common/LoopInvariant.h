@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////
+//
+//    LoopInvariant - hoisting of loop-invariant t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class LoopInvariant finds the natural loops of a subroutine (the
+/// targets of back edges in its FlowGraph, and the blocks that reach
+/// them) and moves the invariant computations of each loop to a
+/// preheader, right before the label of the loop header.
+///
+/// An instruction is moved if it is pure, cannot fail, defines a
+/// temporary with a single definition, and all its operands are
+/// constants, temporaries defined out of the loop, or variables that
+/// the loop does not change. Inner loops go first, so an instruction
+/// may leave several nested loops.
+
+class LoopInvariant {
+public:
+  /// constructor and destructor
+  LoopInvariant();
+  ~LoopInvariant();
+
+  /// optimize a subroutine. Returns the number of moved instructions
+  std::size_t optimize(subroutine &s);
+
+  /// statistics so far
+  std::size_t get_hoisted() const;
+  std::size_t get_loops() const;
+
+private:
+  std::size_t hoisted, loops;
+};
@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Optimizer - optimization passes over t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Optimizer.h"
+
+#include <iomanip>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'Optimizer'
+
+Optimizer::Optimizer(bool singleDefTemps) : singleDefTemps(singleDefTemps), sizeBefore(0), sizeAfter(0) {}
+
+Optimizer::~Optimizer() {}
+
+void Optimizer::optimize(code &c) {
+  for (auto & s : c.get_subroutine_list()) {
+    nameTable::Scope names(s.get_names());
+    sizeBefore += s.get_instructions().size();
+    tailRecursion.optimize(s);
+  }
+  if (not singleDefTemps) inliner.optimize(c);
+  for (auto & s : c.get_subroutine_list()) {
+    nameTable::Scope names(s.get_names());
+    // each pass may expose work for the others
+    peephole.optimize(s);
+    bool changed = true;
+    while (changed) {
+      changed = constFold.optimize(s) > 0;
+      changed = deadCode.optimize(s) > 0 or changed;
+      changed = loopInvariant.optimize(s) > 0 or changed;
+      if (changed) peephole.optimize(s);
+    }
+    // the other passes expect single-definition temporaries: renumber
+    // last. Only for t-code: LLVM temporaries are SSA values, which must
+    // keep one definition each, and llc allocates their registers itself
+    if (not singleDefTemps) renumber.optimize(s);
+    sizeAfter += s.get_instructions().size();
+  }
+}
+
+void Optimizer::print_stats(ostream &os) const {
+  os << "instructions: " << sizeBefore << " -> " << sizeAfter << endl;
+  os << "tail calls: " << tailRecursion.get_eliminated()
+     << " (" << tailRecursion.get_accumulated() << " accumulating)" << endl;
+  os << "inlined calls: " << inliner.get_inlined() << endl;
+  if (not singleDefTemps)
+    os << "peak frame size: " << renumber.get_peak_before() << " -> " << renumber.get_peak_after() << endl;
+  else
+    os << "peak frame size: not renumbered (t-code only)" << endl;
+  os << "constant folding:" << endl;
+  os << "  " << left << setw(16) << "folded" << right << setw(8) << constFold.get_folded() << endl;
+  os << "  " << left << setw(16) << "branches" << right << setw(8) << constFold.get_branches() << endl;
+  os << "dead code:" << endl;
+  os << "  " << left << setw(16) << "threaded jumps" << right << setw(8) << deadCode.get_threaded() << endl;
+  os << "  " << left << setw(16) << "unreachable" << right << setw(8) << deadCode.get_unreachable() << endl;
+  os << "  " << left << setw(16) << "dead temps" << right << setw(8) << deadCode.get_dead_temps() << endl;
+  os << "  " << left << setw(16) << "dead stores" << right << setw(8) << deadCode.get_dead_stores() << endl;
+  os << "loop invariants:" << endl;
+  os << "  " << left << setw(16) << "hoisted" << right << setw(8) << loopInvariant.get_hoisted() << endl;
+  os << "  " << left << setw(16) << "loops" << right << setw(8) << loopInvariant.get_loops() << endl;
+  os << "peephole:" << endl;
+  for (auto & r : peephole.get_stats())
+    os << "  " << left << setw(16) << r.rule << right << setw(8) << r.removed << endl;
+}
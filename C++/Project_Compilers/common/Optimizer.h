@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Optimizer - optimization passes over t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+#include "TailRecursion.h"
+#include "Inliner.h"
+#include "Peephole.h"
+#include "ConstFold.h"
+#include "DeadCode.h"
+#include "LoopInvariant.h"
+#include "TempRenumber.h"
+
+#include <iostream>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class Optimizer eliminates tail recursion and inlines the small
+/// subroutines of a program, runs the t-code optimization passes over
+/// every subroutine, and keeps statistics of their effect.
+/// Inlining and the final renumbering of temporaries give several
+/// definitions, maybe of different types, to some temporaries; both are
+/// disabled with singleDefTemps to keep the single definition and type
+/// per temporary that LLVMCodeGen requires. So the renumbering applies
+/// to t-code only: the LLVM path leaves register allocation to llc.
+
+class Optimizer {
+public:
+  /// constructor and destructor
+  Optimizer(bool singleDefTemps = false);
+  ~Optimizer();
+
+  /// optimize all the subroutines of a program
+  void optimize(code &c);
+  /// print what each pass achieved
+  void print_stats(std::ostream &os) const;
+
+private:
+  TailRecursion tailRecursion;
+  Inliner inliner;
+  Peephole peephole;
+  ConstFold constFold;
+  DeadCode deadCode;
+  LoopInvariant loopInvariant;
+  TempRenumber renumber;
+  bool singleDefTemps;
+  /// number of instructions before and after optimizing
+  std::size_t sizeBefore, sizeAfter;
+};
@@ -0,0 +1,294 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Peephole - local simplifications of t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "Peephole.h"
+
+#include <set>
+#include <utility>
+
+using namespace std;
+
+
+// The rules rely on a property of the code generated by CodeGenVisitor:
+// a temporary with a single definition is always defined before it is
+// used, so its value is the same at every use.
+
+namespace {
+
+  // definitions and uses of each temporary of an instruction list
+  struct TempInfo {
+    vector<int> defs, uses;
+    vector<size_t> defAt;       // position of the (last) definition
+
+    void compute(const instructionList &code) {
+      int maxTemp = -1;
+      for (auto & ins : code)
+        for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+          if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+      defs.assign(maxTemp+1, 0);
+      uses.assign(maxTemp+1, 0);
+      defAt.assign(maxTemp+1, 0);
+      for (size_t i = 0; i < code.size(); ++i) {
+        const instruction & ins = code[i];
+        unsigned used = ins.used_args();
+        if ((used & instruction::ARG1) and ins.arg1.isTemp()) ++uses[ins.arg1.number()];
+        if ((used & instruction::ARG2) and ins.arg2.isTemp()) ++uses[ins.arg2.number()];
+        if ((used & instruction::ARG3) and ins.arg3.isTemp()) ++uses[ins.arg3.number()];
+        if (ins.defines_arg1() and ins.arg1.isTemp()) {
+          ++defs[ins.arg1.number()];
+          defAt[ins.arg1.number()] = i;
+        }
+      }
+    }
+
+    bool single_def(const operand &a) const { return a.isTemp() and defs[a.number()] == 1; }
+    int uses_of(const operand &a) const { return a.isTemp() ? uses[a.number()] : 0; }
+  };
+
+  // an instruction list being rewritten by a rule. Removed instructions
+  // are only marked, and dropped when the rule finishes
+  struct RuleContext {
+    instructionList & code;
+    nameTable & names;
+    TempInfo info;
+    vector<bool> removed;
+    size_t nRemoved;
+    bool changed;
+
+    RuleContext(instructionList &c, nameTable &n) : code(c), names(n), nRemoved(0), changed(false) {}
+
+    void remove(size_t i) {
+      if (removed[i]) return;
+      removed[i] = true;
+      ++nRemoved;
+      changed = true;
+    }
+    // single definition of a temporary, if any
+    const instruction * def_of(const operand &a) const {
+      return info.single_def(a) ? &code[info.defAt[a.number()]] : nullptr;
+    }
+  };
+
+  bool is_copy(const instruction &ins) {
+    return ins.oper == instruction::_LOAD or ins.oper == instruction::_ILOAD or
+           ins.oper == instruction::_CHLOAD or ins.oper == instruction::_FLOAD;
+  }
+
+  // is the operand a temporary always holding an integer constant?
+  bool is_int_temp(const RuleContext &ctx, const operand &a) {
+    const instruction *d = ctx.def_of(a);
+    return d and (d->oper == instruction::_ILOAD or d->oper == instruction::_LOAD) and d->arg2.isInt();
+  }
+
+  // is the operand a temporary always holding the integer 0?
+  bool is_zero_temp(const RuleContext &ctx, const operand &a) {
+    return is_int_temp(ctx, a) and ctx.def_of(a)->arg2.number() == 0;
+  }
+
+  // remove the single definition of a temporary with no uses left
+  void remove_def_if_unused(RuleContext &ctx, const operand &a, int usesLeft) {
+    if (ctx.info.single_def(a) and ctx.info.uses_of(a) == usesLeft)
+      ctx.remove(ctx.info.defAt[a.number()]);
+  }
+
+  // ----------------------------------------------------------------
+  // the rules
+
+  // %t = 0; %u = %t + x   =>   %u = x   (unary plus)
+  // Only for integers: with floats, 0.0 + -0.0 is 0.0, not -0.0
+  void rule_add_zero(RuleContext &ctx) {
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      instruction & ins = ctx.code[i];
+      if (ins.oper != instruction::_ADD) continue;
+      operand zero;
+      if (is_zero_temp(ctx, ins.arg2)) { zero = ins.arg2; ins = instruction::LOAD(ins.arg1, ins.arg3); }
+      else if (is_zero_temp(ctx, ins.arg3)) { zero = ins.arg3; ins = instruction::LOAD(ins.arg1, ins.arg2); }
+      else continue;
+      ctx.changed = true;
+      remove_def_if_unused(ctx, zero, 1);
+    }
+  }
+
+  // %t = 3; %u = float %t   =>   %u = 3.0
+  void rule_float_literal(RuleContext &ctx) {
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      instruction & ins = ctx.code[i];
+      if (ins.oper != instruction::_FLOAT) continue;
+      if (not is_int_temp(ctx, ins.arg2)) continue;
+      operand value(ctx.def_of(ins.arg2)->arg2.str() + ".0", ctx.names);
+      operand src = ins.arg2;
+      ins = instruction::FLOAD(ins.arg1, value);
+      ctx.changed = true;
+      remove_def_if_unused(ctx, src, 1);
+    }
+  }
+
+  // %u = %t; ... %u ...   =>   ... %t ...   (both with a single definition)
+  void rule_copy_forward(RuleContext &ctx) {
+    vector<int> subst(ctx.info.defs.size(), -1);
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      const instruction & ins = ctx.code[i];
+      if (not is_copy(ins) or not ctx.info.single_def(ins.arg1) or
+          not ctx.info.single_def(ins.arg2)) continue;
+      int root = ins.arg2.number();
+      while (subst[root] >= 0) root = subst[root];
+      if (root == ins.arg1.number()) continue;     // a cycle of copies
+      subst[ins.arg1.number()] = root;
+      ctx.remove(i);
+    }
+    if (not ctx.changed) return;
+    // replacement of a temporary (following chains of copies)
+    auto replace = [&](operand &a) {
+      if (not a.isTemp() or subst[a.number()] < 0) return;
+      int n = a.number();
+      while (subst[n] >= 0) n = subst[n];
+      a = operand::temp(n);
+    };
+    for (auto & ins : ctx.code) {
+      unsigned used = ins.used_args();
+      if (used & instruction::ARG1) replace(ins.arg1);
+      if (used & instruction::ARG2) replace(ins.arg2);
+      if (used & instruction::ARG3) replace(ins.arg3);
+    }
+  }
+
+  // %t = a op b; x = %t   =>   x = a op b   (%t used only there)
+  void rule_def_into_copy(RuleContext &ctx) {
+    for (size_t i = 0; i+1 < ctx.code.size(); ++i) {
+      instruction & ins = ctx.code[i];
+      const instruction & next = ctx.code[i+1];
+      if (ins.defines_arg1() and ctx.info.single_def(ins.arg1) and
+          ctx.info.uses_of(ins.arg1) == 1 and is_copy(next) and next.arg2 == ins.arg1) {
+        ins.arg1 = next.arg1;
+        ctx.remove(i+1);
+        ++i;
+      }
+    }
+  }
+
+  // goto L; label L   =>   label L   (also for ifFalse)
+  void rule_jump_to_next(RuleContext &ctx) {
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      if (not ctx.code[i].is_jump()) continue;
+      const operand & target = ctx.code[i].jump_target();
+      for (size_t j = i+1; j < ctx.code.size() and ctx.code[j].oper == instruction::_LABEL; ++j)
+        if (ctx.code[j].arg1 == target) {
+          ctx.remove(i);
+          break;
+        }
+    }
+  }
+
+  // instructions after a goto or a return, up to the next label
+  void rule_unreachable(RuleContext &ctx) {
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      instruction::Operation op = ctx.code[i].oper;
+      if (op != instruction::_UJUMP and op != instruction::_RETURN) continue;
+      size_t j = i+1;
+      for (; j < ctx.code.size() and ctx.code[j].oper != instruction::_LABEL; ++j)
+        ctx.remove(j);
+      i = j-1;
+    }
+  }
+
+  // labels no jump goes to
+  void rule_unused_label(RuleContext &ctx) {
+    set<operand> targets;
+    for (auto & ins : ctx.code)
+      if (ins.is_jump()) targets.insert(ins.jump_target());
+    for (size_t i = 0; i < ctx.code.size(); ++i)
+      if (ctx.code[i].oper == instruction::_LABEL and targets.count(ctx.code[i].arg1) == 0)
+        ctx.remove(i);
+  }
+
+  // pure definitions of temporaries never used
+  void rule_dead_temp(RuleContext &ctx) {
+    for (size_t i = 0; i < ctx.code.size(); ++i) {
+      const instruction & ins = ctx.code[i];
+      if (ins.is_pure() and ins.arg1.isTemp() and ctx.info.uses_of(ins.arg1) == 0)
+        ctx.remove(i);
+    }
+  }
+
+  // table of rules, applied in this order
+  struct Rule {
+    const char *name;
+    void (*apply)(RuleContext &);
+  };
+  const Rule rules[] = {
+    { "unary-plus",    rule_add_zero },
+    { "float-literal", rule_float_literal },
+    { "copy-forward",  rule_copy_forward },
+    { "def-into-copy", rule_def_into_copy },
+    { "jump-to-next",  rule_jump_to_next },
+    { "unreachable",   rule_unreachable },
+    { "unused-label",  rule_unused_label },
+    { "dead-temp",     rule_dead_temp },
+  };
+  const size_t nRules = sizeof(rules) / sizeof(rules[0]);
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'Peephole'
+
+Peephole::Peephole() {
+  for (size_t r = 0; r < nRules; ++r) stats.push_back(RuleStats{rules[r].name, 0});
+}
+
+Peephole::~Peephole() {}
+
+const vector<Peephole::RuleStats> & Peephole::get_stats() const { return stats; }
+
+size_t Peephole::optimize(subroutine &s) {
+  instructionList code = s.get_instructions();
+  size_t initialSize = code.size();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t r = 0; r < nRules; ++r) {
+      RuleContext ctx(code, s.get_names());
+      ctx.info.compute(code);
+      ctx.removed.assign(code.size(), false);
+      rules[r].apply(ctx);
+      if (not ctx.changed) continue;
+      changed = true;
+      stats[r].removed += ctx.nRemoved;
+      if (ctx.nRemoved > 0) {
+        instructionList kept;
+        kept.reserve(code.size() - ctx.nRemoved);
+        for (size_t i = 0; i < code.size(); ++i)
+          if (not ctx.removed[i]) kept.push_back(std::move(code[i]));
+        code = std::move(kept);
+      }
+    }
+  }
+  s.set_instructions(std::move(code));
+  return initialSize - s.get_instructions().size();
+}
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////
+//
+//    Peephole - local simplifications of t-code
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <string>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class Peephole applies a table of local rewriting rules to the
+/// instructions of a subroutine until none of them applies, and
+/// counts the instructions removed by each rule.
+
+class Peephole {
+public:
+  /// number of instructions removed by a rule
+  struct RuleStats {
+    std::string rule;
+    std::size_t removed;
+  };
+
+  /// constructor and destructor
+  Peephole();
+  ~Peephole();
+
+  /// optimize a subroutine. Returns the number of removed instructions
+  std::size_t optimize(subroutine &s);
+  /// instructions removed by each rule so far (in table order)
+  const std::vector<RuleStats> & get_stats() const;
+
+private:
+  std::vector<RuleStats> stats;
+};
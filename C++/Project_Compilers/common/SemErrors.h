@@ -30,6 +30,7 @@
 
 #include "antlr4-runtime.h"
 
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -49,8 +50,8 @@ class SemErrors {
 
 public:
 
-  // Constructor
-  SemErrors() = default;
+  // Constructor (the errors are written to 'out')
+  SemErrors(std::ostream & out = std::cout);
 
   // Write the semantic errors ordered by line number
   void print ();
@@ -115,7 +116,7 @@ private:
     std::size_t getLine() const;
     std::size_t getColumnInLine() const;
     std::string getMessage() const;
-    void print() const;
+    void print(std::ostream & out) const;
   private:
     std::size_t line, coln;
     std::string message;
@@ -123,6 +124,8 @@ private:
 
   // List of semantic errors
   std::vector<ErrorInfo> ErrorList;
+  // Stream where the errors are printed
+  std::ostream *         Out;
 
   // Compare two errors to determine the order (needed in print)
   static bool less(const ErrorInfo & e1, const ErrorInfo & e2);
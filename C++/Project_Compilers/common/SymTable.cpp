@@ -44,6 +44,9 @@
 // Name of the Global Scope
 const std::string SymTable::GLOBAL_SCOPE_NAME = "$global$";
 
+// IdentId of an identifier that has not been interned
+const SymTable::IdentId SymTable::NO_IDENT = ~SymTable::IdentId(0);
+
 // Constructor
 SymTable::SymTable(TypesMgr & Types) :
   Types{Types} {
@@ -76,12 +79,39 @@ SymTable::ScopeId SymTable::topScope() const {
   return ScopeIdsStack.back();
 }
 
+// Returns the IdentId of ident, interning it if it is new
+SymTable::IdentId SymTable::internIdent(const std::string & ident) {
+  auto it = IdentIds.find(ident);
+  if (it != IdentIds.end())
+    return it->second;
+  IdentId id = IdentNames.size();
+  IdentIds.emplace(ident, id);
+  IdentNames.push_back(ident);
+  return id;
+}
+
+// Returns the IdentId of ident, or NO_IDENT if it is not interned
+// (then it is not declared in any scope)
+SymTable::IdentId SymTable::findIdent(const std::string & ident) const {
+  auto it = IdentIds.find(ident);
+  return it == IdentIds.end() ? NO_IDENT : it->second;
+}
+
+// Returns the identifier of an IdentId
+const std::string & SymTable::identName(IdentId id) const {
+  assert(id < IdentNames.size());
+  return IdentNames[id];
+}
+
 // Returns true if ident occurs in the current scope (top of the stack)
 bool SymTable::findInCurrentScope(const std::string & ident) const {
+  return findInCurrentScope(findIdent(ident));
+}
+bool SymTable::findInCurrentScope(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  return (ScopesVec[currScope].findSymbol(ident));
+  return (ScopesVec[currScope].findSymbol(id));
 }
 
 // Returns an iteger >= 0 if ident occurs in some of the scopes
@@ -89,12 +119,15 @@ bool SymTable::findInCurrentScope(const std::string & ident) const {
 // If it occurs in the scope below the top returns 1, and so on.
 // Returns -1 if te symbol is not found.
 int SymTable::findInStack(const std::string & ident) const {
+  return findInStack(findIdent(ident));
+}
+int SymTable::findInStack(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   int d = 0;
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
+    if (ScopesVec[sc].findSymbol(id))
       return d;
     ++d;
   }
@@ -103,67 +136,90 @@ int SymTable::findInStack(const std::string & ident) const {
 
 // Adds a new symbol in the current scope.
 void SymTable::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
+  addLocalVar(internIdent(ident), type);
+}
+void SymTable::addParameter(const std::string & ident, TypesMgr::TypeId type) {
+  addParameter(internIdent(ident), type);
+}
+void SymTable::addFunction(const std::string & ident, TypesMgr::TypeId type) {
+  addFunction(internIdent(ident), type);
+}
+
+void SymTable::addLocalVar(IdentId id, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addLocalVar(ident, type);
+  ScopesVec[currScope].addLocalVar(id, type);
 }
-void SymTable::addParameter(const std::string & ident, TypesMgr::TypeId type) {
+void SymTable::addParameter(IdentId id, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addParameter(ident, type);
+  ScopesVec[currScope].addParameter(id, type);
 }
 
-void SymTable::addFunction(const std::string & ident, TypesMgr::TypeId type) {
+void SymTable::addFunction(IdentId id, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addFunction(ident, type);
+  ScopesVec[currScope].addFunction(id, type);
 }
 
 // Check the class of a symbol. If not found return false
 bool SymTable::isLocalVarClass(const std::string & ident) const {
+  return isLocalVarClass(findIdent(ident));
+}
+bool SymTable::isParameterClass(const std::string & ident) const {
+  return isParameterClass(findIdent(ident));
+}
+bool SymTable::isFunctionClass(const std::string & ident) const {
+  return isFunctionClass(findIdent(ident));
+}
+
+bool SymTable::isLocalVarClass(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isLocalVarClass(ident);
+    if (ScopesVec[sc].findSymbol(id))
+      return ScopesVec[sc].isLocalVarClass(id);
   }
   return false;
 }
 
-bool SymTable::isParameterClass(const std::string & ident) const {
+bool SymTable::isParameterClass(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isParameterClass(ident);
+    if (ScopesVec[sc].findSymbol(id))
+      return ScopesVec[sc].isParameterClass(id);
   }
   return false;
 }
 
-bool SymTable::isFunctionClass(const std::string & ident) const {
+bool SymTable::isFunctionClass(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isFunctionClass(ident);
+    if (ScopesVec[sc].findSymbol(id))
+      return ScopesVec[sc].isFunctionClass(id);
   }
   return false;
 }
 
 // Get the TypeId of a symbol. If not found return type 'error'
 TypesMgr::TypeId SymTable::getType(const std::string & ident) const {
+  return getType(findIdent(ident));
+}
+TypesMgr::TypeId SymTable::getType(IdentId id) const {
   assert(not ScopeIdsStack.empty());
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].getType(ident);
+    if (ScopesVec[sc].findSymbol(id))
+      return ScopesVec[sc].getType(id);
   }
   return Types.createErrorTy();
 }
@@ -172,10 +228,11 @@ bool SymTable::noMainProperlyDeclared() const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  if ((not ScopesVec[currScope].findSymbol("main")) or
-      (not ScopesVec[currScope].isFunctionClass("main")))
+  IdentId mainId = findIdent("main");
+  if ((not ScopesVec[currScope].findSymbol(mainId)) or
+      (not ScopesVec[currScope].isFunctionClass(mainId)))
     return true;
-  TypesMgr::TypeId tid = ScopesVec[currScope].getType("main");
+  TypesMgr::TypeId tid = ScopesVec[currScope].getType(mainId);
   if (Types.isFunctionTy(tid) and
       (Types.getNumOfParameters(tid) == 0) and
       Types.isVoidFunction(tid))
@@ -186,7 +243,7 @@ bool SymTable::noMainProperlyDeclared() const {
 // Given the name of a function, returns its TypeId
 TypesMgr::TypeId SymTable::getGlobalFunctionType(const std::string & ident) const {
   assert(not ScopesVec.empty());
-  TypesMgr::TypeId tid = ScopesVec[0].getType(ident);
+  TypesMgr::TypeId tid = ScopesVec[0].getType(findIdent(ident));
   return tid;
 }
 
@@ -195,7 +252,7 @@ TypesMgr::TypeId SymTable::getLocalSymbolType(const std::string & funcName,
                                               const std::string & ident) const {
   for (std::size_t i = 1; i < ScopesVec.size(); ++i) {
     if (ScopesVec[i].getName() == funcName) {
-      TypesMgr::TypeId tid = ScopesVec[i].getType(ident);
+      TypesMgr::TypeId tid = ScopesVec[i].getType(findIdent(ident));
       return tid;
     }
   }
@@ -208,7 +265,7 @@ void SymTable::printCurrentScope() const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].print(Types);
+  ScopesVec[currScope].print(Types, IdentNames);
 }
 
 // Write the contents of the symbol table on the standard output
@@ -217,7 +274,7 @@ void SymTable::print() const {
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    ScopesVec[sc].print(Types);
+    ScopesVec[sc].print(Types, IdentNames);
   }
   std::cout << "----------------" << std::endl;
 }
@@ -229,73 +286,107 @@ void SymTable::print() const {
 SymTable::ScopeInfo::ScopeInfo(const std::string & name)
   : name{name} { }
 
-// Accessors to work with the attributes: name, SymbolsMap, IdentsList
+// Accessors to work with the attributes: name, SymbolsTable, IdentsList
 std::string SymTable::ScopeInfo::getName() const {
   return name;
 }
 
 // Mutators to add symbols to the scope
-void SymTable::ScopeInfo::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createLocalVar(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addLocalVar(IdentId id, TypesMgr::TypeId type) {
+  addSymbol(id, SymbolInfo::createLocalVar(type));
 }
-void SymTable::ScopeInfo::addParameter(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createParameter(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addParameter(IdentId id, TypesMgr::TypeId type) {
+  addSymbol(id, SymbolInfo::createParameter(type));
 }
-void SymTable::ScopeInfo::addFunction(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createFunction(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addFunction(IdentId id, TypesMgr::TypeId type) {
+  addSymbol(id, SymbolInfo::createFunction(type));
 }
 
 // Accessor to check the existence of a symbol
-bool SymTable::ScopeInfo::findSymbol(const std::string & ident) const {
-  return (SymbolsMap.find(ident) != SymbolsMap.end());
+bool SymTable::ScopeInfo::findSymbol(IdentId id) const {
+  return (lookup(id) != nullptr);
 }
 
 // Accessors to check the class of the symbol. If not found return false
-bool SymTable::ScopeInfo::isLocalVarClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
+bool SymTable::ScopeInfo::isLocalVarClass(IdentId id) const {
+  const SymbolInfo * info = lookup(id);
+  if (info == nullptr)
     return false;
-  return it->second.isLocalVarClass();
+  return info->isLocalVarClass();
 }
-bool SymTable::ScopeInfo::isParameterClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
+bool SymTable::ScopeInfo::isParameterClass(IdentId id) const {
+  const SymbolInfo * info = lookup(id);
+  if (info == nullptr)
     return false;
-  return it->second.isParameterClass();
+  return info->isParameterClass();
 }
-bool SymTable::ScopeInfo::isFunctionClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
+bool SymTable::ScopeInfo::isFunctionClass(IdentId id) const {
+  const SymbolInfo * info = lookup(id);
+  if (info == nullptr)
     return false;
-  return it->second.isFunctionClass();
+  return info->isFunctionClass();
 }
 
 // Accessor to get the TypeId of a symbol. The symbol MUST exist.
-TypesMgr::TypeId SymTable::ScopeInfo::getType(const std::string & ident) const {
-  assert(SymbolsMap.find(ident) != SymbolsMap.end());
-  auto const & it = SymbolsMap.find(ident);
-  return it->second.getType();
+TypesMgr::TypeId SymTable::ScopeInfo::getType(IdentId id) const {
+  const SymbolInfo * info = lookup(id);
+  assert(info != nullptr);
+  return info->getType();
 }
 
 // Writes the contents of the scope to the standard output.
-void SymTable::ScopeInfo::print(TypesMgr & Types) const {
+void SymTable::ScopeInfo::print(TypesMgr & Types,
+                                const std::vector<std::string> & IdentNames) const {
   std::cout << "---------------- scope name: " << name << std::endl;
   for (auto & id : IdentsList) {
-    auto const & it = SymbolsMap.find(id);
-    std::cout << id << ":" << it->second.class2string();
-    if (not it->second.isErrorClass()) {
-      std::cout << "," << Types.to_string(it->second.getType());
+    const SymbolInfo * info = lookup(id);
+    std::cout << IdentNames[id] << ":" << info->class2string();
+    if (not info->isErrorClass()) {
+      std::cout << "," << Types.to_string(info->getType());
     }
     std::cout << std::endl;
   }
 }
 
+// Finds the symbol id probing the slots from id (modulo the size of
+// the table) until it or an empty slot is found
+const SymTable::ScopeInfo::SymbolInfo * SymTable::ScopeInfo::lookup(IdentId id) const {
+  if (id == NO_IDENT or SymbolsTable.empty())
+    return nullptr;
+  std::size_t mask = SymbolsTable.size() - 1;
+  for (std::size_t i = id & mask; ; i = (i + 1) & mask) {
+    if (SymbolsTable[i].id == id)
+      return &SymbolsTable[i].info;
+    if (SymbolsTable[i].id == NO_IDENT)
+      return nullptr;
+  }
+}
+
+// Adds a symbol, doubling the table first if it would be more than
+// half full
+void SymTable::ScopeInfo::addSymbol(IdentId id, const SymbolInfo & info) {
+  assert(id != NO_IDENT and lookup(id) == nullptr);
+  if (2 * (IdentsList.size() + 1) > SymbolsTable.size()) {
+    std::vector<Slot> old;
+    old.swap(SymbolsTable);
+    std::size_t size = old.empty() ? 8 : 2 * old.size();
+    SymbolsTable.assign(size, Slot{NO_IDENT, SymbolInfo()});
+    for (auto & slot : old)
+      if (slot.id != NO_IDENT)
+        placeSymbol(slot.id, slot.info);
+  }
+  placeSymbol(id, info);
+  IdentsList.push_back(id);
+}
+
+void SymTable::ScopeInfo::placeSymbol(IdentId id, const SymbolInfo & info) {
+  std::size_t mask = SymbolsTable.size() - 1;
+  std::size_t i = id & mask;
+  while (SymbolsTable[i].id != NO_IDENT)
+    i = (i + 1) & mask;
+  SymbolsTable[i] = Slot{id, info};
+}
+
 
 // class SymTable::ScopeInfo::SymbolInfo ==========================================================
 
@@ -31,7 +31,7 @@
 #include "TypesMgr.h"
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <cstddef>    // std::size_t
@@ -57,6 +57,13 @@
 // scopes that determines which symbols are visible and
 // which are not. Entering in a function will push a new
 // scope to the stack and exiting will pop the stack.
+// Identifiers are interned: each different one gets an IdentId
+// (dense, from 0) when it is interned (declaring a symbol interns
+// its identifier), and each scope keeps its symbols in a flat hash
+// table (open addressing) keyed by IdentId. So the lookups along
+// the stack compare integers, not strings. The methods that take
+// an identifier as a string find its IdentId once, and all of
+// them are also available with the IdentId.
 
 class SymTable {
 
@@ -65,9 +72,15 @@ public:
   // The ScopeId is an index in a vector
   typedef std::size_t ScopeId;
 
+  // The IdentId of an identifier is an index in a vector
+  typedef std::size_t IdentId;
+
   // Name of the Global Scope
   static const std::string GLOBAL_SCOPE_NAME;
 
+  // IdentId of an identifier that has not been interned
+  static const IdentId NO_IDENT;
+
   // Constructor
   SymTable(TypesMgr & Types);
   // Destructor
@@ -83,25 +96,42 @@ public:
   //   - returns the current scope
   ScopeId topScope      ()                          const;
 
+  // Interned identifiers
+  //   - returns the IdentId of ident, interning it if it is new
+  IdentId internIdent (const std::string & ident);
+  //   - returns the IdentId of ident, or NO_IDENT if it is not interned
+  IdentId findIdent   (const std::string & ident)                    const;
+  //   - returns the identifier of an IdentId
+  const std::string & identName (IdentId id)                         const;
+
   // Methods to find an ident
   //   - in the current scope (top of the stack)
   bool    findInCurrentScope (const std::string & ident)             const;
+  bool    findInCurrentScope (IdentId id)                            const;
   //   - in the whole stack. Returns the number of scopes skipped to
                           // find the symbol, or -1 if it is not found
   int     findInStack        (const std::string & ident)             const;
+  int     findInStack        (IdentId id)                            const;
 
   // Adds a new symbol in the current scope
   void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
   void addParameter (const std::string & ident, TypesMgr::TypeId type);
   void addFunction  (const std::string & ident, TypesMgr::TypeId type);
+  void addLocalVar  (IdentId id, TypesMgr::TypeId type);
+  void addParameter (IdentId id, TypesMgr::TypeId type);
+  void addFunction  (IdentId id, TypesMgr::TypeId type);
 
   // Accessors to check the class of the symbol. If not found return false
   bool isLocalVarClass  (const std::string & ident) const;
   bool isParameterClass (const std::string & ident) const;
   bool isFunctionClass  (const std::string & ident) const;
+  bool isLocalVarClass  (IdentId id) const;
+  bool isParameterClass (IdentId id) const;
+  bool isFunctionClass  (IdentId id) const;
 
   // Accessor to get the TypeId of a symbol. If not found return type 'error'
   TypesMgr::TypeId getType (const std::string & ident) const;
+  TypesMgr::TypeId getType (IdentId id) const;
 
   // Check the existence of the "main" function
   bool noMainProperlyDeclared() const;
@@ -127,6 +157,10 @@ private:
   TypesMgr               & Types;
   std::vector<ScopeInfo>   ScopesVec;
   std::vector<ScopeId>     ScopeIdsStack;
+  // The interned identifiers: the IdentId of each one, and the
+  // identifier of each IdentId
+  std::unordered_map<std::string, IdentId> IdentIds;
+  std::vector<std::string>                 IdentNames;
 
   //////////////////////////////////////////////////////////////////
   // Class ScopeInfo: is declared inside SymTable and is private,
@@ -143,35 +177,51 @@ private:
     std::string getName () const;
 
     // Mutators to add symbols to the scope
-    void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
-    void addParameter (const std::string & ident, TypesMgr::TypeId type);
-    void addFunction  (const std::string & ident, TypesMgr::TypeId type);
+    void addLocalVar  (IdentId id, TypesMgr::TypeId type);
+    void addParameter (IdentId id, TypesMgr::TypeId type);
+    void addFunction  (IdentId id, TypesMgr::TypeId type);
 
     // Accessor to check the existence of a symbol
-    bool findSymbol (const std::string & ident) const;
+    bool findSymbol (IdentId id) const;
 
     // Accessors to check the class of the symbol. If not found return false
-    bool isLocalVarClass  (const std::string & ident) const;
-    bool isParameterClass (const std::string & ident) const;
-    bool isFunctionClass  (const std::string & ident) const;
+    bool isLocalVarClass  (IdentId id) const;
+    bool isParameterClass (IdentId id) const;
+    bool isFunctionClass  (IdentId id) const;
 
     // Accessor to get the TypeId of a symbol. The symbol MUST exist
-    TypesMgr::TypeId getType (const std::string & ident) const;
+    TypesMgr::TypeId getType (IdentId id) const;
 
     // Writes the contents of the scope to the standard output
-    void print (TypesMgr & Types) const;
+    // (with the identifiers of the IdentIds in IdentNames)
+    void print (TypesMgr & Types, const std::vector<std::string> & IdentNames) const;
 
   private:
 
     // Formard decration of class SymbolInfo
     class SymbolInfo;
 
+    // A slot of the table of symbols: an IdentId (NO_IDENT if the
+    // slot is empty) and the information of its symbol
+    struct Slot;
+
+    // Returns the information of the symbol id, or null if it is not
+    // declared in this scope
+    const SymbolInfo * lookup (IdentId id) const;
+    // Adds the symbol id, which is not in the scope
+    void addSymbol (IdentId id, const SymbolInfo & info);
+    // Puts the symbol id in its slot of SymbolsTable
+    void placeSymbol (IdentId id, const SymbolInfo & info);
+
     // For the name of the scope
     std::string name;
-    // The information associated to each identifier declared in this scope.
-    std::map<std::string, SymbolInfo> SymbolsMap;
+    // The information associated to each identifier declared in this
+    // scope: a hash table with linear probing, whose size is a power
+    // of two, at most half full. IdentIds are dense, so an IdentId is
+    // its own hash value.
+    std::vector<Slot> SymbolsTable;
     // For remember the order in which the Ids where introduced.
-    std::vector<std::string> IdentsList;
+    std::vector<IdentId> IdentsList;
 
 
     //////////////////////////////////////////////////////////////////
@@ -217,6 +267,11 @@ private:
 
     };  // class SymbolInfo
 
+    struct Slot {
+      IdentId    id;
+      SymbolInfo info;
+    };
+
   };  // class ScopeInfo
 
 };  // class SymTable
@@ -0,0 +1,734 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeVM - in-process interpreter for t-code programs
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TCodeVM.h"
+
+#include <cstdlib>      // EXIT_SUCCESS, EXIT_FAILURE, strtof
+#include <cstring>      // memcpy, memcmp, memmove
+#include <fstream>
+
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+
+using namespace std;
+
+
+namespace {
+
+  // maximum number of cells in the stack (256 MB)
+  const size_t MAX_STACK_CELLS = size_t(1) << 26;
+
+  // header of an object file
+  struct ObjHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t  mainFunc;
+    uint32_t nInstrs, nFuncs, nVars, stringsSize;
+    uint32_t instrsOffset, funcsOffset, varsOffset, stringsOffset;
+  };
+  const char OBJ_MAGIC[4] = {'T', 'C', 'O', 'D'};
+  const uint32_t OBJ_BYTE_ORDER = 0x01020304;
+
+  // round up to a multiple of 4
+  uint32_t align4(uint64_t n) { return (n + 3) & ~uint64_t(3); }
+
+  // value of an escaped char ("n" -> '\n'...)
+  char escaped(char c) {
+    switch (c) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case '0': return '\0';
+    default:  return c;     // \\, \', \"
+    }
+  }
+
+  // decode a char literal ('a', '\n'...)
+  bool char_literal(const string &s, int32_t &value) {
+    if (s.size() == 3 and s[0] == '\'' and s[2] == '\'') {
+      value = (unsigned char) s[1];
+      return true;
+    }
+    if (s.size() == 4 and s[0] == '\'' and s[1] == '\\' and s[3] == '\'') {
+      value = (unsigned char) escaped(s[2]);
+      return true;
+    }
+    return false;
+  }
+
+  // decode a float literal (the whole string must be consumed)
+  bool float_literal(const string &s, float &value) {
+    if (s.empty()) return false;
+    char *end;
+    value = strtof(s.c_str(), &end);
+    return *end == '\0';
+  }
+
+  // raw bits of a float
+  int32_t float_bits(float f) {
+    int32_t i;
+    memcpy(&i, &f, sizeof(i));
+    return i;
+  }
+
+  // contents of a string literal, without quotes and with escapes processed
+  string string_literal(const string &s) {
+    string res;
+    size_t last = s.size();
+    size_t i = 0;
+    if (last >= 2 and s[0] == '"' and s[last-1] == '"') { i = 1; --last; }
+    for (; i < last; ++i) {
+      if (s[i] == '\\' and i+1 < last) res += escaped(s[++i]);
+      else res += s[i];
+    }
+    return res;
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'TCodeImage'
+
+TCodeImage::TCodeImage() : instrs(nullptr), funcs(nullptr), vars(nullptr), strings(nullptr),
+                           nInstrs(0), nFuncs(0), nVars(0), stringsSize(0), mainFunc(-1),
+                           mapping(nullptr), mappingSize(0) {}
+
+TCodeImage::~TCodeImage() { release(); }
+
+void TCodeImage::release() {
+  if (mapping) munmap(mapping, mappingSize);
+  mapping = nullptr;
+  mappingSize = 0;
+  ownInstrs.clear();  ownFuncs.clear();  ownVars.clear();  ownStrings.clear();
+  instrs = nullptr;   funcs = nullptr;   vars = nullptr;   strings = nullptr;
+  nInstrs = nFuncs = nVars = stringsSize = 0;
+  mainFunc = -1;
+}
+
+const string & TCodeImage::error() const { return errorMsg; }
+
+string TCodeImage::function_name(int32_t f) const {
+  return string(strings + funcs[f].name);
+}
+
+int32_t TCodeImage::add_string(const string &s) {
+  int32_t offset = ownStrings.size();
+  ownStrings += s;
+  ownStrings += '\0';
+  return offset;
+}
+
+void TCodeImage::set_views() {
+  instrs = ownInstrs.data();      nInstrs = ownInstrs.size();
+  funcs = ownFuncs.data();        nFuncs = ownFuncs.size();
+  vars = ownVars.data();          nVars = ownVars.size();
+  strings = ownStrings.data();    stringsSize = ownStrings.size();
+}
+
+bool TCodeImage::build(const code &c) {
+  release();
+  errorMsg.clear();
+
+  const vector<subroutine> & subs = c.get_subroutine_list();
+  map<string, int32_t> funcIndex;
+  for (size_t f = 0; f < subs.size(); ++f) {
+    funcIndex[subs[f].get_name()] = f;
+    if (subs[f].get_name() == "main") mainFunc = f;
+  }
+  if (mainFunc < 0) {
+    errorMsg = "t-code error: there is no function 'main'";
+    return false;
+  }
+
+  ownFuncs.resize(subs.size());
+  for (size_t f = 0; f < subs.size(); ++f)
+    if (not build_function(subs[f], f, funcIndex)) return false;
+
+  set_views();
+  return true;
+}
+
+bool TCodeImage::build_function(const subroutine &s, int32_t index,
+                                const map<string, int32_t> &funcIndex) {
+  const instructionList & inss = s.get_instructions();
+  Function & func = ownFuncs[index];
+  func.name = add_string(s.get_name());
+  func.entry = ownInstrs.size();
+  func.firstVar = ownVars.size();
+
+  // frame layout: params, local variables and temporaries
+  map<string, int32_t> slots;
+  map<string, bool> isLocal;      // local variables are stored in the frame
+  int32_t nSlots = 0;
+  for (auto & p : s.params) {
+    ownVars.push_back(Variable{add_string(p.name), nSlots, 1});
+    slots[p.name] = nSlots++;
+    isLocal[p.name] = false;
+  }
+  func.nParams = nSlots;
+  for (auto & v : s.vars) {
+    int32_t size = v.size > 0 ? v.size : 1;
+    ownVars.push_back(Variable{add_string(v.name), nSlots, size});
+    slots[v.name] = nSlots;
+    isLocal[v.name] = true;
+    nSlots += size;
+  }
+  func.nVars = ownVars.size() - func.firstVar;
+
+  // first pass: temporaries, labels and pushes
+  int32_t tempBase = nSlots;
+  int32_t maxTemp = -1;
+  int32_t nPushes = 0;
+  map<string, int32_t> labels;
+  int32_t pc = func.entry;
+  for (auto & ins : inss) {
+    for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+      if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+    if (ins.oper == instruction::_LABEL) labels[ins.arg1.str()] = pc;
+    else if (ins.oper != instruction::_NOOP) ++pc;
+    if (ins.oper == instruction::_PUSH) ++nPushes;
+  }
+  func.frameSize = tempBase + maxTemp + 1;
+  func.stackSize = func.frameSize + nPushes;
+
+  string where = "t-code error in function '" + s.get_name() + "': ";
+  bool ok = true;
+  // slot of a variable or temporary
+  auto slot = [&](const operand &a) -> int32_t {
+    if (a.isTemp()) return tempBase + a.number();
+    auto it = slots.find(a.str());
+    if (it != slots.end()) return it->second;
+    if (ok) errorMsg = where + "invalid operand '" + a.str() + "'";
+    ok = false;
+    return 0;
+  };
+  // instruction index of a label
+  auto label = [&](const operand &a) -> int32_t {
+    auto it = labels.find(a.str());
+    if (it != labels.end()) return it->second;
+    if (ok) errorMsg = where + "undefined label '" + a.str() + "'";
+    ok = false;
+    return 0;
+  };
+  // is the operand an array stored in the frame (not an address)?
+  auto local = [&](const operand &a) -> bool {
+    auto it = isLocal.find(a.str());
+    return not a.isTemp() and it != isLocal.end() and it->second;
+  };
+
+  for (auto & ins : inss) {
+    Instr d = {_NOOP, 0, 0, 0};
+    switch (ins.oper) {
+    case instruction::_LABEL:
+    case instruction::_NOOP:
+      continue;
+    case instruction::_UJUMP: d = Instr{_JUMP, label(ins.arg1), 0, 0}; break;
+    case instruction::_FJUMP: d = Instr{_FJUMP, slot(ins.arg1), label(ins.arg2), 0}; break;
+    case instruction::_JEQ:  case instruction::_JLT:  case instruction::_JLE:
+    case instruction::_JNEQ: case instruction::_JNLT: case instruction::_JNLE:
+    case instruction::_FJEQ:  case instruction::_FJLT:  case instruction::_FJLE:
+    case instruction::_FJNEQ: case instruction::_FJNLT: case instruction::_FJNLE: {
+      // both enumerations list the compare-and-jumps in the same order
+      OpCode op = OpCode(_JEQ + (ins.oper - instruction::_JEQ));
+      d = Instr{op, slot(ins.arg1), slot(ins.arg2), label(ins.arg3)};
+      break;
+    }
+    case instruction::_PUSH:
+      if (ins.arg1.empty()) d.op = _PUSH_NONE;
+      else d = Instr{_PUSH, slot(ins.arg1), 0, 0};
+      break;
+    case instruction::_POP:
+      if (ins.arg1.empty()) d.op = _POP_NONE;
+      else d = Instr{_POP, slot(ins.arg1), 0, 0};
+      break;
+    case instruction::_CALL: {
+      auto it = funcIndex.find(ins.arg1.str());
+      if (it == funcIndex.end()) {
+        if (ok) errorMsg = where + "call to undefined function '" + ins.arg1.str() + "'";
+        ok = false;
+      }
+      else d = Instr{_CALL, it->second, 0, 0};
+      break;
+    }
+    case instruction::_RETURN: d.op = _RETURN; break;
+
+    case instruction::_ADD:  d.op = _ADD;  break;
+    case instruction::_SUB:  d.op = _SUB;  break;
+    case instruction::_MUL:  d.op = _MUL;  break;
+    case instruction::_DIV:  d.op = _DIV;  break;
+    case instruction::_MOD:  d.op = _MOD;  break;
+    case instruction::_EQ:   d.op = _EQ;   break;
+    case instruction::_LT:   d.op = _LT;   break;
+    case instruction::_LE:   d.op = _LE;   break;
+    case instruction::_AND:  d.op = _AND;  break;
+    case instruction::_OR:   d.op = _OR;   break;
+    case instruction::_FADD: d.op = _FADD; break;
+    case instruction::_FSUB: d.op = _FSUB; break;
+    case instruction::_FMUL: d.op = _FMUL; break;
+    case instruction::_FDIV: d.op = _FDIV; break;
+    case instruction::_FMOD: d.op = _FMOD; break;
+    case instruction::_FEQ:  d.op = _FEQ;  break;
+    case instruction::_FLT:  d.op = _FLT;  break;
+    case instruction::_FLE:  d.op = _FLE;  break;
+    case instruction::_NEG:   d = Instr{_NEG, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_NOT:   d = Instr{_NOT, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_FLOAT: d = Instr{_FLOAT, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_FNEG:  d = Instr{_FNEG, slot(ins.arg1), slot(ins.arg2), 0}; break;
+
+    case instruction::_LOAD:
+    case instruction::_ILOAD:
+    case instruction::_CHLOAD:
+    case instruction::_FLOAD: {
+      const operand & src = ins.arg2;
+      if (src.isTemp() or src.isSymbol()) {
+        d = Instr{_MOVE, slot(ins.arg1), slot(src), 0};
+        break;
+      }
+      // immediate: an int, a char or a float literal
+      int32_t value = 0;
+      float fvalue;
+      bool isFloat = ins.oper == instruction::_FLOAD;
+      if (src.isInt()) value = isFloat ? float_bits(src.number()) : src.number();
+      else if (char_literal(src.str(), value)) {}
+      else if (ins.oper != instruction::_ILOAD and ins.oper != instruction::_CHLOAD and
+               float_literal(src.str(), fvalue)) value = float_bits(fvalue);
+      else {
+        if (ok) errorMsg = where + "invalid constant '" + src.str() + "'";
+        ok = false;
+      }
+      d = Instr{_CONST, slot(ins.arg1), value, 0};
+      break;
+    }
+    case instruction::_XLOAD:
+      d = Instr{local(ins.arg1) ? _XLOAD : _XLOAD_PTR, slot(ins.arg1), slot(ins.arg2), slot(ins.arg3)};
+      break;
+    case instruction::_LOADX:
+      d = Instr{local(ins.arg2) ? _LOADX : _LOADX_PTR, slot(ins.arg1), slot(ins.arg2), slot(ins.arg3)};
+      break;
+    case instruction::_ALOAD: d = Instr{_ALOAD, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_LOADC: d = Instr{_LOADC, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_CLOAD: d = Instr{_CLOAD, slot(ins.arg1), slot(ins.arg2), 0}; break;
+    case instruction::_ACOPY: {
+      bool dstPtr = not local(ins.arg1), srcPtr = not local(ins.arg2);
+      OpCode op = dstPtr ? (srcPtr ? _ACOPY_PTR : _ACOPY_DST_PTR) : (srcPtr ? _ACOPY_SRC_PTR : _ACOPY);
+      if (not ins.arg3.isInt() or ins.arg3.number() < 0) {
+        if (ok) errorMsg = where + "invalid array size '" + ins.arg3.str() + "'";
+        ok = false;
+      }
+      d = Instr{op, slot(ins.arg1), slot(ins.arg2), ins.arg3.number()};
+      break;
+    }
+
+    case instruction::_READI:  d = Instr{_READI, slot(ins.arg1), 0, 0}; break;
+    case instruction::_READF:  d = Instr{_READF, slot(ins.arg1), 0, 0}; break;
+    case instruction::_READC:  d = Instr{_READC, slot(ins.arg1), 0, 0}; break;
+    case instruction::_WRITEI: d = Instr{_WRITEI, slot(ins.arg1), 0, 0}; break;
+    case instruction::_WRITEF: d = Instr{_WRITEF, slot(ins.arg1), 0, 0}; break;
+    case instruction::_WRITEC: d = Instr{_WRITEC, slot(ins.arg1), 0, 0}; break;
+    case instruction::_WRITES: {
+      string text = string_literal(ins.arg1.str());
+      d = Instr{_WRITES, add_string(text), int32_t(text.size()), 0};
+      break;
+    }
+    case instruction::_WRITELN: d.op = _WRITELN; break;
+    default:
+      if (ok) errorMsg = where + "unknown instruction '" + ins.dump() + "'";
+      ok = false;
+    }
+    // operands of the binary operations
+    if (d.op >= _ADD and d.op <= _OR) {
+      d.a = slot(ins.arg1);  d.b = slot(ins.arg2);  d.c = slot(ins.arg3);
+    }
+    else if (d.op >= _FADD and d.op <= _FLE) {
+      d.a = slot(ins.arg1);  d.b = slot(ins.arg2);  d.c = slot(ins.arg3);
+    }
+    if (not ok) return false;
+    ownInstrs.push_back(d);
+  }
+  // functions fall back to their caller at the end
+  ownInstrs.push_back(Instr{_RETURN, 0, 0, 0});
+  func.nInstrs = ownInstrs.size() - func.entry;
+  return true;
+}
+
+
+bool TCodeImage::save(const string &fileName) const {
+  ObjHeader h;
+  memcpy(h.magic, OBJ_MAGIC, sizeof(h.magic));
+  h.version = VERSION;
+  h.byteOrder = OBJ_BYTE_ORDER;
+  h.mainFunc = mainFunc;
+  h.nInstrs = nInstrs;  h.nFuncs = nFuncs;  h.nVars = nVars;  h.stringsSize = stringsSize;
+  h.instrsOffset = align4(sizeof(h));
+  h.funcsOffset = align4(h.instrsOffset + uint64_t(nInstrs) * sizeof(Instr));
+  h.varsOffset = align4(h.funcsOffset + uint64_t(nFuncs) * sizeof(Function));
+  h.stringsOffset = align4(h.varsOffset + uint64_t(nVars) * sizeof(Variable));
+
+  ofstream f(fileName, ofstream::binary);
+  // write a section, padding the file up to its offset
+  auto section = [&](uint32_t offset, const void *data, size_t size) {
+    while (uint32_t(f.tellp()) < offset) f.put('\0');
+    f.write(static_cast<const char *>(data), size);
+  };
+  section(0, &h, sizeof(h));
+  section(h.instrsOffset, instrs, nInstrs * sizeof(Instr));
+  section(h.funcsOffset, funcs, nFuncs * sizeof(Function));
+  section(h.varsOffset, vars, nVars * sizeof(Variable));
+  section(h.stringsOffset, strings, stringsSize);
+  f.close();
+  return bool(f);
+}
+
+bool TCodeImage::load(const string &fileName) {
+  release();
+  errorMsg = "cannot load object file '" + fileName + "': ";
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    errorMsg += "no such file";
+    return false;
+  }
+  struct stat st;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &st) == 0 and size_t(st.st_size) >= sizeof(ObjHeader))
+    p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    errorMsg += "not an object file";
+    return false;
+  }
+  mapping = p;
+  mappingSize = st.st_size;
+
+  const char *base = static_cast<const char *>(mapping);
+  const ObjHeader & h = *static_cast<const ObjHeader *>(mapping);
+  if (memcmp(h.magic, OBJ_MAGIC, sizeof(h.magic)) != 0 or h.byteOrder != OBJ_BYTE_ORDER) {
+    errorMsg += "not an object file";
+    release();
+    return false;
+  }
+  if (h.version != VERSION) {
+    errorMsg += "version " + to_string(h.version) + " (expected " + to_string(VERSION) + ")";
+    release();
+    return false;
+  }
+  // every section must be aligned and lie inside the file
+  auto inside = [&](uint32_t offset, uint64_t size) {
+    return offset % 4 == 0 and offset >= sizeof(ObjHeader) and offset + size <= mappingSize;
+  };
+  if (not inside(h.instrsOffset, uint64_t(h.nInstrs) * sizeof(Instr)) or
+      not inside(h.funcsOffset, uint64_t(h.nFuncs) * sizeof(Function)) or
+      not inside(h.varsOffset, uint64_t(h.nVars) * sizeof(Variable)) or
+      not inside(h.stringsOffset, h.stringsSize)) {
+    errorMsg += "truncated file";
+    release();
+    return false;
+  }
+
+  instrs = reinterpret_cast<const Instr *>(base + h.instrsOffset);
+  funcs = reinterpret_cast<const Function *>(base + h.funcsOffset);
+  vars = reinterpret_cast<const Variable *>(base + h.varsOffset);
+  strings = base + h.stringsOffset;
+  nInstrs = h.nInstrs;  nFuncs = h.nFuncs;  nVars = h.nVars;  stringsSize = h.stringsSize;
+  mainFunc = h.mainFunc;
+  if (not validate()) {
+    errorMsg += "corrupt contents";
+    release();
+    return false;
+  }
+  errorMsg.clear();
+  return true;
+}
+
+bool TCodeImage::validate() {
+  if (mainFunc < 0 or uint32_t(mainFunc) >= nFuncs) return false;
+  if (stringsSize == 0 or strings[stringsSize-1] != '\0') return false;
+  for (uint32_t v = 0; v < nVars; ++v)
+    if (vars[v].name < 0 or uint32_t(vars[v].name) >= stringsSize) return false;
+
+  for (uint32_t f = 0; f < nFuncs; ++f) {
+    const Function & fn = funcs[f];
+    if (fn.name < 0 or uint32_t(fn.name) >= stringsSize) return false;
+    if (fn.entry < 0 or fn.nInstrs < 1 or uint64_t(fn.entry) + fn.nInstrs > nInstrs) return false;
+    if (fn.nParams < 0 or fn.frameSize < fn.nParams or fn.stackSize < fn.frameSize) return false;
+    if (fn.firstVar < 0 or fn.nVars < 0 or uint64_t(fn.firstVar) + fn.nVars > nVars) return false;
+    // the code of a function must not fall through its end
+    int32_t last = instrs[fn.entry + fn.nInstrs - 1].op;
+    if (last != _RETURN and last != _JUMP) return false;
+
+    auto isSlot = [&](int32_t x) { return x >= 0 and x < fn.frameSize; };
+    auto isTarget = [&](int32_t x) { return x >= fn.entry and x < fn.entry + fn.nInstrs; };
+    for (int32_t pc = fn.entry; pc < fn.entry + fn.nInstrs; ++pc) {
+      const Instr & d = instrs[pc];
+      bool ok;
+      switch (d.op) {
+      case _JUMP:  ok = isTarget(d.a); break;
+      case _FJUMP: ok = isSlot(d.a) and isTarget(d.b); break;
+      case _JEQ: case _JLT: case _JLE: case _JNEQ: case _JNLT: case _JNLE:
+      case _FJEQ: case _FJLT: case _FJLE: case _FJNEQ: case _FJNLT: case _FJNLE:
+        ok = isSlot(d.a) and isSlot(d.b) and isTarget(d.c); break;
+      case _CALL:  ok = d.a >= 0 and uint32_t(d.a) < nFuncs; break;
+      case _WRITES:
+        ok = d.a >= 0 and d.b >= 0 and uint64_t(d.a) + d.b <= stringsSize; break;
+      case _PUSH_NONE: case _POP_NONE: case _RETURN: case _WRITELN: case _NOOP:
+        ok = true; break;
+      case _PUSH: case _POP: case _CONST:
+      case _READI: case _READF: case _READC: case _WRITEI: case _WRITEF: case _WRITEC:
+        ok = isSlot(d.a); break;
+      case _NEG: case _NOT: case _FLOAT: case _FNEG: case _MOVE:
+      case _ALOAD: case _LOADC: case _CLOAD:
+        ok = isSlot(d.a) and isSlot(d.b); break;
+      case _ADD: case _SUB: case _MUL: case _DIV: case _MOD: case _EQ: case _LT: case _LE: case _AND: case _OR:
+      case _FADD: case _FSUB: case _FMUL: case _FDIV: case _FMOD: case _FEQ: case _FLT: case _FLE:
+      case _XLOAD: case _XLOAD_PTR: case _LOADX: case _LOADX_PTR:
+        ok = isSlot(d.a) and isSlot(d.b) and isSlot(d.c); break;
+      case _ACOPY: case _ACOPY_DST_PTR: case _ACOPY_SRC_PTR: case _ACOPY_PTR:
+        ok = isSlot(d.a) and isSlot(d.b) and d.c >= 0; break;
+      default:
+        ok = false;
+      }
+      if (not ok) return false;
+    }
+  }
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'TCodeVM'
+
+TCodeVM::TCodeVM(const TCodeImage &img, istream &i, ostream &o) : image(img), in(i), out(o) {}
+
+TCodeVM::~TCodeVM() {}
+
+bool TCodeVM::grow(size_t needed) {
+  if (needed <= mem.size()) return true;
+  if (needed > MAX_STACK_CELLS) return false;
+  mem.resize(min(max(needed, 2*mem.size()), MAX_STACK_CELLS));
+  return true;
+}
+
+int TCodeVM::runtime_error(const string &msg, int32_t func) const {
+  out.flush();
+  cerr << "Runtime error in function '" << image.function_name(func) << "': " << msg << endl;
+  return EXIT_FAILURE;
+}
+
+int TCodeVM::run() {
+  typedef TCodeImage T;
+  const T::Instr *code = image.instrs;
+  const T::Function *funcs = image.funcs;
+
+  int32_t func = image.mainFunc;
+  calls.clear();
+  mem.clear();
+  if (not grow(funcs[func].stackSize)) return runtime_error("stack overflow", func);
+  Cell *m = mem.data();
+  Cell *fp = m;
+  int32_t sp = funcs[func].frameSize;
+  for (int32_t i = 0; i < sp; ++i) m[i].i = 0;
+  // pushed params live in [bottom, top): the end of the current frame
+  // and the end of the stack (unbalanced code is caught there)
+  int32_t bottom = sp;
+  int32_t top = mem.size();
+
+  const T::Instr *pc = code + funcs[func].entry;
+  for (;;) {
+    const T::Instr & ins = *pc++;
+    switch (ins.op) {
+    case T::_JUMP:  pc = code + ins.a; break;
+    case T::_FJUMP: if (not fp[ins.a].i) pc = code + ins.b; break;
+    case T::_JEQ:   if (fp[ins.a].i == fp[ins.b].i) pc = code + ins.c; break;
+    case T::_JLT:   if (fp[ins.a].i <  fp[ins.b].i) pc = code + ins.c; break;
+    case T::_JLE:   if (fp[ins.a].i <= fp[ins.b].i) pc = code + ins.c; break;
+    case T::_JNEQ:  if (not (fp[ins.a].i == fp[ins.b].i)) pc = code + ins.c; break;
+    case T::_JNLT:  if (not (fp[ins.a].i <  fp[ins.b].i)) pc = code + ins.c; break;
+    case T::_JNLE:  if (not (fp[ins.a].i <= fp[ins.b].i)) pc = code + ins.c; break;
+    case T::_FJEQ:  if (fp[ins.a].f == fp[ins.b].f) pc = code + ins.c; break;
+    case T::_FJLT:  if (fp[ins.a].f <  fp[ins.b].f) pc = code + ins.c; break;
+    case T::_FJLE:  if (fp[ins.a].f <= fp[ins.b].f) pc = code + ins.c; break;
+    case T::_FJNEQ: if (not (fp[ins.a].f == fp[ins.b].f)) pc = code + ins.c; break;
+    case T::_FJNLT: if (not (fp[ins.a].f <  fp[ins.b].f)) pc = code + ins.c; break;
+    case T::_FJNLE: if (not (fp[ins.a].f <= fp[ins.b].f)) pc = code + ins.c; break;
+
+    case T::_PUSH:
+      if (sp == top) return runtime_error("stack overflow", func);
+      m[sp++] = fp[ins.a];
+      break;
+    case T::_PUSH_NONE:
+      if (sp == top) return runtime_error("stack overflow", func);
+      m[sp++].i = 0;
+      break;
+    case T::_POP:
+      if (sp == bottom) return runtime_error("popparam without pushparam", func);
+      fp[ins.a] = m[--sp];
+      break;
+    case T::_POP_NONE:
+      if (sp == bottom) return runtime_error("popparam without pushparam", func);
+      --sp;
+      break;
+
+    case T::_CALL: {
+      const T::Function & f = funcs[ins.a];
+      int32_t newfp = sp - f.nParams;
+      if (newfp < bottom) return runtime_error("missing parameters calling '" +
+                                               image.function_name(ins.a) + "'", func);
+      int32_t fpi = fp - m;
+      if (not grow(size_t(newfp) + f.stackSize)) return runtime_error("stack overflow", ins.a);
+      m = mem.data();
+      top = mem.size();
+      calls.push_back(Activation{pc, fpi, func});
+      func = ins.a;
+      fp = m + newfp;
+      for (int32_t i = f.nParams; i < f.frameSize; ++i) fp[i].i = 0;
+      sp = bottom = newfp + f.frameSize;
+      pc = code + f.entry;
+      break;
+    }
+    case T::_RETURN: {
+      if (calls.empty()) {
+        out.flush();
+        return EXIT_SUCCESS;
+      }
+      sp = (fp - m) + funcs[func].nParams;
+      const Activation & act = calls.back();
+      pc = act.ret;
+      fp = m + act.fp;
+      func = act.func;
+      bottom = act.fp + funcs[func].frameSize;
+      calls.pop_back();
+      break;
+    }
+
+    // integer arithmetic wraps around as in the hardware
+    case T::_ADD: fp[ins.a].i = int32_t(uint32_t(fp[ins.b].i) + uint32_t(fp[ins.c].i)); break;
+    case T::_SUB: fp[ins.a].i = int32_t(uint32_t(fp[ins.b].i) - uint32_t(fp[ins.c].i)); break;
+    case T::_MUL: fp[ins.a].i = int32_t(uint32_t(fp[ins.b].i) * uint32_t(fp[ins.c].i)); break;
+    case T::_DIV: {
+      int32_t x = fp[ins.b].i, y = fp[ins.c].i;
+      if (y == 0) return runtime_error("division by zero", func);
+      fp[ins.a].i = (y == -1) ? int32_t(0u - uint32_t(x)) : x / y;
+      break;
+    }
+    case T::_MOD: {
+      int32_t x = fp[ins.b].i, y = fp[ins.c].i;
+      if (y == 0) return runtime_error("division by zero", func);
+      fp[ins.a].i = (y == -1) ? 0 : x % y;
+      break;
+    }
+    case T::_EQ:  fp[ins.a].i = fp[ins.b].i == fp[ins.c].i; break;
+    case T::_LT:  fp[ins.a].i = fp[ins.b].i <  fp[ins.c].i; break;
+    case T::_LE:  fp[ins.a].i = fp[ins.b].i <= fp[ins.c].i; break;
+    case T::_AND: fp[ins.a].i = fp[ins.b].i and fp[ins.c].i; break;
+    case T::_OR:  fp[ins.a].i = fp[ins.b].i or  fp[ins.c].i; break;
+    case T::_NEG: fp[ins.a].i = int32_t(0u - uint32_t(fp[ins.b].i)); break;
+    case T::_NOT: fp[ins.a].i = not fp[ins.b].i; break;
+    case T::_FLOAT: fp[ins.a].f = float(fp[ins.b].i); break;
+
+    case T::_FADD: fp[ins.a].f = fp[ins.b].f + fp[ins.c].f; break;
+    case T::_FSUB: fp[ins.a].f = fp[ins.b].f - fp[ins.c].f; break;
+    case T::_FMUL: fp[ins.a].f = fp[ins.b].f * fp[ins.c].f; break;
+    case T::_FDIV: fp[ins.a].f = fp[ins.b].f / fp[ins.c].f; break;
+    case T::_FMOD: {   // the sequence tvm runs (code::expand_for_tvm)
+      float quot = fp[ins.b].f / fp[ins.c].f, prod = quot * fp[ins.c].f;
+      fp[ins.a].f = fp[ins.b].f - prod;
+      break;
+    }
+    case T::_FEQ:  fp[ins.a].i = fp[ins.b].f == fp[ins.c].f; break;
+    case T::_FLT:  fp[ins.a].i = fp[ins.b].f <  fp[ins.c].f; break;
+    case T::_FLE:  fp[ins.a].i = fp[ins.b].f <= fp[ins.c].f; break;
+    case T::_FNEG: fp[ins.a].f = -fp[ins.b].f; break;
+
+    case T::_MOVE:  fp[ins.a] = fp[ins.b]; break;
+    case T::_CONST: fp[ins.a].i = ins.b; break;
+
+    // accesses through an address are checked against the stack bounds
+    case T::_XLOAD: {
+      int32_t addr = (fp - m) + ins.a + fp[ins.b].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      m[addr] = fp[ins.c];
+      break;
+    }
+    case T::_XLOAD_PTR: {
+      int32_t addr = fp[ins.a].i + fp[ins.b].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      m[addr] = fp[ins.c];
+      break;
+    }
+    case T::_LOADX: {
+      int32_t addr = (fp - m) + ins.b + fp[ins.c].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      fp[ins.a] = m[addr];
+      break;
+    }
+    case T::_LOADX_PTR: {
+      int32_t addr = fp[ins.b].i + fp[ins.c].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      fp[ins.a] = m[addr];
+      break;
+    }
+    case T::_LOADC: {
+      int32_t addr = fp[ins.b].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      fp[ins.a] = m[addr];
+      break;
+    }
+    case T::_CLOAD: {
+      int32_t addr = fp[ins.a].i;
+      if (addr < 0 or addr >= sp) return runtime_error("invalid memory access", func);
+      m[addr] = fp[ins.b];
+      break;
+    }
+    case T::_ACOPY: case T::_ACOPY_DST_PTR: case T::_ACOPY_SRC_PTR: case T::_ACOPY_PTR: {
+      bool dstPtr = ins.op == T::_ACOPY_DST_PTR or ins.op == T::_ACOPY_PTR;
+      bool srcPtr = ins.op == T::_ACOPY_SRC_PTR or ins.op == T::_ACOPY_PTR;
+      int64_t dst = dstPtr ? fp[ins.a].i : (fp - m) + ins.a;
+      int64_t src = srcPtr ? fp[ins.b].i : (fp - m) + ins.b;
+      if (dst < 0 or src < 0 or dst + ins.c > sp or src + ins.c > sp)
+        return runtime_error("invalid memory access", func);
+      memmove(m + dst, m + src, size_t(ins.c) * sizeof(Cell));
+      break;
+    }
+    case T::_ALOAD: fp[ins.a].i = (fp - m) + ins.b; break;
+
+    case T::_READI: { int32_t x = 0; in >> x; fp[ins.a].i = x; break; }
+    case T::_READF: { float x = 0; in >> x; fp[ins.a].f = x; break; }
+    case T::_READC: { char x = 0; in >> x; fp[ins.a].i = x; break; }
+    case T::_WRITEI: out << fp[ins.a].i; break;
+    case T::_WRITEF: out << fp[ins.a].f; break;
+    case T::_WRITEC: out << char(fp[ins.a].i); break;
+    case T::_WRITES: out.write(image.strings + ins.a, ins.b); break;
+    case T::_WRITELN: out << '\n'; break;
+    case T::_NOOP: break;
+    }
+  }
+}
@@ -0,0 +1,223 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeVM - in-process interpreter for t-code programs
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class TCodeImage stores a t-code program decoded to flat arrays,
+/// ready to be executed: labels are resolved to instruction indexes,
+/// called functions to function indexes, and variables, parameters
+/// and temporaries to slots of the function frame.
+/// All the arrays are plain data, so an image can be saved to an
+/// object file and mapped back into memory without any decoding.
+///
+/// Object file layout (native byte order, every section 4-aligned):
+///   header   magic "TCOD", version, byte order mark, array sizes,
+///            index of main and the offset of each section
+///   instrs   nInstrs  x Instr
+///   funcs    nFuncs   x Function
+///   vars     nVars    x Variable
+///   strings  stringsSize bytes (names and writes literals)
+
+class TCodeImage {
+public:
+  /// decoded operations. Operands a,b,c are frame slots unless
+  /// stated otherwise.
+  typedef enum {
+    _JUMP,        // goto a (instruction index)
+    _FJUMP,       // ifFalse a goto b (instruction index)
+    _JEQ, _JLT, _JLE, _JNEQ, _JNLT, _JNLE,             // if (or ifFalse) a op b goto c
+    _FJEQ, _FJLT, _FJLE, _FJNEQ, _FJNLT, _FJNLE,       // if (or ifFalse) a op. b goto c
+    _PUSH,        // pushparam a
+    _PUSH_NONE,   // pushparam (room for a result)
+    _POP,         // popparam a
+    _POP_NONE,    // popparam (discarded)
+    _CALL,        // call a (function index)
+    _RETURN,      // return
+    _ADD, _SUB, _MUL, _DIV, _MOD, _EQ, _LT, _LE, _AND, _OR,   // a = b op c
+    _NEG, _NOT, _FLOAT,                                       // a = op b
+    _FADD, _FSUB, _FMUL, _FDIV, _FMOD, _FEQ, _FLT, _FLE,      // a = b op. c
+    _FNEG,                                                    // a = -. b
+    _MOVE,        // a = b
+    _CONST,       // a = b (b is the raw 32 bits of an int/char/float constant)
+    _XLOAD,       // a[b] = c   (a is a local array)
+    _XLOAD_PTR,   // a[b] = c   (a holds the address of an array)
+    _LOADX,       // a = b[c]   (b is a local array)
+    _LOADX_PTR,   // a = b[c]   (b holds the address of an array)
+    _ALOAD,       // a = &b
+    _LOADC,       // a = *b
+    _CLOAD,       // *a = b
+    _ACOPY,       // a = b, copying c cells (a and b are local arrays)
+    _ACOPY_DST_PTR,   // the same, a holds the address of an array
+    _ACOPY_SRC_PTR,   // the same, b holds the address of an array
+    _ACOPY_PTR,       // the same, both hold addresses
+    _READI, _READF, _READC,
+    _WRITEI, _WRITEF, _WRITEC,
+    _WRITES,      // writes (a, b: offset and length in the string pool)
+    _WRITELN,
+    _NOOP
+  } OpCode;
+
+  /// a decoded instruction
+  struct Instr {
+    int32_t op;
+    int32_t a, b, c;
+  };
+
+  /// a function: its code is instrs[entry...], and its frame holds the
+  /// parameters (pushed by the caller), the local variables and the
+  /// temporaries, in this order, for a total of frameSize slots
+  struct Function {
+    int32_t name;        // offset of the name in the string pool
+    int32_t entry;
+    int32_t nInstrs;
+    int32_t nParams;
+    int32_t frameSize;
+    int32_t stackSize;   // frameSize plus room for the pushed params
+    int32_t firstVar;    // its params and vars are vars[firstVar...]
+    int32_t nVars;
+  };
+
+  /// a parameter or local variable and its position in the frame
+  struct Variable {
+    int32_t name;        // offset of the name in the string pool
+    int32_t slot;
+    int32_t size;
+  };
+
+  /// constructor and destructor
+  TCodeImage();
+  ~TCodeImage();
+  /// the public arrays may point to the own storage: no copies
+  TCodeImage(const TCodeImage &) = delete;
+  TCodeImage & operator=(const TCodeImage &) = delete;
+
+  /// decode a code object. On failure returns false and error()
+  /// describes the problem.
+  bool build(const code &c);
+  /// write the image to an object file (false on failure)
+  bool save(const std::string &fileName) const;
+  /// map an object file into memory and use it in place. On failure
+  /// (missing file, wrong version, corrupt contents) returns false
+  bool load(const std::string &fileName);
+  /// description of the last error
+  const std::string & error() const;
+
+  /// version of the object file format
+  static const uint32_t VERSION = 4;
+
+  /// program contents (valid after a successful build)
+  const Instr    * instrs;
+  const Function * funcs;
+  const Variable * vars;
+  const char     * strings;
+  uint32_t nInstrs, nFuncs, nVars, stringsSize;
+  /// index of the function "main"
+  int32_t mainFunc;
+
+  /// name of a function (for messages)
+  std::string function_name(int32_t f) const;
+
+private:
+  std::string errorMsg;
+  /// storage when the image is built from a code object
+  std::vector<Instr>    ownInstrs;
+  std::vector<Function> ownFuncs;
+  std::vector<Variable> ownVars;
+  std::string           ownStrings;
+  /// mapped object file, if the image was loaded
+  void * mapping;
+  size_t mappingSize;
+
+  /// drop the current contents
+  void release();
+  /// check that a loaded image is consistent, so that it can be run safely
+  bool validate();
+
+  /// add a string to the pool, returning its offset
+  int32_t add_string(const std::string &s);
+  /// point the public arrays to the own storage
+  void set_views();
+  /// decode one subroutine
+  bool build_function(const subroutine &s, int32_t index,
+                      const std::map<std::string, int32_t> &funcIndex);
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// Class TCodeVM executes the "main" function of a TCodeImage.
+/// Values are 32-bit cells holding an int, a char, a bool, a float or
+/// the address of a cell. All frames live in one contiguous stack.
+
+class TCodeVM {
+public:
+  /// constructor and destructor
+  TCodeVM(const TCodeImage &image, std::istream &in, std::ostream &out);
+  ~TCodeVM();
+
+  /// run the program. Returns EXIT_SUCCESS, or EXIT_FAILURE after
+  /// printing a runtime error (division by zero, stack overflow...)
+  int run();
+
+private:
+  /// a memory cell
+  union Cell {
+    int32_t i;
+    float   f;
+  };
+
+  /// saved state of a caller
+  struct Activation {
+    const TCodeImage::Instr *ret;
+    int32_t fp;
+    int32_t func;
+  };
+
+  const TCodeImage & image;
+  std::istream & in;
+  std::ostream & out;
+
+  /// stack of cells
+  std::vector<Cell> mem;
+  /// stack of activations
+  std::vector<Activation> calls;
+
+  /// make room for 'needed' cells in the stack (false if too many)
+  bool grow(size_t needed);
+  /// print a runtime error
+  int runtime_error(const std::string &msg, int32_t func) const;
+};
@@ -0,0 +1,208 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TailRecursion - elimination of self-recursive tail calls
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TailRecursion.h"
+#include "Inliner.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+namespace {
+
+  bool is_copy(const instruction &ins) {
+    return ins.oper == instruction::_LOAD or ins.oper == instruction::_ILOAD or
+           ins.oper == instruction::_CHLOAD or ins.oper == instruction::_FLOAD;
+  }
+
+  // a self-recursive call in tail position
+  struct TailCall {
+    Inliner::CallSite site;
+    size_t end;                       // first instruction after the call
+    instruction::Operation op;        // accumulating operation, or _NOOP
+    operand value;                    // value accumulated
+  };
+
+  // does the code from pc on return the value of one of the holders
+  // (or just return, if there is no result) with nothing else to do?
+  bool returns_holders(const instructionList &code, size_t pc, set<operand> holders,
+                       const operand &result, bool hasResult,
+                       const map<string, size_t> &labels) {
+    for (size_t steps = 0; pc < code.size() and steps <= code.size(); ++steps) {
+      const instruction & ins = code[pc];
+      if (ins.oper == instruction::_LABEL) ++pc;
+      else if (ins.oper == instruction::_UJUMP) {
+        auto it = labels.find(ins.arg1.str());
+        if (it == labels.end()) return false;
+        pc = it->second;
+      }
+      else if (is_copy(ins) and holders.count(ins.arg2)) {
+        holders.insert(ins.arg1);
+        ++pc;
+      }
+      else if (ins.oper == instruction::_RETURN)
+        return not hasResult or holders.count(result);
+      else return false;
+    }
+    return false;
+  }
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'TailRecursion'
+
+TailRecursion::TailRecursion() : eliminated(0), accumulated(0) {}
+
+TailRecursion::~TailRecursion() {}
+
+size_t TailRecursion::get_eliminated() const { return eliminated; }
+
+size_t TailRecursion::get_accumulated() const { return accumulated; }
+
+size_t TailRecursion::optimize(subroutine &s) {
+  const instructionList & code = s.get_instructions();
+  nameTable & names = s.get_names();
+  const operand result("_result", names);
+  bool hasResult = not s.params.empty() and s.params.front().name == result.str();
+  size_t nArgs = s.params.size() - (hasResult ? 1 : 0);
+
+  map<string, size_t> labels;
+  int maxTemp = 0;
+  // the address of a local variable could be passed down, and the
+  // next level (now the same frame) would see its own locals changed
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (code[i].oper == instruction::_ALOAD) return 0;
+    if (code[i].oper == instruction::_LABEL) labels[code[i].arg1.str()] = i;
+    for (const operand *a : {&code[i].arg1, &code[i].arg2, &code[i].arg3})
+      if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+  }
+  const string entryName = "_entry";
+  if (labels.count(entryName)) return 0;
+
+  // accumulating is possible if the result is only set right before returning
+  bool canAccumulate = hasResult;
+  for (size_t i = 0; i < code.size(); ++i)
+    if (code[i].defines_arg1() and code[i].arg1 == result and
+        (not is_copy(code[i]) or i+1 == code.size() or code[i+1].oper != instruction::_RETURN))
+      canAccumulate = false;
+
+  vector<TailCall> tails;
+  instruction::Operation accOp = instruction::_NOOP;
+  for (const Inliner::CallSite & site : Inliner::call_sites(code)) {
+    if (code[site.call].arg1.str() != s.get_name() or site.nPops != nArgs+1 or
+        not code[site.pushes[0]].arg1.empty()) continue;
+    TailCall tail;
+    tail.site = site;
+    tail.end = site.call + site.nPops + 1;
+    tail.op = instruction::_NOOP;
+    const operand & popped = code[site.call + site.nPops].arg1;
+    set<operand> holders;
+    if (not popped.empty()) holders.insert(popped);
+    // "%t = a op result" right after the call: accumulator pattern
+    if (canAccumulate and not popped.empty() and tail.end < code.size()) {
+      const instruction & ins = code[tail.end];
+      if ((ins.oper == instruction::_ADD or ins.oper == instruction::_MUL) and
+          (accOp == instruction::_NOOP or ins.oper == accOp) and
+          (ins.arg2 == popped) != (ins.arg3 == popped)) {
+        tail.op = ins.oper;
+        tail.value = ins.arg2 == popped ? ins.arg3 : ins.arg2;
+        holders.clear();
+        holders.insert(ins.arg1);
+        ++tail.end;
+      }
+    }
+    if (not returns_holders(code, tail.end, holders, result, hasResult, labels)) continue;
+    if (tail.op != instruction::_NOOP) accOp = tail.op;
+    tails.push_back(tail);
+  }
+  if (tails.empty()) return 0;
+
+  // new code replacing some instructions
+  vector<bool> replaced(code.size(), false);
+  vector<instructionList> replacement(code.size());
+  operand entry(entryName, names);
+  auto accumulate = [&](instructionList &out, operand value) {
+    if (not value.isTemp() and not value.isSymbol()) {
+      operand t = operand::temp(++maxTemp);
+      out.push_back(instruction::ILOAD(t, value));
+      value = t;
+    }
+    operand sum = operand::temp(++maxTemp);
+    out.push_back(instruction(accOp, sum, result, value));
+    out.push_back(instruction::ILOAD(result, sum));
+  };
+  for (const TailCall & tail : tails) {
+    const Inliner::CallSite & site = tail.site;
+    // the arguments are evaluated (and copied) before any parameter changes
+    vector<operand> args;
+    replaced[site.pushes[0]] = true;
+    for (size_t a = 1; a < site.pushes.size(); ++a) {
+      args.push_back(operand::temp(++maxTemp));
+      replaced[site.pushes[a]] = true;
+      replacement[site.pushes[a]] = instruction::LOAD(args.back(), code[site.pushes[a]].arg1);
+    }
+    instructionList & jump = replacement[site.call];
+    if (tail.op != instruction::_NOOP) {
+      accumulate(jump, tail.value);
+      ++accumulated;
+    }
+    auto p = s.params.begin();
+    if (hasResult) ++p;
+    for (size_t a = 0; a < args.size(); ++a, ++p)
+      jump.push_back(instruction::LOAD(operand(p->name, names), args[a]));
+    jump.push_back(instruction::UJUMP(entry));
+    for (size_t i = site.call; i < tail.end; ++i) replaced[i] = true;
+    ++eliminated;
+  }
+
+  instructionList newCode;
+  if (accOp != instruction::_NOOP) {
+    // _result starts as the identity, and accumulates what is returned
+    for (size_t i = 0; i+1 < code.size(); ++i)
+      if (not replaced[i] and code[i].defines_arg1() and code[i].arg1 == result) {
+        replaced[i] = true;
+        accumulate(replacement[i], code[i].arg2);
+      }
+    operand identity = operand::temp(++maxTemp);
+    newCode.push_back(instruction::ILOAD(identity, operand::integer(accOp == instruction::_ADD ? 0 : 1)));
+    newCode.push_back(instruction::ILOAD(result, identity));
+  }
+  newCode.push_back(instruction::LABEL(entry));
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (not replaced[i]) newCode.push_back(code[i]);
+    else for (auto & ins : replacement[i]) newCode.push_back(std::move(ins));
+  }
+  s.set_instructions(std::move(newCode));
+  return tails.size();
+}
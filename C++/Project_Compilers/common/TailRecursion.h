@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TailRecursion - elimination of self-recursive tail calls
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class TailRecursion turns the self-recursive calls of a subroutine
+/// in tail position into assignments of the parameters and a jump to
+/// its entry, so that deep recursions run in constant stack space.
+///
+/// Besides calls whose result is directly returned, it handles the
+/// accumulator pattern "return a + f(...)" (or *, for integers): the
+/// partial result is accumulated in _result, which starts with the
+/// identity of the operation, and every "_result = x; return" becomes
+/// "_result = _result op x; return".
+///
+/// The new temporaries have a single definition and no variable is
+/// added, so the result is still valid input for LLVMCodeGen.
+
+class TailRecursion {
+public:
+  /// constructor and destructor
+  TailRecursion();
+  ~TailRecursion();
+
+  /// eliminate the tail calls of a subroutine. Returns their number
+  std::size_t optimize(subroutine &s);
+
+  /// tail calls eliminated so far, and how many of them accumulate
+  std::size_t get_eliminated() const;
+  std::size_t get_accumulated() const;
+
+private:
+  std::size_t eliminated, accumulated;
+};
@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TempRenumber - reuse of temporaries with disjoint lifetimes
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TempRenumber.h"
+#include "FlowGraph.h"
+#include "Liveness.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'TempRenumber'
+
+TempRenumber::TempRenumber() : peakBefore(0), peakAfter(0) {}
+
+TempRenumber::~TempRenumber() {}
+
+size_t TempRenumber::get_peak_before() const { return peakBefore; }
+
+size_t TempRenumber::get_peak_after() const { return peakAfter; }
+
+size_t TempRenumber::frame_size(const subroutine &s) {
+  size_t size = s.params.size();
+  for (auto & v : s.vars) size += max(v.size, size_t(1));
+  int maxTemp = -1;
+  for (auto & ins : s.get_instructions())
+    for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+      if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+  return size + maxTemp + 1;
+}
+
+void TempRenumber::optimize(subroutine &s) {
+  peakBefore = max(peakBefore, frame_size(s));
+  instructionList code = s.get_instructions();
+  FlowGraph graph(code);
+  Liveness live(graph);
+
+  // live interval of each temporary. Instruction pc reads at 2*pc and
+  // writes at 2*pc+1, so a temporary read for the last time may share
+  // its number with the one the same instruction defines
+  const size_t NONE = size_t(-1);
+  vector<size_t> start(live.size(), NONE), end(live.size(), 0);
+  auto extend = [&](size_t t, size_t pos) {
+    if (start[t] == NONE or pos < start[t]) start[t] = pos;
+    if (pos > end[t]) end[t] = pos;
+  };
+  vector<size_t> uses;
+  size_t def;
+  for (size_t b = 0; b < graph.size(); ++b) {
+    const FlowGraph::BasicBlock & blk = graph.block(b);
+    for (size_t t = 0; t < live.size(); ++t) {
+      if (live.get_in(b).test(t)) extend(t, 2*blk.first);
+      if (live.get_out(b).test(t)) extend(t, 2*blk.last);
+    }
+    for (size_t pc = blk.first; pc < blk.last; ++pc) {
+      live.uses_and_def(code[pc], uses, def);
+      for (size_t u : uses) extend(u, 2*pc);
+      if (def != Liveness::NONE) extend(def, 2*pc+1);
+    }
+  }
+
+  // linear scan: temporaries by start, numbers freed when intervals end
+  vector<size_t> temps;
+  for (size_t t = 0; t < live.size(); ++t)
+    if (live.get_operand(t).isTemp() and start[t] != NONE) temps.push_back(t);
+  sort(temps.begin(), temps.end(), [&](size_t a, size_t b) { return start[a] < start[b]; });
+
+  typedef pair<size_t, int> Active;     // (end, number)
+  priority_queue<Active, vector<Active>, greater<Active>> active;
+  priority_queue<int, vector<int>, greater<int>> freeNumbers;
+  int nextNumber = 1;
+  vector<int> number(live.size(), 0);
+  for (size_t t : temps) {
+    while (not active.empty() and active.top().first < start[t]) {
+      freeNumbers.push(active.top().second);
+      active.pop();
+    }
+    if (freeNumbers.empty()) number[t] = nextNumber++;
+    else {
+      number[t] = freeNumbers.top();
+      freeNumbers.pop();
+    }
+    active.push(Active(end[t], number[t]));
+  }
+
+  // copies between temporaries that got the same number vanish
+  instructionList renumbered;
+  renumbered.reserve(code.size());
+  for (auto & ins : code) {
+    for (operand *a : {&ins.arg1, &ins.arg2, &ins.arg3}) {
+      if (not a->isTemp()) continue;
+      size_t t = live.index(*a);
+      if (t != Liveness::NONE and number[t] > 0) *a = operand::temp(number[t]);
+    }
+    bool copy = ins.oper == instruction::_LOAD or ins.oper == instruction::_ILOAD or
+                ins.oper == instruction::_CHLOAD or ins.oper == instruction::_FLOAD;
+    if (copy and ins.arg1.isTemp() and ins.arg1 == ins.arg2) continue;
+    renumbered.push_back(std::move(ins));
+  }
+  s.set_instructions(std::move(renumbered));
+  peakAfter = max(peakAfter, frame_size(s));
+}
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TempRenumber - reuse of temporaries with disjoint lifetimes
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class TempRenumber renames the temporaries of a subroutine with a
+/// linear scan over their live intervals, so that temporaries whose
+/// lifetimes do not overlap share a number (and a frame slot).
+///
+/// Afterwards a temporary may have several definitions: it must be the
+/// last pass, and the result cannot go to LLVMCodeGen, which requires
+/// a single definition per temporary. The pass is for t-code only: on
+/// the LLVM path temporaries are SSA values and llc allocates them.
+
+class TempRenumber {
+public:
+  /// constructor and destructor
+  TempRenumber();
+  ~TempRenumber();
+
+  /// renumber the temporaries of a subroutine
+  void optimize(subroutine &s);
+
+  /// number of frame slots (params, variables and temporaries) of a
+  /// subroutine, as allocated by the t-code machine
+  static std::size_t frame_size(const subroutine &s);
+
+  /// largest frame size seen before and after renumbering
+  std::size_t get_peak_before() const;
+  std::size_t get_peak_after() const;
+
+private:
+  std::size_t peakBefore, peakAfter;
+};
@@ -31,34 +31,75 @@
 
 #include "TypesMgr.h"
 #include "SymTable.h"
+#include "DecoratedContext.h"
 
 #include "antlr4-runtime.h"
 
+#include <cassert>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 
+std::size_t TreeDecoration::setTree(antlr4::tree::ParseTree *tree) {
+  // preorder traversal with an explicit stack (the trees of long
+  // expressions can be very deep)
+  std::size_t nodes = 0;
+  std::vector<antlr4::tree::ParseTree *> pending;
+  if (tree != nullptr) pending.push_back(tree);
+  while (not pending.empty()) {
+    antlr4::tree::ParseTree *node = pending.back();
+    pending.pop_back();
+    DecoratedContext *ctx = dynamic_cast<DecoratedContext *>(node);
+    if (ctx == nullptr) continue;  // a terminal node
+    ctx->setDecorIndex(nodes++);
+    for (auto child = ctx->children.rbegin(); child != ctx->children.rend(); ++child)
+      pending.push_back(*child);
+  }
+  ScopeDecor.assign(nodes, SymTable::ScopeId());
+  TypeDecor.assign(nodes, TypesMgr::TypeId());
+  IsLValueDecor.assign(nodes, false);
+  return nodes;
+}
+
 // Getters:
-SymTable::ScopeId TreeDecoration::getScope(antlr4::ParserRuleContext *ctx) {
-  return ScopeDecor.get(ctx);
+SymTable::ScopeId TreeDecoration::getScope(DecoratedContext *ctx) const {
+  std::size_t i = ctx->getDecorIndex();
+  return i < ScopeDecor.size() ? ScopeDecor[i] : SymTable::ScopeId();
 }
 
-TypesMgr::TypeId TreeDecoration::getType(antlr4::ParserRuleContext *ctx) {
-  return TypeDecor.get(ctx);
+TypesMgr::TypeId TreeDecoration::getType(DecoratedContext *ctx) const {
+  std::size_t i = ctx->getDecorIndex();
+  return i < TypeDecor.size() ? TypeDecor[i] : TypesMgr::TypeId();
 }
 
-bool TreeDecoration::getIsLValue(antlr4::ParserRuleContext *ctx) {
-  return IsLValueDecor.get(ctx);
+bool TreeDecoration::getIsLValue(DecoratedContext *ctx) const {
+  std::size_t i = ctx->getDecorIndex();
+  return i < IsLValueDecor.size() and IsLValueDecor[i];
 }
 
 // Setters:
-void TreeDecoration::putScope(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
-  ScopeDecor.put(ctx, s);
+void TreeDecoration::putScope(DecoratedContext *ctx, SymTable::ScopeId s) {
+  ScopeDecor[slot(ctx)] = s;
+}
+
+void TreeDecoration::putType(DecoratedContext *ctx, TypesMgr::TypeId t) {
+  TypeDecor[slot(ctx)] = t;
 }
 
-void TreeDecoration::putType(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
-  TypeDecor.put(ctx, t);
+void TreeDecoration::putIsLValue(DecoratedContext *ctx, bool b) {
+  IsLValueDecor[slot(ctx)] = b;
 }
 
-void TreeDecoration::putIsLValue(antlr4::ParserRuleContext *ctx, bool b) {
-  IsLValueDecor.put(ctx, b);
+// Nodes are numbered by setTree, but the vectors also grow for nodes
+// numbered in some other way
+std::size_t TreeDecoration::slot(DecoratedContext *ctx) {
+  std::size_t i = ctx->getDecorIndex();
+  assert(i != DecoratedContext::NO_INDEX);
+  if (i >= ScopeDecor.size()) {
+    ScopeDecor.resize(i + 1, SymTable::ScopeId());
+    TypeDecor.resize(i + 1, TypesMgr::TypeId());
+    IsLValueDecor.resize(i + 1, false);
+  }
+  return i;
 }
@@ -31,9 +31,12 @@
 
 #include "TypesMgr.h"
 #include "SymTable.h"
+#include "DecoratedContext.h"
 
 #include "antlr4-runtime.h"
-#include "tree/ParseTreeProperty.h"
+
+#include <cstddef>
+#include <vector>
 
 // using namespace std;
 
@@ -41,9 +44,11 @@
 //////////////////////////////////////////////////////////////////////
 // Class TreeDecoration: the nodes of the parser tree generated
 // by the antlr4 parser, whose base type is
-// antlr4::ParserRuleContext *, can have different attributes.
-// TreeDecoration groups all of them, and uses different
-// ParseTreeProperty to save this information.
+// DecoratedContext *, can have different attributes.
+// TreeDecoration groups all of them. Once the tree is parsed, setTree
+// numbers its nodes (densely, in preorder), and each attribute is kept
+// in a vector indexed by that number: getting or setting an attribute
+// is an access to an array, not a lookup in a hash map.
 // Currently three kinds of attributes may be present:
 //   - scope, for nodes like the program, or functions
 //   - type, for expressions or type especification
@@ -65,19 +70,27 @@ class TreeDecoration {
 public:
   TreeDecoration() = default;
 
-  // Getters:
-  SymTable::ScopeId getScope    (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getType     (antlr4::ParserRuleContext *ctx);
-  bool              getIsLValue (antlr4::ParserRuleContext *ctx);
+  // Number the nodes of the parser tree 'tree' and make room for their
+  // attributes (none of them set). Returns the number of nodes
+  std::size_t setTree(antlr4::tree::ParseTree *tree);
+
+  // Getters (of an attribute not set, the default value):
+  SymTable::ScopeId getScope    (DecoratedContext *ctx) const;
+  TypesMgr::TypeId  getType     (DecoratedContext *ctx) const;
+  bool              getIsLValue (DecoratedContext *ctx) const;
 
   // Setters:
-  void putScope    (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
-  void putType     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
-  void putIsLValue (antlr4::ParserRuleContext *ctx, bool b);
+  void putScope    (DecoratedContext *ctx, SymTable::ScopeId s);
+  void putType     (DecoratedContext *ctx, TypesMgr::TypeId t);
+  void putIsLValue (DecoratedContext *ctx, bool b);
 
 private:
-  antlr4::tree::ParseTreeProperty<SymTable::ScopeId> ScopeDecor;
-  antlr4::tree::ParseTreeProperty<TypesMgr::TypeId>  TypeDecor;
-  antlr4::tree::ParseTreeProperty<bool>              IsLValueDecor;
+  // Index of the attributes of 'ctx', making room for them if needed
+  std::size_t slot(DecoratedContext *ctx);
+
+  // The attributes of the nodes, indexed by their number
+  std::vector<SymTable::ScopeId> ScopeDecor;
+  std::vector<TypesMgr::TypeId>  TypeDecor;
+  std::vector<char>              IsLValueDecor;
 
 };  // class TreeDecoration
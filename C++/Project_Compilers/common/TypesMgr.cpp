@@ -44,6 +44,15 @@
 // ======================================================================
 // class TypesMgr
 
+// TypeId's of the primitive and error types (defined here too, as
+// they are used by reference, e.g. to fill CompoundTypesTable)
+const TypesMgr::TypeId TypesMgr::ErrorTyId;
+const TypesMgr::TypeId TypesMgr::IntegerTyId;
+const TypesMgr::TypeId TypesMgr::FloatTyId;
+const TypesMgr::TypeId TypesMgr::BooleanTyId;
+const TypesMgr::TypeId TypesMgr::CharacterTyId;
+const TypesMgr::TypeId TypesMgr::VoidTyId;
+
 // ----------------------------------------------------------------------
 // constructor
 
@@ -87,14 +96,44 @@ TypesMgr::TypeId TypesMgr::createVoidTy() {
 
 TypesMgr::TypeId TypesMgr::createFunctionTy(const std::vector<TypeId> & paramsTypes,
 					    TypeId returnType) {
-  TypesVec.push_back(Type(paramsTypes, returnType));
-  return TypesVec.size()-1;
+  return internType(Type(paramsTypes, returnType));
 }
 
 TypesMgr::TypeId TypesMgr::createArrayTy(unsigned int size,
 					 TypeId elemType) {
-  TypesVec.push_back(Type{size, elemType});
-  return TypesVec.size()-1;
+  return internType(Type{size, elemType});
+}
+
+// ----------------------------------------------------------------------
+// hash-consing of the compound types
+
+TypesMgr::TypeId TypesMgr::internType(const Type & t) {
+  if (not CompoundTypesTable.empty()) {
+    std::size_t mask = CompoundTypesTable.size() - 1;
+    for (std::size_t i = t.hash() & mask; CompoundTypesTable[i] != ErrorTyId; i = (i + 1) & mask)
+      if (TypesVec[CompoundTypesTable[i]] == t)
+	return CompoundTypesTable[i];
+  }
+  TypesVec.push_back(t);
+  TypeId tid = TypesVec.size()-1;
+  std::size_t compoundTypes = TypesVec.size() - NumPrimitiveAndErrorTypes;
+  if (2 * compoundTypes > CompoundTypesTable.size()) {
+    // double the table (and put all the compound types again)
+    std::size_t size = CompoundTypesTable.empty() ? 16 : 2 * CompoundTypesTable.size();
+    CompoundTypesTable.assign(size, ErrorTyId);
+    for (TypeId old = NumPrimitiveAndErrorTypes; old < tid; ++old)
+      placeType(old);
+  }
+  placeType(tid);
+  return tid;
+}
+
+void TypesMgr::placeType(TypeId tid) {
+  std::size_t mask = CompoundTypesTable.size() - 1;
+  std::size_t i = TypesVec[tid].hash() & mask;
+  while (CompoundTypesTable[i] != ErrorTyId)
+    i = (i + 1) & mask;
+  CompoundTypesTable[i] = tid;
 }
 
 // ----------------------------------------------------------------------
@@ -200,39 +239,10 @@ TypesMgr::TypeId TypesMgr::getArrayElemType(TypeId tid) const {
 // ----------------------------------------------------------------------
 // methods for checking different compatibilities of Types
 
+// types are hash-consed: structurally equal types have the same TypeId
 bool TypesMgr::equalTypes(TypeId tid1, TypeId tid2) const {
-  if (tid1 == tid2)
-    return true;
-  const Type & t1 = TypesVec.at(tid1);
-  const Type & t2 = TypesVec.at(tid2);
-  if (t1.getTypeKind() != t2.getTypeKind())
-    return false;
-  if (t1.isPrimitiveTy() and t2.isPrimitiveTy())
-    return true;
-  if (t1.isFunctionTy()) {  // or: if (t2.isFunctionTy()) {
-    if (t1.getNumOfParameters() != t2.getNumOfParameters())
-      return false;
-    TypeId tid1_aux;
-    TypeId tid2_aux;
-    for (unsigned int i = 0; i < t1.getNumOfParameters(); ++i) {
-      tid1_aux = t1.getParameterType(i);
-      tid2_aux = t2.getParameterType(i);
-      if (not equalTypes(tid1_aux, tid2_aux))
-	return false;
-    }
-    tid1_aux = t1.getFuncReturnType();
-    tid2_aux = t2.getFuncReturnType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  if (t1.isArrayTy()) {  // or: if (t2.isArrayTy()) {
-    if (t1.getArraySize() != t2.getArraySize()) {
-      return false;
-    }
-    TypeId tid1_aux = t1.getArrayElemType();
-    TypeId tid2_aux = t2.getArrayElemType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  return false;
+  assert(tid1 < TypesVec.size() and tid2 < TypesVec.size());
+  return tid1 == tid2;
 }
 
 bool TypesMgr::comparableTypes(TypeId tid1, TypeId tid2,
@@ -347,6 +357,37 @@ TypesMgr::TypeKind TypesMgr::Type::getTypeKind () const {
   return ID;
 }
 
+// ----------------------------------------------------------------------
+// structural equality and hash value (the subtypes are compared and
+// hashed by their TypeId's, which are canonical)
+
+bool TypesMgr::Type::operator==(const Type & t) const {
+  if (ID != t.ID)
+    return false;
+  if (isFunctionTy())
+    return funcReturnTy == t.funcReturnTy and funcParamsTy == t.funcParamsTy;
+  if (isArrayTy())
+    return arraySize == t.arraySize and arrayElemTy == t.arrayElemTy;
+  return true;
+}
+
+std::size_t TypesMgr::Type::hash() const {
+  std::size_t h = ID;
+  auto combine = [&h](std::size_t v) {
+    h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+  };
+  if (isFunctionTy()) {
+    combine(funcReturnTy);
+    for (TypeId tid : funcParamsTy)
+      combine(tid);
+  }
+  else if (isArrayTy()) {
+    combine(arraySize);
+    combine(arrayElemTy);
+  }
+  return h;
+}
+
 // ----------------------------------------------------------------------
 // accessors for working with primitive types
 
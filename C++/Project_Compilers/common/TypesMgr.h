@@ -46,6 +46,11 @@
 // integer, float, boolean, character and void. Also it
 // recognizes two compound types: functions and fixed-size
 // arrays. Finally there exist a special type 'error'.
+// Types are hash-consed: creating a type structurally equal to an
+// existing one returns the TypeId of that one, so that each type has
+// a single (canonical) TypeId. Then two types are equal if and only
+// if their TypeIds are, and the number of types does not grow with
+// the number of times they are created.
 
 class TypesMgr {
 
@@ -121,6 +126,17 @@ private:
   // Attributes:
   //   - vector to save the Types
   std::vector<Type> TypesVec;
+  //   - hash table (open addressing, linear probing) of the TypeIds
+  //     of the compound types, to find a Type equal to a new one. Its
+  //     size is a power of two, and it is at most half full; the empty
+  //     slots hold ErrorTyId (which is never a compound type)
+  std::vector<TypeId> CompoundTypesTable;
+
+  // Returns the TypeId of the compound type equal to t, adding t to
+  // TypesVec (and to CompoundTypesTable) if it is new
+  TypeId internType (const Type & t);
+  // Puts the TypeId tid in its slot of CompoundTypesTable
+  void   placeType  (TypeId tid);
 
   // There are eight kinds of types:
   //   - an especial kind error,
@@ -179,6 +195,11 @@ private:
     // Accesor to get the kind
     TypeKind getTypeKind () const;
 
+    // Structural equality with another Type (whose subtypes have their
+    // canonical TypeId's too), and a hash value consistent with it
+    bool        operator== (const Type & t) const;
+    std::size_t hash       ()               const;
+
     // Accessors to work with primitive and 'error' types
     bool isErrorTy            () const;
     bool isIntegerTy          () const;
@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////
+//
+//    WorkPool - work-stealing pool of threads
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+#include "WorkPool.h"
+
+#include <exception>
+#include <thread>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'WorkPool'
+
+WorkPool::WorkPool(size_t nWorkers)
+  : nWorkers(nWorkers > 0 ? nWorkers : max(1u, thread::hardware_concurrency())),
+    ranges(this->nWorkers), steals(0) {}
+
+WorkPool::~WorkPool() {}
+
+size_t WorkPool::size() const { return nWorkers; }
+
+size_t WorkPool::get_steals() const { return steals; }
+
+void WorkPool::run(size_t nTasks, const Task &task) {
+  for (size_t w = 0; w < nWorkers; ++w) {
+    ranges[w].begin = nTasks * w / nWorkers;
+    ranges[w].end = nTasks * (w+1) / nWorkers;
+  }
+  steals = 0;
+
+  exception_ptr failure;
+  mutex failureLock;
+  auto worker = [&](size_t w) {
+    size_t t;
+    while (next_task(w, t)) {
+      try {
+        task(t, w);
+      }
+      catch (...) {
+        lock_guard<mutex> guard(failureLock);
+        if (not failure) failure = current_exception();
+      }
+    }
+  };
+  vector<thread> threads;
+  for (size_t w = 1; w < nWorkers and w < nTasks; ++w) threads.emplace_back(worker, w);
+  worker(0);
+  for (auto & th : threads) th.join();
+  if (failure) rethrow_exception(failure);
+}
+
+bool WorkPool::next_task(size_t w, size_t &task) {
+  {
+    lock_guard<mutex> guard(ranges[w].lock);
+    if (ranges[w].begin < ranges[w].end) {
+      task = ranges[w].begin++;
+      return true;
+    }
+  }
+  // steal the back half of the first worker that has something left
+  for (size_t i = 1; i < nWorkers; ++i) {
+    Range & victim = ranges[(w+i) % nWorkers];
+    size_t begin, end;
+    {
+      lock_guard<mutex> guard(victim.lock);
+      if (victim.begin == victim.end) continue;
+      begin = victim.begin + (victim.end - victim.begin) / 2;
+      end = victim.end;
+      victim.end = begin;
+    }
+    {
+      lock_guard<mutex> guard(ranges[w].lock);
+      ranges[w].begin = begin+1;
+      ranges[w].end = end;
+    }
+    {
+      lock_guard<mutex> guard(stealsLock);
+      ++steals;
+    }
+    task = begin;
+    return true;
+  }
+  return false;
+}
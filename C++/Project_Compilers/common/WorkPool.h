@@ -0,0 +1,83 @@
+/////////////////////////////////////////////////////////////////
+//
+//    WorkPool - work-stealing pool of threads
+//
+//    Copyright (C) 2017-2022  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class WorkPool runs a set of independent tasks with several
+/// threads. Each worker starts with a contiguous range of the tasks,
+/// which it takes from the front; a worker whose range is empty steals
+/// the back half of the range of another worker, so that the workers
+/// stay busy when the tasks have very different costs.
+
+class WorkPool {
+public:
+  /// a task gets its number and the number of the worker running it
+  /// (from 0 to size()-1), to use state that belongs to that worker
+  typedef std::function<void(std::size_t task, std::size_t worker)> Task;
+
+  /// constructor and destructor. With 0 workers, there is one per
+  /// hardware thread
+  WorkPool(std::size_t nWorkers = 0);
+  ~WorkPool();
+
+  /// number of workers
+  std::size_t size() const;
+
+  /// run task(i, worker) for every i in [0, nTasks), and return when all
+  /// of them are done. The threads are started here (the calling thread
+  /// is worker 0). If a task throws, the first exception is rethrown
+  /// once all the workers have stopped
+  void run(std::size_t nTasks, const Task &task);
+
+  /// number of ranges stolen in the last run
+  std::size_t get_steals() const;
+
+private:
+  /// the tasks still pending of a worker: [begin, end)
+  struct Range {
+    std::mutex lock;
+    std::size_t begin, end;
+  };
+
+  std::size_t nWorkers;
+  std::vector<Range> ranges;
+  std::size_t steals;
+  std::mutex stealsLock;
+
+  /// take the next task of worker w (stealing if needed); false if
+  /// there are no tasks left anywhere
+  bool next_task(std::size_t w, std::size_t &task);
+};
@@ -28,66 +28,233 @@
 
 #include <iostream>
 #include <vector>
+#include <mutex>
+#include <cassert>
+#include <cctype>
 #include "code.h"
 #include "LLVMCodeGen.h"
 
 using namespace std;
 
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'nameTable'
+
+const std::string * nameTable::intern(const std::string &name) {
+  return &*names.insert(name).first;
+}
+
+std::size_t nameTable::size() const { return names.size(); }
+
+namespace {
+  thread_local nameTable * currentTable = nullptr;
+  thread_local bool scopeRequired = false;
+}
+
+nameTable::Scope::Scope() : previous(currentTable), previousRequired(scopeRequired) {
+  currentTable = nullptr;
+  scopeRequired = true;
+}
+
+nameTable::Scope::Scope(nameTable &table) : previous(currentTable), previousRequired(scopeRequired) {
+  currentTable = &table;
+}
+
+nameTable::Scope::~Scope() {
+  currentTable = previous;
+  scopeRequired = previousRequired;
+}
+
+nameTable * nameTable::current() { return currentTable; }
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'operand'
+
+namespace {
+
+  // table for the names of operands built from plain strings outside
+  // of any nameTable::Scope (tools and tests: the compiler always opens
+  // one per subroutine)
+  std::mutex sharedNamesMutex;
+  nameTable & sharedNames() {
+    static nameTable table;
+    return table;
+  }
+
+  // "%N" (N without sign nor leading zeros)
+  bool isTempText(const std::string &s) {
+    if (s.size() < 2 or s[0] != '%' or not std::isdigit(s[1])) return false;
+    if (s[1] == '0' and s.size() > 2) return false;
+    for (size_t i = 2; i < s.size(); ++i)
+      if (not std::isdigit(s[i])) return false;
+    return s.size() <= 10;
+  }
+
+  // integer constant that prints back exactly as written
+  bool isIntText(const std::string &s) {
+    size_t i = (s.size() > 1 and s[0] == '-') ? 1 : 0;
+    if (i >= s.size() or not std::isdigit(s[i])) return false;
+    if (s[i] == '0' and s.size() > 1) return false;
+    if (s.size()-i > 9) return false;
+    for (size_t j = i; j < s.size(); ++j)
+      if (not std::isdigit(s[j])) return false;
+    return true;
+  }
+
+}
+
+/// empty operand
+operand::operand() : oKind(_NONE), num(0), text(nullptr) {}
+
+/// operand from string, interned in the table of the current scope
+operand::operand(const std::string &s) : operand() { set(s, nullptr); }
+
+operand::operand(const char *s) : operand() { set(std::string(s), nullptr); }
+
+/// operand from string, interned in the given table
+operand::operand(const std::string &s, nameTable &names) : operand() { set(s, &names); }
+
+void operand::set(const std::string &s, nameTable *names) {
+  if (s.empty()) return;
+  if (isTempText(s)) {
+    oKind = _TEMP;
+    num = std::stoi(s.substr(1));
+  }
+  else if (isIntText(s)) {
+    oKind = _INT;
+    num = std::stoi(s);
+  }
+  else {
+    oKind = (std::isalpha(s[0]) or s[0] == '_') ? _SYMBOL : _LITERAL;
+    if (not names) names = nameTable::current();
+    if (names) text = names->intern(s);
+    else {
+      // inside a compilation every name must have its subroutine
+      assert(not scopeRequired);
+      std::lock_guard<std::mutex> lock(sharedNamesMutex);
+      text = sharedNames().intern(s);
+    }
+  }
+}
+
+operand operand::temp(int n) {
+  operand o;
+  o.oKind = _TEMP;
+  o.num = n;
+  return o;
+}
+
+operand operand::integer(int v) {
+  operand o;
+  o.oKind = _INT;
+  o.num = v;
+  return o;
+}
+
+operand::Kind operand::kind() const { return oKind; }
+bool operand::empty() const { return oKind == _NONE; }
+bool operand::isTemp() const { return oKind == _TEMP; }
+bool operand::isInt() const { return oKind == _INT; }
+bool operand::isSymbol() const { return oKind == _SYMBOL; }
+bool operand::isLiteral() const { return oKind == _LITERAL; }
+int operand::number() const { return num; }
+
+string operand::str() const {
+  switch (oKind) {
+  case _NONE : return "";
+  case _TEMP : return "%" + std::to_string(num);
+  case _INT : return std::to_string(num);
+  default : return *text;
+  }
+}
+
+bool operand::operator==(const operand &o) const {
+  if (oKind != o.oKind) return false;
+  if (oKind == _SYMBOL or oKind == _LITERAL)
+    return text == o.text or *text == *o.text;
+  return num == o.num;
+}
+
+bool operand::operator!=(const operand &o) const { return not (*this == o); }
+
+bool operand::operator<(const operand &o) const {
+  if (oKind != o.oKind) return oKind < o.oKind;
+  if (oKind == _SYMBOL or oKind == _LITERAL)
+    return text != o.text and *text < *o.text;
+  return num < o.num;
+}
+
+
 ////////////////////////////////////////////////////////////////////
 /// Implementation for class 'instruction'
 
 /// Constructor
 instruction::instruction(Operation op,
-                         const std::string &a1, const std::string &a2, const std::string &a3) {
+                         const operand &a1, const operand &a2, const operand &a3) {
   oper = op;
   arg1 = a1;
   arg2 = a2;
   arg3 = a3;
 }
 
-instruction instruction::LABEL(const std::string &a1) { return instruction(_LABEL, a1); }
-instruction instruction::UJUMP(const std::string &a1) { return instruction(_UJUMP, a1); }
-instruction instruction::FJUMP(const std::string &a1, const std::string &a2) { return instruction(_FJUMP, a1, a2); }
-instruction instruction::PUSH(const std::string &a1) { return instruction(_PUSH, a1); }
-instruction instruction::POP(const std::string &a1) { return instruction(_POP, a1); }
-instruction instruction::CALL(const std::string &a1) { return instruction(_CALL, a1); }
+instruction instruction::LABEL(const operand &a1) { return instruction(_LABEL, a1); }
+instruction instruction::UJUMP(const operand &a1) { return instruction(_UJUMP, a1); }
+instruction instruction::FJUMP(const operand &a1, const operand &a2) { return instruction(_FJUMP, a1, a2); }
+instruction instruction::JEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JEQ, a1, a2, a3); }
+instruction instruction::JLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JLT, a1, a2, a3); }
+instruction instruction::JLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JLE, a1, a2, a3); }
+instruction instruction::JNEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JNEQ, a1, a2, a3); }
+instruction instruction::JNLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JNLT, a1, a2, a3); }
+instruction instruction::JNLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_JNLE, a1, a2, a3); }
+instruction instruction::FJEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJEQ, a1, a2, a3); }
+instruction instruction::FJLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJLT, a1, a2, a3); }
+instruction instruction::FJLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJLE, a1, a2, a3); }
+instruction instruction::FJNEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJNEQ, a1, a2, a3); }
+instruction instruction::FJNLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJNLT, a1, a2, a3); }
+instruction instruction::FJNLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FJNLE, a1, a2, a3); }
+instruction instruction::PUSH(const operand &a1) { return instruction(_PUSH, a1); }
+instruction instruction::POP(const operand &a1) { return instruction(_POP, a1); }
+instruction instruction::CALL(const operand &a1) { return instruction(_CALL, a1); }
 instruction instruction::RETURN() { return instruction(_RETURN); }
-instruction instruction::ADD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_ADD, a1, a2, a3); }
-instruction instruction::SUB(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_SUB, a1, a2, a3); }
-instruction instruction::MUL(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_MUL, a1, a2, a3); }
-instruction instruction::DIV(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_DIV, a1, a2, a3); }
-instruction instruction::EQ(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_EQ, a1, a2, a3); }
-instruction instruction::LT(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LT, a1, a2, a3); }
-instruction instruction::LE(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LE, a1, a2, a3); }
-instruction instruction::AND(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_AND, a1, a2, a3); }
-instruction instruction::OR(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_OR, a1, a2, a3); }
-instruction instruction::FADD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FADD, a1, a2, a3); }
-instruction instruction::FSUB(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FSUB, a1, a2, a3); }
-instruction instruction::FMUL(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FMUL, a1, a2, a3); }
-instruction instruction::FDIV(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FDIV, a1, a2, a3); }
-instruction instruction::FEQ(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FEQ, a1, a2, a3); }
-instruction instruction::FLT(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FLT, a1, a2, a3); }
-instruction instruction::FLE(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_FLE, a1, a2, a3); }
-instruction instruction::NOT(const std::string &a1, const std::string &a2) { return instruction(_NOT, a1, a2); }
-instruction instruction::NEG(const std::string &a1, const std::string &a2) { return instruction(_NEG, a1, a2); }
-instruction instruction::FNEG(const std::string &a1, const std::string &a2) { return instruction(_FNEG, a1, a2); }
-instruction instruction::FLOAT(const std::string &a1, const std::string &a2) { return instruction(_FLOAT, a1, a2); }  
-instruction instruction::LOAD(const std::string &a1, const std::string &a2) { return instruction(_LOAD, a1, a2); }
-instruction instruction::ILOAD(const std::string &a1, const std::string &a2) { return instruction(_ILOAD, a1, a2); }
-instruction instruction::CHLOAD(const std::string &a1, const std::string &a2) { return instruction(_CHLOAD, a1, a2); }
-instruction instruction::FLOAD(const std::string &a1, const std::string &a2) { return instruction(_FLOAD, a1, a2); }
-instruction instruction::XLOAD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_XLOAD, a1, a2, a3); }
-instruction instruction::LOADX(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LOADX, a1, a2, a3); }
-instruction instruction::ALOAD(const std::string &a1, const std::string &a2) { return instruction(_ALOAD, a1, a2); }
-instruction instruction::LOADC(const std::string &a1, const std::string &a2) { return instruction(_LOADC, a1, a2); }
-instruction instruction::CLOAD(const std::string &a1, const std::string &a2) { return instruction(_CLOAD, a1, a2); }
-instruction instruction::READI(const std::string &a1) { return instruction(_READI, a1); }
-instruction instruction::READF(const std::string &a1) { return instruction(_READF, a1); }
-instruction instruction::READC(const std::string &a1) { return instruction(_READC, a1); }
-instruction instruction::WRITEI(const std::string &a1) { return instruction(_WRITEI, a1); }
-instruction instruction::WRITEF(const std::string &a1) { return instruction(_WRITEF, a1); }
-instruction instruction::WRITEC(const std::string &a1) { return instruction(_WRITEC, a1); }
-instruction instruction::WRITES(const std::string &a1) { return instruction(_WRITES, a1); }
+instruction instruction::ADD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_ADD, a1, a2, a3); }
+instruction instruction::SUB(const operand &a1, const operand &a2, const operand &a3) { return instruction(_SUB, a1, a2, a3); }
+instruction instruction::MUL(const operand &a1, const operand &a2, const operand &a3) { return instruction(_MUL, a1, a2, a3); }
+instruction instruction::DIV(const operand &a1, const operand &a2, const operand &a3) { return instruction(_DIV, a1, a2, a3); }
+instruction instruction::MOD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_MOD, a1, a2, a3); }
+instruction instruction::EQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_EQ, a1, a2, a3); }
+instruction instruction::LT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LT, a1, a2, a3); }
+instruction instruction::LE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LE, a1, a2, a3); }
+instruction instruction::AND(const operand &a1, const operand &a2, const operand &a3) { return instruction(_AND, a1, a2, a3); }
+instruction instruction::OR(const operand &a1, const operand &a2, const operand &a3) { return instruction(_OR, a1, a2, a3); }
+instruction instruction::FADD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FADD, a1, a2, a3); }
+instruction instruction::FSUB(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FSUB, a1, a2, a3); }
+instruction instruction::FMUL(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FMUL, a1, a2, a3); }
+instruction instruction::FDIV(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FDIV, a1, a2, a3); }
+instruction instruction::FMOD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FMOD, a1, a2, a3); }
+instruction instruction::FEQ(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FEQ, a1, a2, a3); }
+instruction instruction::FLT(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FLT, a1, a2, a3); }
+instruction instruction::FLE(const operand &a1, const operand &a2, const operand &a3) { return instruction(_FLE, a1, a2, a3); }
+instruction instruction::NOT(const operand &a1, const operand &a2) { return instruction(_NOT, a1, a2); }
+instruction instruction::NEG(const operand &a1, const operand &a2) { return instruction(_NEG, a1, a2); }
+instruction instruction::FNEG(const operand &a1, const operand &a2) { return instruction(_FNEG, a1, a2); }
+instruction instruction::FLOAT(const operand &a1, const operand &a2) { return instruction(_FLOAT, a1, a2); }  
+instruction instruction::LOAD(const operand &a1, const operand &a2) { return instruction(_LOAD, a1, a2); }
+instruction instruction::ILOAD(const operand &a1, const operand &a2) { return instruction(_ILOAD, a1, a2); }
+instruction instruction::CHLOAD(const operand &a1, const operand &a2) { return instruction(_CHLOAD, a1, a2); }
+instruction instruction::FLOAD(const operand &a1, const operand &a2) { return instruction(_FLOAD, a1, a2); }
+instruction instruction::XLOAD(const operand &a1, const operand &a2, const operand &a3) { return instruction(_XLOAD, a1, a2, a3); }
+instruction instruction::LOADX(const operand &a1, const operand &a2, const operand &a3) { return instruction(_LOADX, a1, a2, a3); }
+instruction instruction::ALOAD(const operand &a1, const operand &a2) { return instruction(_ALOAD, a1, a2); }
+instruction instruction::LOADC(const operand &a1, const operand &a2) { return instruction(_LOADC, a1, a2); }
+instruction instruction::CLOAD(const operand &a1, const operand &a2) { return instruction(_CLOAD, a1, a2); }
+instruction instruction::ACOPY(const operand &a1, const operand &a2, const operand &a3) { return instruction(_ACOPY, a1, a2, a3); }
+instruction instruction::READI(const operand &a1) { return instruction(_READI, a1); }
+instruction instruction::READF(const operand &a1) { return instruction(_READF, a1); }
+instruction instruction::READC(const operand &a1) { return instruction(_READC, a1); }
+instruction instruction::WRITEI(const operand &a1) { return instruction(_WRITEI, a1); }
+instruction instruction::WRITEF(const operand &a1) { return instruction(_WRITEF, a1); }
+instruction instruction::WRITEC(const operand &a1) { return instruction(_WRITEC, a1); }
+instruction instruction::WRITES(const operand &a1) { return instruction(_WRITES, a1); }
 instruction instruction::WRITELN() { return instruction(_WRITELN); }
 instruction instruction::NOOP() { return instruction(_NOOP); }
 
@@ -95,54 +262,140 @@ instruction instruction::NOOP() { return instruction(_NOOP); }
 /// Destructor
 instruction::~instruction() {}
 
+unsigned instruction::used_args() const {
+  switch (oper) {
+  case _FJUMP: case _WRITEI: case _WRITEF: case _WRITEC: case _WRITES:
+    return ARG1;
+  case _PUSH:
+    return arg1.empty() ? 0 : ARG1;
+  case _ADD: case _SUB: case _MUL: case _DIV: case _MOD: case _EQ: case _LT: case _LE: case _AND: case _OR:
+  case _FADD: case _FSUB: case _FMUL: case _FDIV: case _FMOD: case _FEQ: case _FLT: case _FLE:
+  case _LOADX:
+    return ARG2 | ARG3;
+  case _NEG: case _NOT: case _FLOAT: case _FNEG:
+  case _LOAD: case _ILOAD: case _CHLOAD: case _FLOAD: case _ALOAD: case _LOADC:
+    return ARG2;
+  case _XLOAD:
+    return ARG1 | ARG2 | ARG3;
+  case _CLOAD: case _ACOPY:
+  case _JEQ: case _JLT: case _JLE: case _JNEQ: case _JNLT: case _JNLE:
+  case _FJEQ: case _FJLT: case _FJLE: case _FJNEQ: case _FJNLT: case _FJNLE:
+    return ARG1 | ARG2;
+  default:
+    return 0;
+  }
+}
+
+bool instruction::defines_arg1() const {
+  switch (oper) {
+  case _ADD: case _SUB: case _MUL: case _DIV: case _MOD: case _EQ: case _LT: case _LE: case _AND: case _OR:
+  case _FADD: case _FSUB: case _FMUL: case _FDIV: case _FMOD: case _FEQ: case _FLT: case _FLE:
+  case _NEG: case _NOT: case _FLOAT: case _FNEG:
+  case _LOAD: case _ILOAD: case _CHLOAD: case _FLOAD: case _LOADX: case _ALOAD: case _LOADC:
+  case _READI: case _READF: case _READC:
+    return true;
+  case _POP:
+    return not arg1.empty();
+  default:
+    return false;
+  }
+}
+
+bool instruction::is_pure() const {
+  // integer division and modulo may stop the program (division by zero)
+  return defines_arg1() and oper != _DIV and oper != _MOD and oper != _POP and
+         oper != _READI and oper != _READF and oper != _READC;
+}
+
+bool instruction::is_jump() const { return oper == _UJUMP or oper == _FJUMP or is_compare_jump(); }
+
+const operand & instruction::jump_target() const {
+  return oper == _FJUMP ? arg2 : is_compare_jump() ? arg3 : arg1;
+}
+
+operand & instruction::jump_target() {
+  return oper == _FJUMP ? arg2 : is_compare_jump() ? arg3 : arg1;
+}
+
+bool instruction::is_compare_jump() const { return oper >= _JEQ and oper <= _FJNLE; }
+
+instruction::Operation instruction::jump_comparison(bool &jumpIf) const {
+  jumpIf = (oper >= _JEQ and oper <= _JLE) or (oper >= _FJEQ and oper <= _FJLE);
+  switch (oper) {
+  case _JEQ: case _JNEQ:   return _EQ;
+  case _JLT: case _JNLT:   return _LT;
+  case _JLE: case _JNLE:   return _LE;
+  case _FJEQ: case _FJNEQ: return _FEQ;
+  case _FJLT: case _FJNLT: return _FLT;
+  case _FJLE: case _FJNLE: return _FLE;
+  default:                 return _INVALID;
+  }
+}
+
 string instruction::dump() const {
   string s;
   string ind="   ";
+  string a1 = arg1.str(), a2 = arg2.str(), a3 = arg3.str();
   switch (oper) {
-  case instruction::_LABEL : { s = "label " + arg1 + " :"; ind = ""; break; }
-  case instruction::_UJUMP : { s = "goto " + arg1; break; }
-  case instruction::_FJUMP : { s = "ifFalse " + arg1 + " goto " +arg2; break; }
+  case instruction::_LABEL : { s = "label " + a1 + " :"; ind = ""; break; }
+  case instruction::_UJUMP : { s = "goto " + a1; break; }
+  case instruction::_FJUMP : { s = "ifFalse " + a1 + " goto " +a2; break; }
+  case instruction::_JEQ : { s = "if " + a1 + " == " + a2 + " goto " + a3; break; }
+  case instruction::_JLT : { s = "if " + a1 + " < " + a2 + " goto " + a3; break; }
+  case instruction::_JLE : { s = "if " + a1 + " <= " + a2 + " goto " + a3; break; }
+  case instruction::_JNEQ : { s = "ifFalse " + a1 + " == " + a2 + " goto " + a3; break; }
+  case instruction::_JNLT : { s = "ifFalse " + a1 + " < " + a2 + " goto " + a3; break; }
+  case instruction::_JNLE : { s = "ifFalse " + a1 + " <= " + a2 + " goto " + a3; break; }
+  case instruction::_FJEQ : { s = "if " + a1 + " ==. " + a2 + " goto " + a3; break; }
+  case instruction::_FJLT : { s = "if " + a1 + " <. " + a2 + " goto " + a3; break; }
+  case instruction::_FJLE : { s = "if " + a1 + " <=. " + a2 + " goto " + a3; break; }
+  case instruction::_FJNEQ : { s = "ifFalse " + a1 + " ==. " + a2 + " goto " + a3; break; }
+  case instruction::_FJNLT : { s = "ifFalse " + a1 + " <. " + a2 + " goto " + a3; break; }
+  case instruction::_FJNLE : { s = "ifFalse " + a1 + " <=. " + a2 + " goto " + a3; break; }
   case instruction::_LOAD : 
   case instruction::_FLOAD : 
-  case instruction::_ILOAD : { s = arg1 + " = " + arg2; break; } 
-  case instruction::_CHLOAD : { s = arg1 + " = '" + arg2 +"'"; break; } 
-  case instruction::_PUSH : { s = "pushparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_POP : { s = "popparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_CALL : { s = "call " + arg1; break; }
+  case instruction::_ILOAD : { s = a1 + " = " + a2; break; } 
+  case instruction::_CHLOAD : { s = a1 + " = '" + a2 +"'"; break; } 
+  case instruction::_PUSH : { s = "pushparam " + a1; break; }
+  case instruction::_POP : { s = "popparam " + a1; break; }
+  case instruction::_CALL : { s = "call " + a1; break; }
   case instruction::_RETURN : { s = "return"; break; }
-  case instruction::_XLOAD : { s = arg1 + "[" + arg2 + "] = " + arg3; break; }
-  case instruction::_LOADX : { s = arg1 + " = " + arg2 + "[" + arg3 + "]"; break; }
-  case instruction::_ALOAD : { s = arg1 + " = &" + arg2; break; }
-  case instruction::_LOADC : { s = arg1 + " = *" + arg2; break; }
-  case instruction::_CLOAD : { s = "*" + arg1 + " = " + arg2; break; }
-  case instruction::_READI : { s = "readi " + arg1; break; }
-  case instruction::_READF : { s = "readf " + arg1; break; }
-  case instruction::_READC : { s = "readc " + arg1; break; }
-  case instruction::_WRITEI : { s = "writei " + arg1; break; }
-  case instruction::_WRITEF : { s = "writef " + arg1; break; }
-  case instruction::_WRITEC : { s = "writec " + arg1; break; }
-  case instruction::_WRITES : { s = "writes " + arg1; break; }
+  case instruction::_XLOAD : { s = a1 + "[" + a2 + "] = " + a3; break; }
+  case instruction::_LOADX : { s = a1 + " = " + a2 + "[" + a3 + "]"; break; }
+  case instruction::_ALOAD : { s = a1 + " = &" + a2; break; }
+  case instruction::_LOADC : { s = a1 + " = *" + a2; break; }
+  case instruction::_CLOAD : { s = "*" + a1 + " = " + a2; break; }
+  case instruction::_ACOPY : { s = a1 + " = " + a2 + " (" + a3 + " elements)"; break; }
+  case instruction::_READI : { s = "readi " + a1; break; }
+  case instruction::_READF : { s = "readf " + a1; break; }
+  case instruction::_READC : { s = "readc " + a1; break; }
+  case instruction::_WRITEI : { s = "writei " + a1; break; }
+  case instruction::_WRITEF : { s = "writef " + a1; break; }
+  case instruction::_WRITEC : { s = "writec " + a1; break; }
+  case instruction::_WRITES : { s = "writes " + a1; break; }
   case instruction::_WRITELN : { s = "writeln"; break; }
-  case instruction::_ADD : { s = arg1 + " = " + arg2 + " + " + arg3; break; }
-  case instruction::_SUB : { s = arg1 + " = " + arg2 + " - " + arg3; break; }
-  case instruction::_MUL : { s = arg1 + " = " + arg2 + " * " + arg3; break; }
-  case instruction::_DIV : { s = arg1 + " = " + arg2 + " / " + arg3; break; }
-  case instruction::_AND : { s = arg1 + " = " + arg2 + " and " + arg3; break; }
-  case instruction::_OR : { s = arg1 + " = " + arg2 + " or " + arg3; break; }
-  case instruction::_EQ : { s = arg1 + " = " + arg2 + " == " + arg3; break; }
-  case instruction::_LT : { s = arg1 + " = " + arg2 + " < " + arg3; break; }
-  case instruction::_LE : { s = arg1 + " = " + arg2 + " <= " + arg3; break; }
-  case instruction::_NOT : { s = arg1 + " = not " + arg2; break; }
-  case instruction::_NEG : { s = arg1 + " = - " + arg2; break; }
-  case instruction::_FADD : { s = arg1 + " = " + arg2 + " +. " + arg3; break; }
-  case instruction::_FSUB : { s = arg1 + " = " + arg2 + " -. " + arg3; break; }
-  case instruction::_FMUL : { s = arg1 + " = " + arg2 + " *. " + arg3; break; }
-  case instruction::_FDIV : { s = arg1 + " = " + arg2 + " /. " + arg3; break; }
-  case instruction::_FEQ : { s = arg1 + " = " + arg2 + " ==. " + arg3; break; }
-  case instruction::_FLT : { s = arg1 + " = " + arg2 + " <. " + arg3; break; }
-  case instruction::_FLE : { s =  arg1 + " = " + arg2 + " <=. " + arg3; break; }
-  case instruction::_FNEG : { s =  arg1 + " = -. " + arg2; break; }
-  case instruction::_FLOAT : { s = arg1 + " = float " + arg2; break; }
+  case instruction::_ADD : { s = a1 + " = " + a2 + " + " + a3; break; }
+  case instruction::_SUB : { s = a1 + " = " + a2 + " - " + a3; break; }
+  case instruction::_MUL : { s = a1 + " = " + a2 + " * " + a3; break; }
+  case instruction::_DIV : { s = a1 + " = " + a2 + " / " + a3; break; }
+  case instruction::_MOD : { s = a1 + " = " + a2 + " % " + a3; break; }
+  case instruction::_AND : { s = a1 + " = " + a2 + " and " + a3; break; }
+  case instruction::_OR : { s = a1 + " = " + a2 + " or " + a3; break; }
+  case instruction::_EQ : { s = a1 + " = " + a2 + " == " + a3; break; }
+  case instruction::_LT : { s = a1 + " = " + a2 + " < " + a3; break; }
+  case instruction::_LE : { s = a1 + " = " + a2 + " <= " + a3; break; }
+  case instruction::_NOT : { s = a1 + " = not " + a2; break; }
+  case instruction::_NEG : { s = a1 + " = - " + a2; break; }
+  case instruction::_FADD : { s = a1 + " = " + a2 + " +. " + a3; break; }
+  case instruction::_FSUB : { s = a1 + " = " + a2 + " -. " + a3; break; }
+  case instruction::_FMUL : { s = a1 + " = " + a2 + " *. " + a3; break; }
+  case instruction::_FDIV : { s = a1 + " = " + a2 + " /. " + a3; break; }
+  case instruction::_FMOD : { s = a1 + " = " + a2 + " %. " + a3; break; }
+  case instruction::_FEQ : { s = a1 + " = " + a2 + " ==. " + a3; break; }
+  case instruction::_FLT : { s = a1 + " = " + a2 + " <. " + a3; break; }
+  case instruction::_FLE : { s =  a1 + " = " + a2 + " <=. " + a3; break; }
+  case instruction::_FNEG : { s =  a1 + " = -. " + a2; break; }
+  case instruction::_FLOAT : { s = a1 + " = float " + a2; break; }
   case instruction::_NOOP : { s = "noop"; break; }
   default : { s = "????"; break; }
   }
@@ -169,16 +422,24 @@ instructionList::instructionList(const instruction &inst) { this->push_back(inst
 instructionList::~instructionList() {}
 
 // concatenation of lists (or list+instruction, via automatic coertion)
-instructionList instructionList::operator||(const instructionList &lst) const {
-  instructionList newlist = (*this);
+instructionList instructionList::operator||(const instructionList &lst) const & {
+  instructionList newlist;
+  newlist.reserve(size() + lst.size());
+  newlist.insert(newlist.end(), begin(), end());
   newlist.insert(newlist.end(), lst.begin(), lst.end());
   return newlist;
 }
 
+// concatenation onto a temporary list: append in place and move it out
+instructionList instructionList::operator||(const instructionList &lst) && {
+  insert(end(), lst.begin(), lst.end());
+  return std::move(*this);
+}
+
 // print instructionList (for debugging)
 string instructionList::dump() const {
   string s;  
-  for (auto i : *this ) s += i.dump() + "\n";
+  for (auto & i : *this ) s += i.dump() + "\n";
   return s;
 }
 
@@ -206,11 +467,13 @@ string var::dump() const {
 /// Implementation for class 'subroutine'
 
 /// constructor
-subroutine::subroutine(const string &sname) { name = sname; }
+subroutine::subroutine(const string &sname) : names(std::make_shared<nameTable>()) { name = sname; }
 /// destructor
 subroutine::~subroutine() {}
 /// get subroutine name
 string subroutine::get_name() const { return name; };
+/// get the table of operand names
+nameTable & subroutine::get_names() const { return *names; }
 /// add new variable
 void subroutine::add_var(const var v) { vars.push_back(v); }
 /// add new variable
@@ -219,19 +482,29 @@ void subroutine::add_var(const std::string &name, size_t sz) { vars.push_back(va
 void subroutine::add_param(const std::string &name) { params.push_back(var(name,0)); }
 /// add new instruction
 void subroutine::add_instruction(const instruction &inst) {
-  if (inst.oper == instruction::_LABEL) labels.insert(make_pair(inst.arg1,instructions.size()));
+  if (inst.oper == instruction::_LABEL) labels.insert(make_pair(inst.arg1.str(),instructions.size()));
   instructions.push_back(inst);
 }
 /// add instruction list to current instructions
 void subroutine::add_instructions(const instructionList &lins) {
-  for (auto i : lins)
+  instructions.reserve(instructions.size() + lins.size());
+  for (auto & i : lins)
     this->add_instruction(i);
 }
 /// set instruction list (overwritting current instructions)
 void subroutine::set_instructions(const instructionList &lins) {
   instructions.clear();
+  labels.clear();
   this->add_instructions(lins);
 }
+/// set instruction list taking over its storage
+void subroutine::set_instructions(instructionList &&lins) {
+  instructions = std::move(lins);
+  labels.clear();
+  for (size_t pc = 0; pc < instructions.size(); ++pc)
+    if (instructions[pc].oper == instruction::_LABEL)
+      labels.insert(make_pair(instructions[pc].arg1.str(), pc));
+}
 /// get instruction at given program counter
 instruction subroutine::get_instruction_at(size_t pc) const {
   if (pc>=instructions.size()) return instruction(instruction::_INVALID);
@@ -240,7 +513,7 @@ instruction subroutine::get_instruction_at(size_t pc) const {
 /// get program counter for given label
 size_t subroutine::get_label_pc(std::string &lab) const { return labels.find(lab)->second; }
 /// get the list of instructions (needed only in LLVMCodeGen)
-instructionList subroutine::get_instructions() const {
+const instructionList & subroutine::get_instructions() const {
   return instructions;
 }
 /// print (for debugging)
@@ -260,7 +533,7 @@ string subroutine::dump() const {
 
   string ind = "  ";
   if (labels.empty()) ind="";
-  for (auto i : instructions) s += ind + i.dump() + "\n";  
+  for (auto & i : instructions) s += ind + i.dump() + "\n";  
   s += "endfunction\n\n";
   return s;
 }
@@ -286,15 +559,74 @@ void code::add_subroutine(const subroutine &s) {
   names.insert(make_pair(s.get_name(), subs.size()-1));
 }
 /// get the list of subroutine's (needed only in LLVMCodeGen)
+std::vector<subroutine> & code::get_subroutine_list() {
+  return subs;
+}
+
 const std::vector<subroutine> & code::get_subroutine_list() const {
   return subs;
 }
 /// print (for debugging)
 string code::dump() const {
   string c;
-  for (auto s : subs) c += s.dump();
+  for (auto & s : subs) c += s.dump();
   return c;
 }
+void code::expand_for_tvm() {
+  for (auto & s : subs) {
+    const instructionList & inss = s.get_instructions();
+    bool found = false;
+    int maxTemp = 0;
+    for (auto & ins : inss) {
+      if (ins.oper == instruction::_ACOPY or ins.oper == instruction::_MOD or
+          ins.oper == instruction::_FMOD or ins.is_compare_jump()) found = true;
+      for (const operand *a : {&ins.arg1, &ins.arg2, &ins.arg3})
+        if (a->isTemp() and a->number() > maxTemp) maxTemp = a->number();
+    }
+    if (not found) continue;
+    instructionList expanded;
+    int nCopies = 0;
+    for (auto & ins : inss) {
+      if (ins.oper == instruction::_MOD) {
+        operand quot = operand::temp(++maxTemp), prod = operand::temp(++maxTemp);
+        expanded = std::move(expanded) || instruction::DIV(quot, ins.arg2, ins.arg3) ||
+                   instruction::MUL(prod, quot, ins.arg3) || instruction::SUB(ins.arg1, ins.arg2, prod);
+      }
+      else if (ins.oper == instruction::_FMOD) {
+        // tvm cannot truncate a float: the quotient is not rounded
+        operand quot = operand::temp(++maxTemp), prod = operand::temp(++maxTemp);
+        expanded = std::move(expanded) || instruction::FDIV(quot, ins.arg2, ins.arg3) ||
+                   instruction::FMUL(prod, quot, ins.arg3) || instruction::FSUB(ins.arg1, ins.arg2, prod);
+      }
+      else if (ins.is_compare_jump()) {
+        bool jumpIf;
+        operand cond = operand::temp(++maxTemp);
+        expanded = std::move(expanded) || instruction(ins.jump_comparison(jumpIf), cond, ins.arg1, ins.arg2);
+        if (jumpIf) {
+          operand notCond = operand::temp(++maxTemp);
+          expanded = std::move(expanded) || instruction::NOT(notCond, cond);
+          cond = notCond;
+        }
+        expanded = std::move(expanded) || instruction::FJUMP(cond, ins.arg3);
+      }
+      else if (ins.oper == instruction::_ACOPY) {
+        operand size = operand::temp(++maxTemp), i = operand::temp(++maxTemp);
+        operand one = operand::temp(++maxTemp), cond = operand::temp(++maxTemp);
+        operand elem = operand::temp(++maxTemp);
+        string n = std::to_string(++nCopies);
+        operand label("copy" + n, s.get_names()), labelEnd("endcopy" + n, s.get_names());
+        expanded = std::move(expanded) || instruction::ILOAD(size, ins.arg3) ||
+                   instruction::ILOAD(i, operand::integer(0)) || instruction::ILOAD(one, operand::integer(1)) ||
+                   instruction::LABEL(label) || instruction::LT(cond, i, size) || instruction::FJUMP(cond, labelEnd) ||
+                   instruction::LOADX(elem, ins.arg2, i) || instruction::XLOAD(ins.arg1, i, elem) ||
+                   instruction::ADD(i, i, one) || instruction::UJUMP(label) || instruction::LABEL(labelEnd);
+      }
+      else expanded.push_back(ins);
+    }
+    s.set_instructions(std::move(expanded));
+  }
+}
+
 /// print the code in LLVM IR
 std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols) const {
   LLVMCodeGen llvmCode(Types, Symbols, *this);
@@ -302,20 +634,28 @@ std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols) con
   return llvmStr;
 }
 
+std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols,
+                           std::vector<std::string> & fragments) const {
+  LLVMCodeGen llvmCode(Types, Symbols, *this);
+  return llvmCode.dumpLLVM(fragments);
+}
+
 
 ////////////////////////////////////////////////////////////////////
-/// Static methods to manage counters
-int counters::countIF = 0;
-int counters::countWHILE = 0;
-int counters::countTEMP = 0;
+/// Methods to manage counters
+
+counters::counters() : countIF(0), countWHILE(0), countLOGIC(0), countTEMP(0) {}
 
 string counters::newLabelIF() { return std::to_string(++countIF); }
 string counters::newLabelWHILE() { return std::to_string(++countWHILE); }
+string counters::newLabelLOGIC() { return std::to_string(++countLOGIC); }
 string counters::newTEMP() { return std::to_string(++countTEMP); }
+operand counters::newTEMPoperand() { return operand::temp(++countTEMP); }
 
 void counters::resetLabelIF() { countIF = 0; }
 void counters::resetLabelWHILE() { countWHILE = 0; }
+void counters::resetLabelLOGIC() { countLOGIC = 0; }
 void counters::resetTEMP() { countTEMP = 0; }
 
-void counters::resetLabels() { resetLabelIF(); resetLabelWHILE(); }
+void counters::resetLabels() { resetLabelIF(); resetLabelWHILE(); resetLabelLOGIC(); }
 void counters::reset() { resetLabels(); resetTEMP(); }
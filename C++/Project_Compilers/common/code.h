@@ -31,6 +31,9 @@
 #include <map>
 #include <list>
 #include <vector>
+#include <string>
+#include <memory>
+#include <unordered_set>
 #include "TypesMgr.h"
 #include "SymTable.h"
 
@@ -38,26 +41,117 @@
 class instructionList;
 class LLVMCodeGen;
 
+
+////////////////////////////////////////////////////////////////////
+/// Class nameTable interns the names (identifiers, labels and
+/// literals) used as instruction operands, so that each distinct
+/// name is stored only once
+
+class nameTable {
+public:
+  /// get the unique stored copy of a name (adding it if needed)
+  const std::string * intern(const std::string &name);
+  /// number of distinct names stored
+  std::size_t size() const;
+
+  /// while a Scope is alive, the operands built from plain strings in
+  /// its thread intern their names in its table (scopes nest). A Scope
+  /// with no table requires an inner one for such names (asserted):
+  /// the compiler opens it around a compilation, so that all its names
+  /// belong to a subroutine
+  class Scope {
+  public:
+    Scope();
+    Scope(nameTable &table);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+  private:
+    nameTable *previous;
+    bool previousRequired;
+  };
+  /// table of the innermost Scope of this thread (null if none)
+  static nameTable * current();
+
+private:
+  /// element addresses of a node-based set are stable
+  std::unordered_set<std::string> names;
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// Class operand stores an instruction argument as a tagged value:
+/// a temporary (%N) or an integer immediate keep just their number,
+/// any other name is a pointer into a nameTable
+
+class operand {
+public:
+  /// kinds of operand
+  typedef enum {_NONE, _TEMP, _INT, _SYMBOL, _LITERAL} Kind;
+
+  /// empty operand (as the "" string argument)
+  operand();
+  /// classify a string argument ("%3", "12", "x", "0.5", "'a'"...);
+  /// names are interned in the table of the current nameTable::Scope,
+  /// or, outside of any scope, in a table shared by all threads
+  operand(const std::string &s);
+  operand(const char *s);
+  /// classify a string argument interning names in the given table
+  operand(const std::string &s, nameTable &names);
+
+  /// temporary %n
+  static operand temp(int n);
+  /// integer immediate
+  static operand integer(int v);
+
+  Kind kind() const;
+  bool empty() const;
+  bool isTemp() const;
+  bool isInt() const;
+  bool isSymbol() const;
+  bool isLiteral() const;
+  /// number of a temporary or value of an integer immediate
+  int number() const;
+
+  /// text of the operand, as printed in t-code
+  std::string str() const;
+
+  bool operator==(const operand &o) const;
+  bool operator!=(const operand &o) const;
+  /// arbitrary total order (to use operands as keys)
+  bool operator<(const operand &o) const;
+
+private:
+  Kind oKind;
+  int num;
+  const std::string *text;
+
+  /// classify s (names go to the shared table if names is null)
+  void set(const std::string &s, nameTable *names);
+};
+
 ////////////////////////////////////////////////////////////////////
 /// Class instruction stores a VM instruction code with its operands
 
 class instruction {
 public:
   /// instruction codes
-  typedef enum {_LABEL, _UJUMP, _FJUMP, _PUSH, _POP, _CALL, _RETURN,
-                _ADD, _SUB, _MUL, _DIV, _EQ, _LT, _LE, _NEG, _NOT, _AND, _OR, _FLOAT,
-                _FADD, _FSUB, _FMUL, _FDIV, _FEQ, _FLT, _FLE, _FNEG,
-                _LOAD, _ILOAD, _CHLOAD, _FLOAD, _XLOAD, _LOADX, _ALOAD, _LOADC, _CLOAD,
+  typedef enum {_LABEL, _UJUMP, _FJUMP,
+                _JEQ, _JLT, _JLE, _JNEQ, _JNLT, _JNLE, _FJEQ, _FJLT, _FJLE, _FJNEQ, _FJNLT, _FJNLE,
+                _PUSH, _POP, _CALL, _RETURN,
+                _ADD, _SUB, _MUL, _DIV, _MOD, _EQ, _LT, _LE, _NEG, _NOT, _AND, _OR, _FLOAT,
+                _FADD, _FSUB, _FMUL, _FDIV, _FMOD, _FEQ, _FLT, _FLE, _FNEG,
+                _LOAD, _ILOAD, _CHLOAD, _FLOAD, _XLOAD, _LOADX, _ALOAD, _LOADC, _CLOAD, _ACOPY,
                 _READI, _READF, _READC, _WRITEI, _WRITEF, _WRITEC, _WRITES, _WRITELN, _NOOP, _INVALID} Operation;
   
   /// instruction code
   Operation oper;
   /// arguments
-  std::string arg1, arg2, arg3;
+  operand arg1, arg2, arg3;
   
   /// constructor
   instruction(Operation op,
-              const std::string &a1="", const std::string &a2="", const std::string &a3="");
+              const operand &a1=operand(), const operand &a2=operand(), const operand &a3=operand());
 
   /// destructor
   ~instruction();
@@ -68,95 +162,149 @@ public:
   /// ------ specific constructors for each instruction -------
 
   // create new instruction "a1 :"
-  static instruction LABEL(const std::string &a1);
+  static instruction LABEL(const operand &a1);
   // create new instruction "goto a1"
-  static instruction UJUMP(const std::string &a1);
+  static instruction UJUMP(const operand &a1);
   // create new instruction "ifFalse a1 goto a2"
-  static instruction FJUMP(const std::string &a1, const std::string &a2);
+  static instruction FJUMP(const operand &a1, const operand &a2);
+  // create new instruction "if a1 == a2 goto a3"
+  static instruction JEQ(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "if a1 < a2 goto a3"
+  static instruction JLT(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "if a1 <= a2 goto a3"
+  static instruction JLE(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 == a2 goto a3"
+  static instruction JNEQ(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 < a2 goto a3"
+  static instruction JNLT(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 <= a2 goto a3"
+  static instruction JNLE(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "if a1 ==. a2 goto a3"
+  static instruction FJEQ(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "if a1 <. a2 goto a3"
+  static instruction FJLT(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "if a1 <=. a2 goto a3"
+  static instruction FJLE(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 ==. a2 goto a3"
+  static instruction FJNEQ(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 <. a2 goto a3"
+  static instruction FJNLT(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "ifFalse a1 <=. a2 goto a3"
+  static instruction FJNLE(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "pushparam a1"
-  static instruction PUSH(const std::string &a1="");
+  static instruction PUSH(const operand &a1=operand());
   // create new instruction "popparam a1"
-  static instruction POP(const std::string &a1="");
+  static instruction POP(const operand &a1=operand());
   // create new instruction "call a1"
-  static instruction CALL(const std::string &a1);
+  static instruction CALL(const operand &a1);
   // create new instruction "return"
   static instruction RETURN();
   // create new instruction "a1 = a2 + a3"
-  static instruction ADD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction ADD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 - a3"
-  static instruction SUB(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction SUB(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 * a3"
-  static instruction MUL(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction MUL(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 / a3"
-  static instruction DIV(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction DIV(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "a1 = a2 % a3"
+  static instruction MOD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 == a3"
-  static instruction EQ(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction EQ(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 < a3"
-  static instruction LT(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LT(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <= a3"
-  static instruction LE(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LE(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 and a3"
-  static instruction AND(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction AND(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 or a3"
-  static instruction OR(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction OR(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 +. a3"
-  static instruction FADD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FADD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 -. a3"
-  static instruction FSUB(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FSUB(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 *. a3"
-  static instruction FMUL(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FMUL(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 /. a3"
-  static instruction FDIV(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FDIV(const operand &a1, const operand &a2, const operand &a3);
+  // create new instruction "a1 = a2 %. a3", which is a2 - (a2 /. a3) *. a3
+  // (the quotient is not truncated, as in the sequence tvm runs)
+  static instruction FMOD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 ==. a3"
-  static instruction FEQ(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FEQ(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <. a3"
-  static instruction FLT(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FLT(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2 <=. a3"
-  static instruction FLE(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction FLE(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = not a2"
-  static instruction NOT(const std::string &a1, const std::string &a2);
+  static instruction NOT(const operand &a1, const operand &a2);
   // create new instruction "a1 = - a2"
-  static instruction NEG(const std::string &a1, const std::string &a2);
+  static instruction NEG(const operand &a1, const operand &a2);
   // create new instruction "a1 = -. a2"
-  static instruction FNEG(const std::string &a1, const std::string &a2);
+  static instruction FNEG(const operand &a1, const operand &a2);
   // create new instruction "a1 = float a2"
-  static instruction FLOAT(const std::string &a1, const std::string &a2);  
+  static instruction FLOAT(const operand &a1, const operand &a2);  
   // create new instruction "a1 = a2"
-  static instruction LOAD(const std::string &a1, const std::string &a2);
+  static instruction LOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is an integer constant)
-  static instruction ILOAD(const std::string &a1, const std::string &a2);
+  static instruction ILOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is a character constant)
-  static instruction CHLOAD(const std::string &a1, const std::string &a2);
+  static instruction CHLOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = a2" (where a2 is a float constant)
-  static instruction FLOAD(const std::string &a1, const std::string &a2);
+  static instruction FLOAD(const operand &a1, const operand &a2);
   // create new instruction "a1[a2] = a3" 
-  static instruction XLOAD(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction XLOAD(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = a2[a3]" 
-  static instruction LOADX(const std::string &a1, const std::string &a2, const std::string &a3);
+  static instruction LOADX(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "a1 = &a2" 
-  static instruction ALOAD(const std::string &a1, const std::string &a2);
+  static instruction ALOAD(const operand &a1, const operand &a2);
   // create new instruction "a1 = *a2" 
-  static instruction LOADC(const std::string &a1, const std::string &a2);
+  static instruction LOADC(const operand &a1, const operand &a2);
   // create new instruction "*a1 = a2" 
-  static instruction CLOAD(const std::string &a1, const std::string &a2);
+  static instruction CLOAD(const operand &a1, const operand &a2);
+  // create new instruction "a1 = a2 (a3 elements)": copy a whole array
+  // (a1, a2 are arrays or addresses of arrays, a3 an integer constant)
+  static instruction ACOPY(const operand &a1, const operand &a2, const operand &a3);
   // create new instruction "readi a1" 
-  static instruction READI(const std::string &a1);
+  static instruction READI(const operand &a1);
   // create new instruction "readf a1" 
-  static instruction READF(const std::string &a1);
+  static instruction READF(const operand &a1);
   // create new instruction "readc a1" 
-  static instruction READC(const std::string &a1);
+  static instruction READC(const operand &a1);
   // create new instruction "writei a1" 
-  static instruction WRITEI(const std::string &a1); 
+  static instruction WRITEI(const operand &a1); 
   // create new instruction "writef a1" 
-  static instruction WRITEF(const std::string &a1);
+  static instruction WRITEF(const operand &a1);
   // create new instruction "writec a1" 
-  static instruction WRITEC(const std::string &a1);
+  static instruction WRITEC(const operand &a1);
   // create new instruction "writes 'string constant'" 
-  static instruction WRITES(const std::string &a1);
+  static instruction WRITES(const operand &a1);
   // create new instruction "writeln" 
   static instruction WRITELN();
   // create new instruction "noop" (not really needed) 
   static instruction NOOP();
+
+  /// ------ properties used by the optimization passes -------
+
+  /// masks for the arguments of an instruction
+  static const unsigned ARG1 = 1, ARG2 = 2, ARG3 = 4;
+  /// arguments read by the instruction (labels and called names excluded)
+  unsigned used_args() const;
+  /// true if the instruction writes arg1
+  bool defines_arg1() const;
+  /// true if the instruction has no effect besides writing arg1
+  /// (no input, no stack change, no possible runtime error)
+  bool is_pure() const;
+  /// true for the instructions that jump to a label (arg1, arg2 or arg3)
+  bool is_jump() const;
+  /// label an unconditional or conditional jump goes to
+  const operand & jump_target() const;
+  operand & jump_target();
+  /// true for the jumps that compare arg1 and arg2 (JEQ ... FJNLE)
+  bool is_compare_jump() const;
+  /// comparison made by a compare-and-jump (EQ, LT, LE, FEQ, FLT or
+  /// FLE), and the result of the comparison that makes it jump
+  Operation jump_comparison(bool &jumpIf) const;
   
   // print instruction
   std::string dump() const;   
@@ -172,11 +320,19 @@ public:
   instructionList();
   // constructor from a single instruction
   instructionList(const instruction &);
+  // copy and move (the destructor would otherwise disable moves)
+  instructionList(const instructionList &) = default;
+  instructionList(instructionList &&) = default;
+  instructionList & operator=(const instructionList &) = default;
+  instructionList & operator=(instructionList &&) = default;
   // destructor
   ~instructionList();
 
-  // concatenation of lists (or list+instruction, via automatic coertion)
-  instructionList operator||(const instructionList &lst) const;
+  // concatenation of lists (or list+instruction, via automatic coertion).
+  // A temporary left operand is extended in place instead of copied, so
+  // chains like "std::move(code) || a || b" take time linear in a and b
+  instructionList operator||(const instructionList &lst) const &;
+  instructionList operator||(const instructionList &lst) &&;
 
   // print instructionList
   std::string dump() const;   
@@ -211,6 +367,8 @@ private:
   instructionList instructions;
   /// map label name -> position in instructions
   std::map<std::string, size_t> labels;
+  /// names used by the operands of this subroutine (shared by copies)
+  std::shared_ptr<nameTable> names;
 
 public:
   /// list of local variables
@@ -221,9 +379,16 @@ public:
   /// constructor and destructor
   subroutine(const std::string &sname);
   ~subroutine();
+  /// copy and move
+  subroutine(const subroutine &) = default;
+  subroutine(subroutine &&) = default;
+  subroutine & operator=(const subroutine &) = default;
+  subroutine & operator=(subroutine &&) = default;
 
   /// get subroutine name
   std::string get_name() const;
+  /// get the table where the operand names of this subroutine are interned
+  nameTable & get_names() const;
   /// add a local var to subroutine
   void add_var(const var v);
   /// add a local var to subroutine
@@ -236,13 +401,15 @@ public:
   void add_instructions(const instructionList &lins);
   /// set instruction list (overwritting current instructions)
   void set_instructions(const instructionList &lins);
+  /// set instruction list taking over its storage
+  void set_instructions(instructionList &&lins);
   
   /// get instruction at given program counter in subroutine
   instruction get_instruction_at(size_t pc) const;
   /// get program counter in subroutine for given label
   size_t get_label_pc(std::string &lab) const;
   /// get the list of instructions (needed only in LLVMCodeGen)
-  instructionList get_instructions() const;
+  const instructionList & get_instructions() const;
 
   // print subroutine (params, vars, and instructions)
   std::string dump() const;
@@ -272,37 +439,56 @@ public:
   void add_subroutine(const subroutine &s);
   /// get the list of subroutines (needed only in LLVMCodeGen)
   const std::vector<subroutine> & get_subroutine_list() const;
+  /// get the list of subroutines to rewrite them (optimization passes)
+  std::vector<subroutine> & get_subroutine_list();
 
   // print code (all info for all subroutines)
   std::string dump() const;
+  /// rewrite the instructions that tvm does not have: array copies
+  /// become loops copying element by element, modulo operations
+  /// become a division, a product and a subtraction, and compare-and-
+  /// jumps become a comparison and an ifFalse
+  void expand_for_tvm();
   /// print the code in LLVM IR
   std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols) const;
+  /// the same, taking the LLVM code of the i-th subroutine from
+  /// fragments[i] if it is not empty, and writing it there otherwise
+  std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols,
+                       std::vector<std::string> & fragments) const;
 };
 
 
 ////////////////////////////////////////////////////////////////////
-/// Class counters manages temporal and labels counters
+/// Class counters manages temporal and labels counters (each
+/// compilation has its own, so that several can run concurrently)
 
 class counters {
 private:
-  static int countIF;
-  static int countWHILE;
-  static int countTEMP;
+  int countIF;
+  int countWHILE;
+  int countLOGIC;
+  int countTEMP;
 
 public:
+  counters();
+
   // return id for new label or temp (id is a number, but returned as string
   // to ease concatenation with other literals (e.g. "labelIF" + "4" -> "LabelIF4")
-  static std::string newLabelIF();
-  static std::string newLabelWHILE();
-  static std::string newTEMP();
+  std::string newLabelIF();
+  std::string newLabelWHILE();
+  std::string newLabelLOGIC();
+  std::string newTEMP();
+  // return a new temporary already as an operand (no string involved)
+  operand newTEMPoperand();
   
   // reset individual counters 
-  static void resetLabelIF();
-  static void resetLabelWHILE();
-  static void resetTEMP();
+  void resetLabelIF();
+  void resetLabelWHILE();
+  void resetLabelLOGIC();
+  void resetTEMP();
   
-  // reset label counters (IF and WHILE)
-  static void resetLabels();
-  // reset all counters (IF, WHILE, and TEMP)
-  static void reset();
+  // reset label counters (IF, WHILE and LOGIC)
+  void resetLabels();
+  // reset all counters (IF, WHILE, LOGIC, and TEMP)
+  void reset();
 };
@@ -45,13 +45,16 @@
 //
 // These messages can be enabled in a specific module/visitor
 // defining the variable DEBUG_BUILD *before* the inclusion
-// of this file
+// of this file.
+// The indentation follows the nesting of the visitor calls, so it is
+// kept per thread: each compilation runs in a single thread, and
+// concurrent compilations do not disturb each other
 
 #ifdef DEBUG_BUILD
-  static int _i_ = 0;
-  static int _delta_i_ = 2;
-  std::string _incr_indent_() { std::string s = std::string(_i_, ' '); _i_ += _delta_i_; return s; }
-  std::string _decr_indent_() { _i_ -= _delta_i_; std::string s = std::string(_i_, ' '); return s; }
+  inline int & _indent_() { static thread_local int i = 0; return i; }
+  const int _delta_i_ = 2;
+  inline std::string _incr_indent_() { std::string s = std::string(_indent_(), ' '); _indent_() += _delta_i_; return s; }
+  inline std::string _decr_indent_() { _indent_() -= _delta_i_; std::string s = std::string(_indent_(), ' '); return s; }
   #define DEBUG(x) do { std::cout << x << std::endl; } while (0)
   #define DEBUG_ENTER() DEBUG(_incr_indent_() << ">>> enter " << std::string(__func__).substr(5) << " [source pos " << ctx->getStart()->getLine() << ":" << ctx->getStart()->getCharPositionInLine() << "] [module: " << std::string(typeid(*this).name()).substr(2,std::string(typeid(*this).name()).find("Visitor")-2) << "]")
   #define DEBUG_EXIT() DEBUG( _decr_indent_() << ">>> exit " << std::string(__func__).substr(5) << " [source pos " << ctx->getStart()->getLine() << ":" << ctx->getStart()->getCharPositionInLine() << "] [module: " << std::string(typeid(*this).name()).substr(2,std::string(typeid(*this).name()).find("Visitor")-2) << "]")